@@ -111,6 +111,30 @@ extern DECLSPEC void SDLCALL SDL_AtomicLock(SDL_SpinLock *lock);
  */
 extern DECLSPEC void SDLCALL SDL_AtomicUnlock(SDL_SpinLock *lock);
 
+/**
+ * \brief Lock contention counters, see SDL_GetLockContentionStats().
+ */
+typedef struct SDL_LockContentionStats
+{
+    int contended;  /**< Locks that were not free on the first attempt */
+    int yields;     /**< Time slices given up while waiting for a lock */
+    int parks;      /**< Waits that went to sleep until the lock was released */
+} SDL_LockContentionStats;
+
+/**
+ * \brief Get the spin lock and mutex contention counters.
+ *
+ * The counters are process wide and wrap around on overflow.
+ * SDL_HINT_SPINLOCK_SPIN_COUNT and SDL_HINT_SPINLOCK_YIELD_COUNT tune how
+ * long a waiter spins and yields before it sleeps.
+ */
+extern DECLSPEC void SDLCALL SDL_GetLockContentionStats(SDL_LockContentionStats *stats);
+
+/**
+ * \brief Reset the lock contention counters to zero.
+ */
+extern DECLSPEC void SDLCALL SDL_ResetLockContentionStats(void);
+
 /* @} *//* SDL AtomicLock */
 
 
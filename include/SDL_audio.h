@@ -403,6 +403,19 @@ extern DECLSPEC SDL_AudioStatus SDLCALL
 SDL_GetAudioDeviceStatus(SDL_AudioDeviceID dev);
 /* @} *//* Audio State */
 
+/**
+ *  Get how much audio a device holds between the mixer and the speaker.
+ *
+ *  This is the depth of the device's hardware buffering plus anything SDL
+ *  has converted for it but not handed over yet. It doesn't include audio
+ *  queued with SDL_QueueAudio(); see SDL_GetQueuedAudioSize() for that.
+ *
+ *  \param dev The device ID to query.
+ *  \return The latency in sample frames at the device's obtained frequency,
+ *          or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_GetAudioDeviceLatency(SDL_AudioDeviceID dev);
+
 /**
  *  \name Pause audio functions
  *
@@ -633,6 +646,158 @@ extern DECLSPEC void SDLCALL SDL_MixAudioFormat(Uint8 * dst,
                                                 SDL_AudioFormat format,
                                                 Uint32 len, int volume);
 
+/* SDL_AudioMixer mixes any number of voices into one output format.
+    - each voice takes audio in its own format through an SDL_AudioStream,
+      and has its own gain and pan.
+    - voices can be started at an exact output sample frame.
+    - everything is mixed in float, and clamped and converted to the output
+      format once.
+   SDL_AudioMixerCallback() can be passed as the callback to SDL_OpenAudio()
+   or SDL_OpenAudioDevice() with the mixer as userdata.  All the functions
+   are safe to call from any thread.
+ */
+/* this is opaque to the outside world. */
+struct _SDL_AudioMixer;
+typedef struct _SDL_AudioMixer SDL_AudioMixer;
+
+/**
+ *  A voice of an SDL_AudioMixer.  0 is never a valid voice.
+ */
+typedef Uint32 SDL_AudioVoiceID;
+
+/**
+ *  Create a new audio mixer
+ *
+ *  \param spec The output format; \c format, \c channels and \c freq are used
+ *  \return The new mixer, or NULL on error.
+ *
+ *  \sa SDL_FreeAudioMixer
+ *  \sa SDL_AudioMixerNewVoice
+ *  \sa SDL_AudioMixerCallback
+ */
+extern DECLSPEC SDL_AudioMixer * SDLCALL SDL_NewAudioMixer(const SDL_AudioSpec *spec);
+
+/**
+ *  Add a voice to the mixer.  It starts stopped, with a gain of 1 and
+ *  centered.
+ *
+ *  \param mixer The mixer to add the voice to
+ *  \param format The format of the audio that will be put to the voice
+ *  \param channels The number of channels of that audio
+ *  \param rate The sampling rate of that audio
+ *  \return The new voice, or 0 on error.
+ *
+ *  \sa SDL_AudioMixerFreeVoice
+ *  \sa SDL_AudioMixerPutVoice
+ *  \sa SDL_AudioMixerPlayVoice
+ */
+extern DECLSPEC SDL_AudioVoiceID SDLCALL SDL_AudioMixerNewVoice(SDL_AudioMixer *mixer,
+                                                                const SDL_AudioFormat format,
+                                                                const Uint8 channels,
+                                                                const int rate);
+
+/**
+ *  Queue audio to be played by a voice
+ *
+ *  \param mixer The mixer the voice belongs to
+ *  \param voice The voice to queue audio to
+ *  \param buf A pointer to the audio data to add
+ *  \param len The number of bytes to add
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_AudioMixerFlushVoice
+ */
+extern DECLSPEC int SDLCALL SDL_AudioMixerPutVoice(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice, const void *buf, int len);
+
+/**
+ *  Tell the mixer that no more audio will be queued to a voice, so it
+ *  plays out everything queued so far and then stops.
+ *
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_AudioMixerPutVoice
+ */
+extern DECLSPEC int SDLCALL SDL_AudioMixerFlushVoice(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice);
+
+/**
+ *  Set the gain of a voice, 1.0 for unchanged volume
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioMixerSetVoiceGain(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice, float gain);
+
+/**
+ *  Set the pan of a voice, from -1.0 (left) to 1.0 (right)
+ *
+ *  Panning attenuates the front left or right channel of the output; the
+ *  center (0.0) plays both at full gain.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioMixerSetVoicePan(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice, float pan);
+
+/**
+ *  Start playing a voice
+ *
+ *  \param mixer The mixer the voice belongs to
+ *  \param voice The voice to start
+ *  \param frame The output sample frame to start at, as counted by
+ *               SDL_AudioMixerPosition(); a frame that has already been
+ *               mixed starts the voice right away.
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_AudioMixerStopVoice
+ *  \sa SDL_AudioMixerPosition
+ */
+extern DECLSPEC int SDLCALL SDL_AudioMixerPlayVoice(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice, Uint64 frame);
+
+/**
+ *  Stop playing a voice, keeping the audio queued to it
+ *
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_AudioMixerPlayVoice
+ */
+extern DECLSPEC int SDLCALL SDL_AudioMixerStopVoice(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice);
+
+/**
+ *  Check whether a voice is playing or waiting to start
+ *
+ *  \return SDL_TRUE if the voice is playing, SDL_FALSE if it is stopped,
+ *          has played out after SDL_AudioMixerFlushVoice() or is invalid.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_AudioMixerVoicePlaying(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice);
+
+/**
+ *  Remove a voice from the mixer, dropping any audio queued to it
+ *
+ *  \sa SDL_AudioMixerNewVoice
+ */
+extern DECLSPEC void SDLCALL SDL_AudioMixerFreeVoice(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice);
+
+/**
+ *  Get the number of sample frames the mixer has produced so far
+ *
+ *  \sa SDL_AudioMixerPlayVoice
+ */
+extern DECLSPEC Uint64 SDLCALL SDL_AudioMixerPosition(SDL_AudioMixer *mixer);
+
+/**
+ *  Mix the next \c len bytes of output.  This is an SDL_AudioCallback.
+ *
+ *  \param userdata The SDL_AudioMixer
+ *  \param stream The buffer to fill, in the mixer's output format
+ *  \param len The number of bytes to fill
+ */
+extern DECLSPEC void SDLCALL SDL_AudioMixerCallback(void *userdata, Uint8 *stream, int len);
+
+/**
+ *  Destroy a mixer and all its voices
+ *
+ *  \sa SDL_NewAudioMixer
+ */
+extern DECLSPEC void SDLCALL SDL_FreeAudioMixer(SDL_AudioMixer *mixer);
+
 /**
  *  Queue more audio on non-callback devices.
  *
@@ -664,6 +829,10 @@ extern DECLSPEC void SDLCALL SDL_MixAudioFormat(Uint8 * dst,
  *  You should not call SDL_LockAudio() on the device before queueing; SDL
  *  handles locking internally for this function.
  *
+ *  If the device was opened with SDL_HINT_AUDIO_QUEUE_LOCKFREE set, the queue
+ *  has a fixed size and never blocks the audio thread. Only one thread may
+ *  queue to it, and data that doesn't fit is refused whole.
+ *
  *  \param dev The device ID to which we will queue audio.
  *  \param data The data to queue to the device for later playback.
  *  \param len The number of bytes (not samples!) to which (data) points.
@@ -671,6 +840,7 @@ extern DECLSPEC void SDLCALL SDL_MixAudioFormat(Uint8 * dst,
  *
  *  \sa SDL_GetQueuedAudioSize
  *  \sa SDL_ClearQueuedAudio
+ *  \sa SDL_GetQueuedAudioStats
  */
 extern DECLSPEC int SDLCALL SDL_QueueAudio(SDL_AudioDeviceID dev, const void *data, Uint32 len);
 
@@ -792,6 +962,31 @@ extern DECLSPEC Uint32 SDLCALL SDL_GetQueuedAudioSize(SDL_AudioDeviceID dev);
  */
 extern DECLSPEC void SDLCALL SDL_ClearQueuedAudio(SDL_AudioDeviceID dev);
 
+/**
+ *  \brief Counters of a queued audio device's glitches.
+ *
+ *  \sa SDL_GetQueuedAudioStats
+ */
+typedef struct SDL_AudioQueueStats
+{
+    Uint32 underruns;   /**< Times the device ran out of queued audio while playing */
+    Uint32 overruns;    /**< Calls to SDL_QueueAudio() refused because the queue was full */
+} SDL_AudioQueueStats;
+
+/**
+ *  Get the underrun and overrun counts of a playback device that uses
+ *  SDL_QueueAudio().  The counts only go up, for as long as the device is
+ *  open.  Overruns only happen with SDL_HINT_AUDIO_QUEUE_LOCKFREE, which
+ *  gives the queue a fixed size.
+ *
+ *  \param dev The device ID to query.
+ *  \param stats Filled in with the counts.
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_QueueAudio
+ */
+extern DECLSPEC int SDLCALL SDL_GetQueuedAudioStats(SDL_AudioDeviceID dev, SDL_AudioQueueStats *stats);
+
 
 /**
  *  \name Audio lock functions
@@ -659,6 +659,23 @@ extern DECLSPEC int SDLCALL SDL_WaitEventTimeout(SDL_Event * event,
  */
 extern DECLSPEC int SDLCALL SDL_PushEvent(SDL_Event * event);
 
+/**
+ *  \brief Get the high resolution time at which an event was generated.
+ *
+ *  Every event carries a 64-bit SDL_GetPerformanceCounter() value in
+ *  addition to its millisecond \c timestamp.  Input drivers sample it when
+ *  they read the device, other events get it when they are pushed.
+ *  Events added with SDL_PeepEvents() get it when they are added, unless
+ *  they already carry a nonzero value, so clear those events with
+ *  SDL_zero() before filling them in.
+ *  Divide differences by SDL_GetPerformanceFrequency() to get seconds.
+ *
+ *  \return The performance counter value.  SDL_TEXTEDITING events have no
+ *          room for it, so for those it is estimated from the millisecond
+ *          \c timestamp and is only accurate to a millisecond.
+ */
+extern DECLSPEC Uint64 SDLCALL SDL_GetEventPerformanceCounter(const SDL_Event * event);
+
 typedef int (SDLCALL * SDL_EventFilter) (void *userdata, SDL_Event * event);
 
 /**
@@ -153,6 +153,82 @@ extern "C" {
  */
 #define SDL_HINT_RENDER_VSYNC               "SDL_RENDER_VSYNC"
 
+/**
+ *  \brief  A variable controlling whether the 2D render API queues draw calls
+ *          and submits them to the driver in batches.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Every draw call is sent to the driver immediately
+ *    "1"       - Draw calls are queued and flushed at SDL_RenderPresent(),
+ *                SDL_RenderFlush() or when SDL needs the results
+ *
+ *  By default SDL batches on render drivers that support it.  This hint is
+ *  checked when the renderer is created.
+ */
+#define SDL_HINT_RENDER_BATCHING            "SDL_RENDER_BATCHING"
+
+/**
+ *  \brief  A variable controlling whether the ORBIS renderer only clears and
+ *          presents the parts of the screen that changed.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Every clear and present touches the whole framebuffer
+ *    "1"       - Damaged rectangles are tracked per display buffer and only
+ *                those are cleared, or copied from the previous frame
+ *
+ *  By default the whole framebuffer is used.  This hint is checked when the
+ *  renderer is created.  SDL_RenderGetORBISPixelsTouched() reports the
+ *  savings.
+ */
+#define SDL_HINT_ORBIS_RENDER_DIRTY_RECTS   "SDL_ORBIS_RENDER_DIRTY_RECTS"
+
+/**
+ *  \brief  A variable controlling whether the ORBIS window surface keeps its
+ *          contents after a full-window SDL_UpdateWindowSurface().
+ *
+ *  The window surface is the display back buffer itself, so after an update
+ *  it points at the buffer that held the frame before last.  The rects of a
+ *  partial update are always carried over from the frame just shown.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - After a full-window update the surface contents are
+ *                undefined, the application redraws all of it
+ *    "1"       - The whole window is copied over from the frame just shown,
+ *                which costs a full-screen copy per update
+ *
+ *  By default the contents are undefined.  This hint is checked when the
+ *  window surface is created.
+ */
+#define SDL_HINT_ORBIS_PRESERVE_WINDOW_SURFACE  "SDL_ORBIS_PRESERVE_WINDOW_SURFACE"
+
+/**
+ *  \brief  A variable setting how many times a contended spin lock or mutex
+ *          is retried with exponential backoff before the waiter yields.
+ *
+ *  The default is 16.  This hint is read the first time a lock is contended.
+ */
+#define SDL_HINT_SPINLOCK_SPIN_COUNT    "SDL_SPINLOCK_SPIN_COUNT"
+
+/**
+ *  \brief  A variable setting how many times a contended spin lock or mutex
+ *          yields its time slice before the waiter goes to sleep.
+ *
+ *  The default is 8.  This hint is read the first time a lock is contended.
+ */
+#define SDL_HINT_SPINLOCK_YIELD_COUNT   "SDL_SPINLOCK_YIELD_COUNT"
+
+/**
+ *  \brief  A variable controlling whether motion events are merged in the event queue.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Every motion event is queued (default)
+ *    "1"       - A SDL_MOUSEMOTION, SDL_JOYAXISMOTION or SDL_FINGERMOTION event
+ *                queued right behind one from the same device is merged into it.
+ *                The merged event has the newest position and the summed
+ *                relative motion.
+ */
+#define SDL_HINT_EVENT_COALESCING   "SDL_EVENT_COALESCING"
+
 /**
  *  \brief  A variable controlling whether the screensaver is enabled. 
  *
@@ -526,10 +602,19 @@ extern "C" {
 *  Use this hint in case you need to set SDL's threads stack size to other than the default.
 *  This is specially useful if you build SDL against a non glibc libc library (such as musl) which
 *  provides a relatively small default thread stack size (a few kilobytes versus the default 8MB glibc uses).
-*  Support for this hint is currently available only in the pthread, Windows, and PSP backend.
+*  Support for this hint is currently available only in the pthread, Windows, PSP and ORBIS backend.
 */
 #define SDL_HINT_THREAD_STACK_SIZE              "SDL_THREAD_STACK_SIZE"
 
+/**
+*  \brief  A comma separated list of "name=mask" pairs pinning SDL threads to CPU cores
+*
+*  Each thread created by SDL whose name matches an entry calls SDL_SetThreadAffinityMask()
+*  with that mask when it starts, e.g. "SDLAudioP1=0x10,SDLTimer=0x20".  The name "*"
+*  matches every thread without an entry of its own.  Masks may be decimal or hexadecimal.
+*/
+#define SDL_HINT_THREAD_AFFINITY                "SDL_THREAD_AFFINITY"
+
 /**
  *  \brief If set to 1, then do not allow high-DPI windows. ("Retina" on Mac and iOS)
  */
@@ -930,6 +1015,24 @@ extern "C" {
  */
 #define SDL_HINT_AUDIO_CATEGORY   "SDL_AUDIO_CATEGORY"
 
+/**
+ *  \brief  A variable making SDL_QueueAudio() use a fixed size lock-free queue
+ *
+ *  By default queued audio goes through a growable queue that the game
+ *  thread and the audio thread share under the device lock.  If this is set
+ *  to a number of milliseconds, a playback device opened without a callback
+ *  queues audio in a ring buffer of that length instead, which one thread
+ *  fills and the audio thread drains without either ever waiting on the
+ *  other.  SDL_QueueAudio() then fails, and counts an overrun, if the data
+ *  doesn't fit.  The audio thread also stops taking the device lock, so
+ *  SDL_LockAudioDevice() no longer stalls it.
+ *
+ *  Only one thread at a time may call SDL_QueueAudio() on such a device.
+ *
+ *  This hint is checked when the audio device is opened.
+ */
+#define SDL_HINT_AUDIO_QUEUE_LOCKFREE   "SDL_AUDIO_QUEUE_LOCKFREE"
+
 /**
  *  \brief  An enumeration of hint priorities
  */
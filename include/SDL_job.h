@@ -0,0 +1,108 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDL_job_h_
+#define SDL_job_h_
+
+/**
+ *  \file SDL_job.h
+ *
+ *  A pool of worker threads, one per extra CPU core, that run short jobs.
+ *
+ *  Jobs are queued per worker and idle workers steal from busy ones, so
+ *  jobs that submit more jobs spread over the pool on their own.  Jobs are
+ *  tracked through job groups: every job added to a group must be finished
+ *  before SDL_WaitJobGroup() on that group returns, including jobs added by
+ *  other jobs of the group while it waits.
+ */
+
+#include "SDL_stdinc.h"
+#include "SDL_error.h"
+
+#include "begin_code.h"
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  The function run by a job.
+ */
+typedef void (SDLCALL * SDL_JobFunction) (void *data);
+
+/* The SDL job group structure, defined in SDL_job.c */
+struct SDL_JobGroup;
+typedef struct SDL_JobGroup SDL_JobGroup;
+
+/**
+ *  Create a job group.
+ *
+ *  \return the new group, or NULL if it couldn't be created.
+ */
+extern DECLSPEC SDL_JobGroup *SDLCALL SDL_CreateJobGroup(void);
+
+/**
+ *  Destroy a job group.  Wait for it first if jobs might still be running.
+ */
+extern DECLSPEC void SDLCALL SDL_DestroyJobGroup(SDL_JobGroup * group);
+
+/**
+ *  Queue a job on the worker pool, starting the pool if needed.
+ *
+ *  \param group The group the job counts towards, or NULL to not track it.
+ *  \param fn The function to run.
+ *  \param data The argument passed to \c fn.
+ *
+ *  \return 0 on success.  If the job can't be queued it is run before
+ *          this function returns.
+ *
+ *  SDL_Quit() runs every job still queued before stopping the pool, so
+ *  waiting on a group never hangs.  Calling this after SDL_Quit() starts
+ *  the pool again.
+ */
+extern DECLSPEC int SDLCALL SDL_RunJob(SDL_JobGroup * group, SDL_JobFunction fn, void *data);
+
+/**
+ *  Wait until every job in a group has finished.
+ *
+ *  The calling thread runs queued jobs while it waits, so a job may wait
+ *  for the jobs it started, as long as they are in a group of their own:
+ *  a job waiting on its own group never returns.
+ */
+extern DECLSPEC void SDLCALL SDL_WaitJobGroup(SDL_JobGroup * group);
+
+/**
+ *  Get the number of worker threads in the pool, starting it if needed.
+ *
+ *  The pool has one worker per CPU core beside the calling one, so this
+ *  plus one is a good number of pieces to split work into.
+ */
+extern DECLSPEC int SDLCALL SDL_GetJobWorkerCount(void);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+#include "close_code.h"
+
+#endif /* SDL_job_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
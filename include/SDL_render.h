@@ -855,11 +855,57 @@ extern DECLSPEC int SDLCALL SDL_RenderReadPixels(SDL_Renderer * renderer,
                                                  Uint32 format,
                                                  void *pixels, int pitch);
 
+/**
+ *  \brief The function type called when an asynchronous pixel read finishes.
+ *
+ *  \param userdata The userdata passed to SDL_RenderReadPixelsAsync().
+ *  \param status   0 if the pixels were written, or -1 on error.
+ *
+ *  \note This may be called from a different thread than the one that
+ *        started the read.
+ */
+typedef void (SDLCALL * SDL_ReadPixelsCallback) (void *userdata, int status);
+
+/**
+ *  \brief Start reading pixels from the current rendering target without
+ *         waiting for the copy to finish.
+ *
+ *  The parameters are the same as for SDL_RenderReadPixels().  The read
+ *  sees everything rendered before the call; 'pixels' must stay valid until
+ *  'callback' has been called.  Drivers without native support read
+ *  synchronously and call 'callback' before returning.
+ *
+ *  \return 0 if the read was started, or -1 on error, in which case
+ *          'callback' is not called.
+ *
+ *  \sa SDL_RenderReadPixels()
+ */
+extern DECLSPEC int SDLCALL SDL_RenderReadPixelsAsync(SDL_Renderer * renderer,
+                                                      const SDL_Rect * rect,
+                                                      Uint32 format,
+                                                      void *pixels, int pitch,
+                                                      SDL_ReadPixelsCallback callback,
+                                                      void *userdata);
+
 /**
  *  \brief Update the screen with rendering performed.
  */
 extern DECLSPEC void SDLCALL SDL_RenderPresent(SDL_Renderer * renderer);
 
+/**
+ *  \brief Force the rendering context to submit any queued draw commands.
+ *
+ *  Queued commands are always submitted before SDL_RenderPresent(),
+ *  SDL_RenderReadPixels() and any texture operation that needs them, so
+ *  you only need this if you are mixing SDL rendering with direct access
+ *  to the render target.
+ *
+ *  \param renderer The renderer to flush.
+ *
+ *  \return 0 on success, or -1 if the driver failed to draw the queue.
+ */
+extern DECLSPEC int SDLCALL SDL_RenderFlush(SDL_Renderer * renderer);
+
 /**
  *  \brief Destroy the specified texture.
  *
@@ -358,6 +358,15 @@ char *alloca();
 #define SDL_stack_free(data)            SDL_free(data)
 #endif
 
+/**
+ *  \brief SDL's general purpose allocator
+ *
+ *  \note Each block starts past a small header SDL keeps in front of it,
+ *        and small blocks are cached per thread once freed.  Memory from
+ *        SDL_malloc(), SDL_calloc() and SDL_realloc() must be released with
+ *        SDL_free(), never with the C library's free() or the \c free_func
+ *        of SDL_GetMemoryFunctions().
+ */
 extern DECLSPEC void *SDLCALL SDL_malloc(size_t size);
 extern DECLSPEC void *SDLCALL SDL_calloc(size_t nmemb, size_t size);
 extern DECLSPEC void *SDLCALL SDL_realloc(void *mem, size_t size);
@@ -370,6 +379,15 @@ typedef void (SDLCALL *SDL_free_func)(void *mem);
 
 /**
  *  \brief Get the current set of SDL memory functions
+ *
+ *  \note SDL_malloc() builds its blocks on top of these functions, so memory
+ *        returned by SDL_malloc() must be released with SDL_free(), never by
+ *        calling \c free_func directly.
+ *
+ *  \note This is a compatibility break in this port: with upstream SDL,
+ *        \c free_func may release memory from SDL_malloc().  Code that
+ *        does so, such as a library handed SDL's memory functions, has to
+ *        be changed to call SDL_free() instead.
  */
 extern DECLSPEC void SDLCALL SDL_GetMemoryFunctions(SDL_malloc_func *malloc_func,
                                                     SDL_calloc_func *calloc_func,
@@ -382,7 +400,9 @@ extern DECLSPEC void SDLCALL SDL_GetMemoryFunctions(SDL_malloc_func *malloc_func
  *  \note If you are replacing SDL's memory functions, you should call
  *        SDL_GetNumAllocations() and be very careful if it returns non-zero.
  *        That means that your free function will be called with memory
- *        allocated by the previous memory allocation functions.
+ *        allocated by the previous memory allocation functions.  Blocks
+ *        SDL still has cached are given back to the functions they came
+ *        from, on each thread the next time it allocates or frees memory.
  */
 extern DECLSPEC int SDLCALL SDL_SetMemoryFunctions(SDL_malloc_func malloc_func,
                                                    SDL_calloc_func calloc_func,
@@ -147,6 +147,21 @@ extern DECLSPEC const char * SDLCALL SDL_AndroidGetExternalStoragePath(void);
 
 #endif /* __ANDROID__ */
 
+/* Platform specific functions for ORBIS */
+#if defined(__ORBIS__) && __ORBIS__
+
+/**
+   \brief Returns how many framebuffer pixels the last presented frame cleared, drew or copied.
+
+   Pixels written more than once are counted every time.  Returns 0 if the
+   renderer is not an ORBIS renderer.
+
+   \sa SDL_HINT_ORBIS_RENDER_DIRTY_RECTS
+ */
+extern DECLSPEC Uint64 SDLCALL SDL_RenderGetORBISPixelsTouched(SDL_Renderer * renderer);
+
+#endif /* __ORBIS__ */
+
 /* Platform specific functions for WinRT */
 #if defined(__WINRT__) && __WINRT__
 
@@ -190,6 +190,17 @@ extern DECLSPEC SDL_threadID SDLCALL SDL_GetThreadID(SDL_Thread * thread);
  */
 extern DECLSPEC int SDLCALL SDL_SetThreadPriority(SDL_ThreadPriority priority);
 
+/**
+ *  Restrict the current thread to the CPU cores set in \c mask, where bit n
+ *  stands for core n.
+ *
+ *  \return 0 on success, or -1 if the mask is empty or the platform doesn't
+ *          support affinity.
+ *
+ *  \sa SDL_HINT_THREAD_AFFINITY
+ */
+extern DECLSPEC int SDLCALL SDL_SetThreadAffinityMask(Uint64 mask);
+
 /**
  *  Wait for a thread to finish. Threads that haven't been detached will
  *  remain (as a "zombie") until this function cleans them up. Not doing so
@@ -44,6 +44,13 @@ extern "C" {
  */
 extern DECLSPEC Uint32 SDLCALL SDL_GetTicks(void);
 
+/**
+ * \brief Get the number of milliseconds since the SDL library initialization.
+ *
+ * \note Unlike SDL_GetTicks(), this value doesn't wrap.
+ */
+extern DECLSPEC Uint64 SDLCALL SDL_GetTicks64(void);
+
 /**
  * \brief Compare SDL ticks values, and return true if A has passed B
  *
@@ -33,6 +33,7 @@
 #include "events/SDL_events_c.h"
 #include "haptic/SDL_haptic_c.h"
 #include "joystick/SDL_joystick_c.h"
+#include "thread/SDL_job_c.h"
 
 /* Initialization/Cleanup routines */
 #if !SDL_TIMERS_DISABLED
@@ -347,6 +348,9 @@ SDL_Quit(void)
 {
     SDL_bInMainQuit = SDL_TRUE;
 
+    /* Jobs may still be using the subsystems */
+    SDL_JobsQuit();
+
     /* Quit all subsystems */
 #if SDL_VIDEO_DRIVER_WINDOWS
     SDL_HelperWindowDestroy();
@@ -25,8 +25,14 @@
 #endif
 
 #include "SDL_atomic.h"
+#include "SDL_hints.h"
 #include "SDL_mutex.h"
 #include "SDL_timer.h"
+#include "SDL_spinlock_c.h"
+
+#if defined(__ORBIS__)
+#include <kernel.h>
+#endif
 
 #if !defined(HAVE_GCC_ATOMICS) && defined(__SOLARIS__)
 #include <atomic.h>
@@ -72,7 +78,9 @@ SDL_AtomicTryLock(SDL_SpinLock *lock)
     return _SDL_xchg_watcom(lock, 1) == 0;
 
 #elif HAVE_GCC_ATOMICS || HAVE_GCC_SYNC_LOCK_TEST_AND_SET
-    return (__sync_lock_test_and_set(lock, 1) == 0);
+    /* Compare and swap rather than exchange, so a lock marked as having
+       parked waiters keeps that mark */
+    return __sync_bool_compare_and_swap(lock, 0, 1) ? SDL_TRUE : SDL_FALSE;
 
 #elif defined(__GNUC__) && defined(__arm__) && \
         (defined(__ARM_ARCH_4__) || defined(__ARM_ARCH_4T__) || \
@@ -116,12 +124,185 @@ SDL_AtomicTryLock(SDL_SpinLock *lock)
 #endif
 }
 
+/* Contention tuning and counters */
+#define SDL_DEFAULT_SPIN_COUNT  16
+#define SDL_DEFAULT_YIELD_COUNT 8
+#define SDL_MAX_BACKOFF         64
+
+static int SDL_spin_count = -1;
+static int SDL_yield_count = -1;
+static SDL_atomic_t SDL_lock_contended;
+static SDL_atomic_t SDL_lock_yields;
+static SDL_atomic_t SDL_lock_parks;
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define SDL_CPUPause() __asm__ __volatile__("pause\n")
+#else
+#define SDL_CPUPause() SDL_CompilerBarrier()
+#endif
+
+#if defined(__ORBIS__)
+#define SDL_CPUYield() scePthreadYield()
+#else
+#define SDL_CPUYield() SDL_Delay(0)
+#endif
+
+static int
+GetLockHint(const char *name, int default_value)
+{
+    const char *hint = SDL_GetHint(name);
+    if (hint && *hint) {
+        return SDL_max(SDL_atoi(hint), 0);
+    }
+    return default_value;
+}
+
+SDL_bool
+SDL_SpinTryLock(SDL_TryLockFunc trylock, void *lock)
+{
+    int i, j, backoff = 1;
+
+    if (SDL_spin_count < 0) {
+        SDL_spin_count = GetLockHint(SDL_HINT_SPINLOCK_SPIN_COUNT, SDL_DEFAULT_SPIN_COUNT);
+        SDL_yield_count = GetLockHint(SDL_HINT_SPINLOCK_YIELD_COUNT, SDL_DEFAULT_YIELD_COUNT);
+    }
+
+    SDL_AtomicIncRef(&SDL_lock_contended);
+
+    /* Short critical sections are usually over within a few hundred cycles */
+    for (i = 0; i < SDL_spin_count; ++i) {
+        for (j = 0; j < backoff; ++j) {
+            SDL_CPUPause();
+        }
+        if (trylock(lock)) {
+            return SDL_TRUE;
+        }
+        backoff = SDL_min(backoff * 2, SDL_MAX_BACKOFF);
+    }
+
+    /* The owner may have been preempted, give it our time slice */
+    for (i = 0; i < SDL_yield_count; ++i) {
+        SDL_AtomicIncRef(&SDL_lock_yields);
+        SDL_CPUYield();
+        if (trylock(lock)) {
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+void
+SDL_CountLockPark(void)
+{
+    SDL_AtomicIncRef(&SDL_lock_parks);
+}
+
+void
+SDL_GetLockContentionStats(SDL_LockContentionStats *stats)
+{
+    if (stats) {
+        stats->contended = SDL_AtomicGet(&SDL_lock_contended);
+        stats->yields = SDL_AtomicGet(&SDL_lock_yields);
+        stats->parks = SDL_AtomicGet(&SDL_lock_parks);
+    }
+}
+
+void
+SDL_ResetLockContentionStats(void)
+{
+    SDL_AtomicSet(&SDL_lock_contended, 0);
+    SDL_AtomicSet(&SDL_lock_yields, 0);
+    SDL_AtomicSet(&SDL_lock_parks, 0);
+}
+
+static SDL_bool
+SpinLockTryLock(void *lock)
+{
+    return SDL_AtomicTryLock((SDL_SpinLock *) lock);
+}
+
+#if (HAVE_GCC_ATOMICS || HAVE_GCC_SYNC_LOCK_TEST_AND_SET) && !SDL_ATOMIC_DISABLED && !SDL_THREADS_DISABLED
+#define SDL_PARKING_LOT 1
+
+/* Waiters that give up spinning sleep on a condition variable picked by
+   hashing the lock address, like a futex.  A lock word of 2 means the lock
+   is held and somebody may be sleeping on it, which tells the unlocker to
+   wake the bucket.
+ */
+#define SDL_PARKING_BUCKETS 16
+
+typedef struct SDL_ParkingBucket
+{
+    SDL_mutex *mutex;
+    SDL_cond *cond;
+} SDL_ParkingBucket;
+
+static SDL_ParkingBucket *SDL_parking_lot[SDL_PARKING_BUCKETS];
+
+static SDL_ParkingBucket *
+GetParkingBucket(SDL_SpinLock *lock, SDL_bool create)
+{
+    const uintptr_t addr = (uintptr_t) lock;
+    SDL_ParkingBucket **slot = &SDL_parking_lot[((addr >> 2) ^ (addr >> 8)) % SDL_PARKING_BUCKETS];
+    SDL_ParkingBucket *bucket = (SDL_ParkingBucket *) SDL_AtomicGetPtr((void **) slot);
+
+    if (bucket || !create) {
+        return bucket;
+    }
+
+    bucket = (SDL_ParkingBucket *) SDL_calloc(1, sizeof(*bucket));
+    if (!bucket) {
+        return NULL;
+    }
+    bucket->mutex = SDL_CreateMutex();
+    bucket->cond = SDL_CreateCond();
+    if (!bucket->mutex || !bucket->cond ||
+        !SDL_AtomicCASPtr((void **) slot, NULL, bucket)) {
+        /* Failed, or another thread installed its bucket first */
+        if (bucket->mutex) {
+            SDL_DestroyMutex(bucket->mutex);
+        }
+        if (bucket->cond) {
+            SDL_DestroyCond(bucket->cond);
+        }
+        SDL_free(bucket);
+    }
+    return (SDL_ParkingBucket *) SDL_AtomicGetPtr((void **) slot);
+}
+#endif /* SDL_PARKING_LOT */
+
 void
 SDL_AtomicLock(SDL_SpinLock *lock)
 {
-    /* FIXME: Should we have an eventual timeout? */
+#ifdef SDL_PARKING_LOT
+    SDL_ParkingBucket *bucket;
+#endif
+
+    if (SDL_AtomicTryLock(lock)) {
+        return;
+    }
+    if (SDL_SpinTryLock(SpinLockTryLock, lock)) {
+        return;
+    }
+
+#ifdef SDL_PARKING_LOT
+    bucket = GetParkingBucket(lock, SDL_TRUE);
+    if (bucket) {
+        SDL_CountLockPark();
+        SDL_LockMutex(bucket->mutex);
+        /* Taking a free lock here leaves it marked, costing one spurious
+           wakeup at unlock time */
+        while (__sync_lock_test_and_set(lock, 2) != 0) {
+            SDL_CondWait(bucket->cond, bucket->mutex);
+        }
+        SDL_UnlockMutex(bucket->mutex);
+        return;
+    }
+#endif
+
+    /* No way to sleep, keep yielding */
     while (!SDL_AtomicTryLock(lock)) {
-        SDL_Delay(0);
+        SDL_CPUYield();
     }
 }
 
@@ -136,6 +317,17 @@ SDL_AtomicUnlock(SDL_SpinLock *lock)
     SDL_CompilerBarrier ();
     *lock = 0;
 
+#elif defined(SDL_PARKING_LOT)
+    __sync_synchronize();
+    if (__sync_lock_test_and_set(lock, 0) == 2) {
+        SDL_ParkingBucket *bucket = GetParkingBucket(lock, SDL_FALSE);
+        if (bucket) {
+            SDL_LockMutex(bucket->mutex);
+            SDL_CondBroadcast(bucket->cond);
+            SDL_UnlockMutex(bucket->mutex);
+        }
+    }
+
 #elif HAVE_GCC_ATOMICS || HAVE_GCC_SYNC_LOCK_TEST_AND_SET
     __sync_lock_release(lock);
 
@@ -0,0 +1,41 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2015 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+#ifndef SDL_spinlock_c_h_
+#define SDL_spinlock_c_h_
+
+#include "SDL_stdinc.h"
+
+/* Returns SDL_TRUE if the lock was taken */
+typedef SDL_bool (*SDL_TryLockFunc)(void *lock);
+
+/* Spins with exponential backoff, then yields, calling trylock until it
+   succeeds or the limits set by SDL_HINT_SPINLOCK_SPIN_COUNT and
+   SDL_HINT_SPINLOCK_YIELD_COUNT run out.  Returns SDL_FALSE if the caller
+   should block; it must call SDL_CountLockPark() when it does.
+ */
+extern SDL_bool SDL_SpinTryLock(SDL_TryLockFunc trylock, void *lock);
+extern void SDL_CountLockPark(void);
+
+#endif /* SDL_spinlock_c_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -257,6 +257,12 @@ SDL_AudioGetPendingBytes_Default(_THIS)
     return 0;
 }
 
+static int
+SDL_AudioGetDeviceLatency_Default(_THIS)
+{
+    return _this->spec.samples;  /* assume the device plays one buffer while we mix the next. */
+}
+
 static Uint8 *
 SDL_AudioGetDeviceBuf_Default(_THIS)
 {
@@ -365,6 +371,7 @@ finish_audio_entry_points_init(void)
     FILL_STUB(WaitDevice);
     FILL_STUB(PlayDevice);
     FILL_STUB(GetPendingBytes);
+    FILL_STUB(GetDeviceLatency);
     FILL_STUB(GetDeviceBuf);
     FILL_STUB(CaptureFromDevice);
     FILL_STUB(FlushCapture);
@@ -522,6 +529,16 @@ SDL_RemoveAudioDevice(const int iscapture, void *handle)
 
 /* buffer queueing support... */
 
+/* Count running out of queued audio once, not for every buffer we stay out. */
+static void
+SDL_UpdateAudioStarvation(SDL_AudioDevice *device, const SDL_bool starved)
+{
+    if (starved && !device->starved) {
+        SDL_AtomicAdd(&device->underruns, 1);
+    }
+    device->starved = starved;
+}
+
 static void SDLCALL
 SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
 {
@@ -541,6 +558,86 @@ SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
         SDL_assert(SDL_CountDataQueue(device->buffer_queue) == 0);
         SDL_memset(stream, device->spec.silence, len);
     }
+    SDL_UpdateAudioStarvation(device, (len > 0) ? SDL_TRUE : SDL_FALSE);
+}
+
+/* Bytes queued in the ring that haven't been played or cleared, for reporting.
+   Free space comes from the real tail, see SDL_QueueAudioRing() */
+static Uint32
+SDL_AudioRingQueued(SDL_AudioDevice *device, const Uint32 head, Uint32 tail)
+{
+    const Uint32 clear = (Uint32) SDL_AtomicGet(&device->ring_clear);
+
+    if ((Sint32) (clear - tail) > 0) {
+        tail = clear;
+    }
+    /* A clear after the caller read the head can be ahead of it */
+    return ((Sint32) (head - tail) > 0) ? head - tail : 0;
+}
+
+static void SDLCALL
+SDL_BufferRingDrainCallback(void *userdata, Uint8 *stream, int len)
+{
+    /* this runs on the audio thread without the mixer lock; it is the ring's only reader. */
+    SDL_AudioDevice *device = (SDL_AudioDevice *) userdata;
+    const Uint32 mask = device->ring_size - 1;
+    /* The clear position before the head: a clear landing in between would
+       otherwise put it past the head we copy up to */
+    const Uint32 clear = (Uint32) SDL_AtomicGet(&device->ring_clear);
+    const Uint32 head = (Uint32) SDL_AtomicGet(&device->ring_head);
+    Uint32 tail = (Uint32) SDL_AtomicGet(&device->ring_tail);
+    Uint32 avail, cpy, first;
+
+    SDL_assert(device != NULL);  /* this shouldn't ever happen, right?! */
+    SDL_assert(!device->iscapture);  /* this shouldn't ever happen, right?! */
+    SDL_assert(len >= 0);  /* this shouldn't ever happen, right?! */
+
+    SDL_MemoryBarrierAcquire();  /* see the data SDL_QueueAudio() wrote before moving the head */
+
+    if ((Sint32) (clear - tail) > 0) {
+        tail = clear;  /* SDL_ClearQueuedAudio() dropped everything up to here */
+    }
+
+    avail = head - tail;
+    cpy = SDL_min(avail, (Uint32) len);
+    first = SDL_min(cpy, device->ring_size - (tail & mask));
+    SDL_memcpy(stream, device->ring + (tail & mask), first);
+    SDL_memcpy(stream + first, device->ring, cpy - first);
+    tail += cpy;
+
+    if (cpy < (Uint32) len) {  /* fill any remaining space in the stream with silence. */
+        SDL_memset(stream + cpy, device->spec.silence, len - cpy);
+    }
+    SDL_UpdateAudioStarvation(device, (cpy < (Uint32) len) ? SDL_TRUE : SDL_FALSE);
+
+    SDL_AtomicSet(&device->ring_tail, (int) tail);
+
+    /* Keep the clear position near the tail so it can't look ahead of it after wrapping around */
+    SDL_AtomicCAS(&device->ring_clear, (int) clear, (int) tail);
+}
+
+static int
+SDL_QueueAudioRing(SDL_AudioDevice *device, const void *data, Uint32 len)
+{
+    /* the ring's only writer, so the head can't move under us. */
+    const Uint32 mask = device->ring_size - 1;
+    const Uint32 head = (Uint32) SDL_AtomicGet(&device->ring_head);
+    /* Cleared bytes still count until the audio thread moves the tail past
+       them, it may be copying from them right now */
+    const Uint32 used = head - (Uint32) SDL_AtomicGet(&device->ring_tail);
+    const Uint32 first = SDL_min(len, device->ring_size - (head & mask));
+
+    if (len > (device->ring_size - used)) {
+        SDL_AtomicAdd(&device->overruns, 1);
+        return SDL_SetError("Audio queue is full");
+    }
+
+    SDL_memcpy(device->ring + (head & mask), data, first);
+    SDL_memcpy(device->ring, ((const Uint8 *) data) + first, len - first);
+
+    SDL_MemoryBarrierRelease();  /* the data has to be there before the audio thread sees the new head */
+    SDL_AtomicSet(&device->ring_head, (int) (head + len));
+    return 0;
 }
 
 static void SDLCALL
@@ -569,6 +666,8 @@ SDL_QueueAudio(SDL_AudioDeviceID devid, const void *data, Uint32 len)
         return -1;  /* get_audio_device() will have set the error state */
     } else if (device->iscapture) {
         return SDL_SetError("This is a capture device, queueing not allowed");
+    } else if (device->callbackspec.callback == SDL_BufferRingDrainCallback) {
+        return (len > 0) ? SDL_QueueAudioRing(device, data, len) : 0;
     } else if (device->callbackspec.callback != SDL_BufferQueueDrainCallback) {
         return SDL_SetError("Audio device has a callback, queueing not allowed");
     }
@@ -612,7 +711,12 @@ SDL_GetQueuedAudioSize(SDL_AudioDeviceID devid)
     }
 
     /* Nothing to do unless we're set up for queueing. */
-    if (device->callbackspec.callback == SDL_BufferQueueDrainCallback) {
+    if (device->callbackspec.callback == SDL_BufferRingDrainCallback) {
+        retval = SDL_AudioRingQueued(device, (Uint32) SDL_AtomicGet(&device->ring_head), (Uint32) SDL_AtomicGet(&device->ring_tail));
+        current_audio.impl.LockDevice(device);
+        retval += current_audio.impl.GetPendingBytes(device);
+        current_audio.impl.UnlockDevice(device);
+    } else if (device->callbackspec.callback == SDL_BufferQueueDrainCallback) {
         current_audio.impl.LockDevice(device);
         retval = ((Uint32) SDL_CountDataQueue(device->buffer_queue)) + current_audio.impl.GetPendingBytes(device);
         current_audio.impl.UnlockDevice(device);
@@ -634,6 +738,12 @@ SDL_ClearQueuedAudio(SDL_AudioDeviceID devid)
         return;  /* nothing to do. */
     }
 
+    if (device->ring) {
+        /* The audio thread owns the tail; have it skip what's queued now. */
+        SDL_AtomicSet(&device->ring_clear, SDL_AtomicGet(&device->ring_head));
+        return;
+    }
+
     /* Blank out the device and release the mutex. Free it afterwards. */
     current_audio.impl.LockDevice(device);
 
@@ -643,6 +753,44 @@ SDL_ClearQueuedAudio(SDL_AudioDeviceID devid)
     current_audio.impl.UnlockDevice(device);
 }
 
+int
+SDL_GetAudioDeviceLatency(SDL_AudioDeviceID devid)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    int retval;
+
+    if (!device) {
+        return -1;  /* get_audio_device() will have set the error state */
+    }
+
+    current_audio.impl.LockDevice(device);
+    retval = current_audio.impl.GetDeviceLatency(device);
+    if (device->stream) {
+        /* converted audio waiting for the device to want it */
+        const int framelen = (SDL_AUDIO_BITSIZE(device->spec.format) / 8) * device->spec.channels;
+        retval += SDL_AudioStreamAvailable(device->stream) / framelen;
+    }
+    current_audio.impl.UnlockDevice(device);
+
+    return retval;
+}
+
+int
+SDL_GetQueuedAudioStats(SDL_AudioDeviceID devid, SDL_AudioQueueStats *stats)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+
+    if (!device) {
+        return -1;  /* get_audio_device() will have set the error state */
+    } else if (!stats) {
+        return SDL_InvalidParamError("stats");
+    }
+
+    stats->underruns = (Uint32) SDL_AtomicGet(&device->underruns);
+    stats->overruns = (Uint32) SDL_AtomicGet(&device->overruns);
+    return 0;
+}
+
 
 /* The general mixing thread function */
 static int SDLCALL
@@ -686,14 +834,17 @@ SDL_RunAudio(void *devicep)
             data = device->work_buffer;
         }
 
-        /* !!! FIXME: this should be LockDevice. */
-        SDL_LockMutex(device->mixer_lock);
         if (SDL_AtomicGet(&device->paused)) {
             SDL_memset(data, device->spec.silence, data_len);
+        } else if (device->ring) {
+            /* the lock-free queue doesn't need the lock, so the app can't stall us. */
+            callback(udata, data, data_len);
         } else {
+            /* !!! FIXME: this should be LockDevice. */
+            SDL_LockMutex(device->mixer_lock);
             callback(udata, data, data_len);
+            SDL_UnlockMutex(device->mixer_lock);
         }
-        SDL_UnlockMutex(device->mixer_lock);
 
         if (device->stream) {
             /* Stream available audio to device, converting/resampling. */
@@ -1085,6 +1236,7 @@ close_audio_device(SDL_AudioDevice * device)
     }
 
     SDL_FreeDataQueue(device->buffer_queue);
+    SDL_free(device->ring);
 
     SDL_free(device);
 }
@@ -1350,7 +1502,26 @@ open_audio_device(const char *devname, int iscapture,
         }
     }
 
-    if (device->spec.callback == NULL) {  /* use buffer queueing? */
+    if ((device->spec.callback == NULL) && !iscapture && SDL_GetHint(SDL_HINT_AUDIO_QUEUE_LOCKFREE)) {
+        /* fixed size lock-free queue */
+        const int ms = SDL_atoi(SDL_GetHint(SDL_HINT_AUDIO_QUEUE_LOCKFREE));
+        const Uint32 framelen = (SDL_AUDIO_BITSIZE(obtained->format) / 8) * obtained->channels;
+        Uint32 wanted = (Uint32) (((Uint64) SDL_max(ms, 0) * obtained->freq / 1000) * framelen);
+
+        wanted = SDL_max(wanted, obtained->size * 2);
+        device->ring_size = 1;
+        while (device->ring_size < wanted) {
+            device->ring_size <<= 1;
+        }
+        device->ring = (Uint8 *) SDL_malloc(device->ring_size);
+        if (!device->ring) {
+            close_audio_device(device);
+            SDL_OutOfMemory();
+            return 0;
+        }
+        device->callbackspec.callback = SDL_BufferRingDrainCallback;
+        device->callbackspec.userdata = device;
+    } else if (device->spec.callback == NULL) {  /* use buffer queueing? */
         /* pool a few packets to start. Enough for two callbacks. */
         device->buffer_queue = SDL_NewDataQueue(SDL_AUDIOBUFFERQUEUE_PACKETLEN, obtained->size * 2);
         if (!device->buffer_queue) {
@@ -40,6 +40,15 @@
 #define HAVE_SSE3_INTRINSICS 1
 #endif
 
+#ifdef __SSE2__
+#define HAVE_SSE2_INTRINSICS 1
+#endif
+
+#ifdef __AVX__
+#define HAVE_AVX_INTRINSICS 1
+#include <immintrin.h>
+#endif
+
 #if HAVE_SSE3_INTRINSICS
 /* Convert from stereo to mono. Average left and right. */
 static void SDLCALL
@@ -480,15 +489,211 @@ ResamplerPadding(const int inrate, const int outrate)
     return RESAMPLER_SAMPLES_PER_ZERO_CROSSING;
 }
 
-/* lpadding and rpadding are expected to be buffers of (ResamplePadding(inrate, outrate) * chans * sizeof (float)) bytes. */
+/* Each output frame is computed from a window of input frames around its
+   position: RESAMPLER_ZERO_CROSSINGS + 1 frames for the left wing of the
+   filter, ending at the input frame before the output position, and as many
+   for the right wing after it.  The weights of the window only depend on
+   where the output frame falls between two input frames, and for a ratio
+   of inrate:outrate reduced to M:L there are only L such phases, which we
+   can compute up front (44100 -> 48000 is 147:160). */
+#define RESAMPLER_TAPS ((RESAMPLER_ZERO_CROSSINGS + 1) * 2)
+#define RESAMPLER_MAX_PHASES 1024
+
+typedef void (*SDL_ResampleFrameFunc)(const int chans, const float *coeffs, const float *src, float *dst);
+
+static int
+ResamplerGCD(int a, int b)
+{
+    while (b != 0) {
+        const int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* interpolation is how far the output frame is past the input frame at
+   the center of the window, from 0.0 to 1.0. */
+static void
+ResamplerCoefficients(float *coeffs, const double interpolation1)
+{
+    const double interpolation2 = 1.0 - interpolation1;
+    const int filterindex1 = (int) (interpolation1 * RESAMPLER_SAMPLES_PER_ZERO_CROSSING);
+    const int filterindex2 = (int) (interpolation2 * RESAMPLER_SAMPLES_PER_ZERO_CROSSING);
+    int i, j;
+
+    SDL_memset(coeffs, '\0', RESAMPLER_TAPS * sizeof (float));
+
+    for (j = 0; (i = filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) < RESAMPLER_FILTER_SIZE; j++) {
+        coeffs[RESAMPLER_ZERO_CROSSINGS - j] = (float) (ResamplerFilter[i] + (interpolation1 * ResamplerFilterDifference[i]));
+    }
+
+    for (j = 0; (i = filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) < RESAMPLER_FILTER_SIZE; j++) {
+        coeffs[RESAMPLER_ZERO_CROSSINGS + 1 + j] = (float) (ResamplerFilter[i] + (interpolation2 * ResamplerFilterDifference[i]));
+    }
+}
+
+/* Returns NULL if the rates have too many phases to be worth a table. */
+static float *
+SDL_BuildResamplerPhases(const int inrate, const int outrate)
+{
+    const int phases = outrate / ResamplerGCD(inrate, outrate);
+    float *retval;
+    int i;
+
+    if (phases > RESAMPLER_MAX_PHASES) {
+        return NULL;
+    }
+
+    retval = (float *) SDL_malloc(phases * RESAMPLER_TAPS * sizeof (float));
+    if (retval) {
+        for (i = 0; i < phases; i++) {
+            ResamplerCoefficients(retval + (i * RESAMPLER_TAPS), ((double) i) / ((double) phases));
+        }
+    }
+    return retval;
+}
+
+static void
+SDL_ResampleFrame_Scalar(const int chans, const float *coeffs, const float *src, float *dst)
+{
+    int chan, i;
+
+    for (chan = 0; chan < chans; chan++) {
+        float outsample = 0.0f;
+        for (i = 0; i < RESAMPLER_TAPS; i++) {
+            outsample += coeffs[i] * src[(i * chans) + chan];
+        }
+        dst[chan] = outsample;
+    }
+}
+
+#if HAVE_SSE2_INTRINSICS
+/* These work on all channels of the frame at once: the window is RESAMPLER_TAPS
+   consecutive frames, so it's a multiple of 4 floats for any of them. */
+static void
+SDL_ResampleFrame_Mono_SSE2(const int chans, const float *coeffs, const float *src, float *dst)
+{
+    __m128 sum = _mm_mul_ps(_mm_loadu_ps(coeffs), _mm_loadu_ps(src));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(coeffs + 4), _mm_loadu_ps(src + 4)));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(coeffs + 8), _mm_loadu_ps(src + 8)));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+    _mm_store_ss(dst, sum);
+}
+
+static void
+SDL_ResampleFrame_Stereo_SSE2(const int chans, const float *coeffs, const float *src, float *dst)
+{
+    __m128 sum = _mm_setzero_ps();
+    int i;
+
+    for (i = 0; i < RESAMPLER_TAPS; i += 4) {
+        const __m128 c = _mm_loadu_ps(coeffs + i);
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_unpacklo_ps(c, c), _mm_loadu_ps(src + (i * 2))));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_unpackhi_ps(c, c), _mm_loadu_ps(src + (i * 2) + 4)));
+    }
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    _mm_storel_pi((__m64 *) dst, sum);
+}
+
+static void
+SDL_ResampleFrame_Quad_SSE2(const int chans, const float *coeffs, const float *src, float *dst)
+{
+    __m128 sum = _mm_setzero_ps();
+    int i;
+
+    for (i = 0; i < RESAMPLER_TAPS; i++) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(coeffs[i]), _mm_loadu_ps(src + (i * 4))));
+    }
+    _mm_storeu_ps(dst, sum);
+}
+
+static void
+SDL_ResampleFrame_71_SSE2(const int chans, const float *coeffs, const float *src, float *dst)
+{
+    __m128 sum1 = _mm_setzero_ps();
+    __m128 sum2 = _mm_setzero_ps();
+    int i;
+
+    for (i = 0; i < RESAMPLER_TAPS; i++) {
+        const __m128 c = _mm_set1_ps(coeffs[i]);
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(c, _mm_loadu_ps(src + (i * 8))));
+        sum2 = _mm_add_ps(sum2, _mm_mul_ps(c, _mm_loadu_ps(src + (i * 8) + 4)));
+    }
+    _mm_storeu_ps(dst, sum1);
+    _mm_storeu_ps(dst + 4, sum2);
+}
+#endif
+
+#if HAVE_AVX_INTRINSICS
+static void
+SDL_ResampleFrame_71_AVX(const int chans, const float *coeffs, const float *src, float *dst)
+{
+    __m256 sum = _mm256_setzero_ps();
+    int i;
+
+    for (i = 0; i < RESAMPLER_TAPS; i++) {
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_broadcast_ss(coeffs + i), _mm256_loadu_ps(src + (i * 8))));
+    }
+    _mm256_storeu_ps(dst, sum);
+}
+#endif
+
+static SDL_ResampleFrameFunc
+SDL_ChooseResampleFrameFunc(const int chans)
+{
+#if HAVE_AVX_INTRINSICS
+    if (chans == 8 && SDL_HasAVX()) {
+        return SDL_ResampleFrame_71_AVX;
+    }
+#endif
+#if HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        switch (chans) {
+            case 1: return SDL_ResampleFrame_Mono_SSE2;
+            case 2: return SDL_ResampleFrame_Stereo_SSE2;
+            case 4: return SDL_ResampleFrame_Quad_SSE2;
+            case 8: return SDL_ResampleFrame_71_SSE2;
+            default: break;
+        }
+    }
+#endif
+    return SDL_ResampleFrame_Scalar;
+}
+
+/* Copy the window of a frame that reaches into the padding to (window). */
+static const float *
+ResamplerWindow(const int chans, const int first, const int paddinglen,
+                const float *lpadding, const float *rpadding,
+                const float *inbuf, const int inframes, float *window)
+{
+    int i;
+
+    for (i = 0; i < RESAMPLER_TAPS; i++) {
+        const int srcframe = first + i;
+        const float *insample;
+        if (srcframe < 0) {
+            insample = lpadding + ((paddinglen + srcframe) * chans);
+        } else if (srcframe >= inframes) {
+            insample = rpadding + ((srcframe - inframes) * chans);
+        } else {
+            insample = inbuf + (srcframe * chans);
+        }
+        SDL_memcpy(window + (i * chans), insample, chans * sizeof (float));
+    }
+    return window;
+}
+
+/* lpadding and rpadding are expected to be buffers of (ResamplePadding(inrate, outrate) * chans * sizeof (float)) bytes.
+   phases is the table from SDL_BuildResamplerPhases(), or NULL to compute the weights as we go. */
 static int
 SDL_ResampleAudio(const int chans, const int inrate, const int outrate,
                         const float *lpadding, const float *rpadding,
+                        const float *phases,
                         const float *inbuf, const int inbuflen,
                         float *outbuf, const int outbuflen)
 {
-    const double finrate = (double) inrate;
-    const double outtimeincr = 1.0 / ((float) outrate);
     const double  ratio = ((float) outrate) / ((float) inrate);
     const int paddinglen = ResamplerPadding(inrate, outrate);
     const int framelen = chans * (int)sizeof (float);
@@ -496,43 +701,58 @@ SDL_ResampleAudio(const int chans, const int inrate, const int outrate,
     const int wantedoutframes = (int) ((inbuflen / framelen) * ratio);  /* outbuflen isn't total to write, it's total available. */
     const int maxoutframes = outbuflen / framelen;
     const int outframes = SDL_min(wantedoutframes, maxoutframes);
+    const int gcd = ResamplerGCD(inrate, outrate);
+    const int numphases = outrate / gcd;
+    const int step = inrate / gcd;  /* input frames per numphases output frames */
+    const SDL_ResampleFrameFunc ResampleFrame = SDL_ChooseResampleFrameFunc(chans);
+    float window[RESAMPLER_TAPS * 8];
+    float coeffbuf[RESAMPLER_TAPS];
+    const float *coeffs;
     float *dst = outbuf;
-    double outtime = 0.0;
-    int i, j, chan;
-
-    for (i = 0; i < outframes; i++) {
-        const int srcindex = (int) (outtime * inrate);
-        const double intime = ((double) srcindex) / finrate;
-        const double innexttime = ((double) (srcindex + 1)) / finrate;
-        const double interpolation1 = 1.0 - ((innexttime - outtime) / (innexttime - intime));
-        const int filterindex1 = (int) (interpolation1 * RESAMPLER_SAMPLES_PER_ZERO_CROSSING);
-        const double interpolation2 = 1.0 - interpolation1;
-        const int filterindex2 = (int) (interpolation2 * RESAMPLER_SAMPLES_PER_ZERO_CROSSING);
-
-        for (chan = 0; chan < chans; chan++) {
-            float outsample = 0.0f;
-
-            /* do this twice to calculate the sample, once for the "left wing" and then same for the right. */
-            /* !!! FIXME: do both wings in one loop */
-            for (j = 0; (filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) < RESAMPLER_FILTER_SIZE; j++) {
-                const int srcframe = srcindex - j;
-                /* !!! FIXME: we can bubble this conditional out of here by doing a pre loop. */
-                const float insample = (srcframe < 0) ? lpadding[((paddinglen + srcframe) * chans) + chan] : inbuf[(srcframe * chans) + chan];
-                outsample += (float)(insample * (ResamplerFilter[filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)] + (interpolation1 * ResamplerFilterDifference[filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)])));
-            }
-
-            for (j = 0; (filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) < RESAMPLER_FILTER_SIZE; j++) {
-                const int srcframe = srcindex + 1 + j;
-                /* !!! FIXME: we can bubble this conditional out of here by doing a post loop. */
-                const float insample = (srcframe >= inframes) ? rpadding[((srcframe - inframes) * chans) + chan] : inbuf[(srcframe * chans) + chan];
-                outsample += (float)(insample * (ResamplerFilter[filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)] + (interpolation2 * ResamplerFilterDifference[filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)])));
-            }
-            *(dst++) = outsample;
+    int srcindex = 0;  /* output position is (phase / numphases) past this input frame */
+    int phase = 0;
+    int i = 0;
+
+    SDL_assert(chans <= 8);
+    SDL_assert(paddinglen >= RESAMPLER_TAPS);
+
+    #define RESAMPLER_COEFFS() \
+        (phases ? (phases + (phase * RESAMPLER_TAPS)) : \
+         (ResamplerCoefficients(coeffbuf, ((double) phase) / ((double) numphases)), coeffbuf))
+
+    #define RESAMPLER_NEXT_FRAME() \
+        dst += chans; \
+        srcindex += step / numphases; \
+        phase += step % numphases; \
+        if (phase >= numphases) { \
+            phase -= numphases; \
+            srcindex++; \
         }
 
-        outtime += outtimeincr;
+    /* Frames whose window starts in the left padding */
+    for ( ; (i < outframes) && (srcindex < RESAMPLER_ZERO_CROSSINGS); i++) {
+        coeffs = RESAMPLER_COEFFS();
+        ResampleFrame(chans, coeffs, ResamplerWindow(chans, srcindex - RESAMPLER_ZERO_CROSSINGS, paddinglen, lpadding, rpadding, inbuf, inframes, window), dst);
+        RESAMPLER_NEXT_FRAME();
+    }
+
+    /* Frames whose window is all in the input buffer */
+    for ( ; (i < outframes) && ((srcindex - RESAMPLER_ZERO_CROSSINGS + RESAMPLER_TAPS) <= inframes); i++) {
+        coeffs = RESAMPLER_COEFFS();
+        ResampleFrame(chans, coeffs, inbuf + ((srcindex - RESAMPLER_ZERO_CROSSINGS) * chans), dst);
+        RESAMPLER_NEXT_FRAME();
+    }
+
+    /* Frames whose window ends in the right padding */
+    for ( ; i < outframes; i++) {
+        coeffs = RESAMPLER_COEFFS();
+        ResampleFrame(chans, coeffs, ResamplerWindow(chans, srcindex - RESAMPLER_ZERO_CROSSINGS, paddinglen, lpadding, rpadding, inbuf, inframes, window), dst);
+        RESAMPLER_NEXT_FRAME();
     }
 
+    #undef RESAMPLER_COEFFS
+    #undef RESAMPLER_NEXT_FRAME
+
     return outframes * chans * sizeof (float);
 }
 
@@ -720,6 +940,7 @@ SDL_ResampleCVT(SDL_AudioCVT *cvt, const int chans, const SDL_AudioFormat format
     const int dstlen = (cvt->len * cvt->len_mult) - srclen;
     const int paddingsamples = (ResamplerPadding(inrate, outrate) * chans);
     float *padding;
+    float *phases;
 
     SDL_assert(format == AUDIO_F32SYS);
 
@@ -730,8 +951,12 @@ SDL_ResampleCVT(SDL_AudioCVT *cvt, const int chans, const SDL_AudioFormat format
         return;
     }
 
-    cvt->len_cvt = SDL_ResampleAudio(chans, inrate, outrate, padding, padding, src, srclen, dst, dstlen);
+    /* worth it even for one buffer: there are far fewer phases than frames for common rates */
+    phases = SDL_BuildResamplerPhases(inrate, outrate);
+
+    cvt->len_cvt = SDL_ResampleAudio(chans, inrate, outrate, padding, padding, phases, src, srclen, dst, dstlen);
 
+    SDL_free(phases);
     SDL_free(padding);
 
     SDL_memmove(cvt->buf, dst, cvt->len_cvt);  /* !!! FIXME: remove this if we can get the resampler to work in-place again. */
@@ -1105,6 +1330,7 @@ struct _SDL_AudioStream
     int resampler_padding_samples;
     float *resampler_padding;
     void *resampler_state;
+    float *resampler_phases;
     SDL_ResampleAudioStreamFunc resampler_func;
     SDL_ResetAudioStreamResamplerFunc reset_resampler_func;
     SDL_CleanupAudioStreamResamplerFunc cleanup_resampler_func;
@@ -1234,7 +1460,7 @@ SDL_ResampleAudioStream(SDL_AudioStream *stream, const void *_inbuf, const int i
 
     SDL_assert(inbuf != ((const float *) outbuf));  /* SDL_AudioStreamPut() shouldn't allow in-place resamples. */
 
-    retval = SDL_ResampleAudio(chans, inrate, outrate, lpadding, rpadding, inbuf, inbuflen, outbuf, outbuflen);
+    retval = SDL_ResampleAudio(chans, inrate, outrate, lpadding, rpadding, stream->resampler_phases, inbuf, inbuflen, outbuf, outbuflen);
 
     /* update our left padding with end of current input, for next run. */
     SDL_memcpy((lpadding + paddingsamples) - (cpy / sizeof (float)), inbufend - cpy, cpy);
@@ -1253,6 +1479,7 @@ static void
 SDL_CleanupAudioStreamResampler(SDL_AudioStream *stream)
 {
     SDL_free(stream->resampler_state);
+    SDL_free(stream->resampler_phases);
 }
 
 SDL_AudioStream *
@@ -1343,6 +1570,9 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
                 return NULL;
             }
 
+            /* Without a table, SDL_ResampleAudio computes the weights per frame. */
+            retval->resampler_phases = SDL_BuildResamplerPhases(src_rate, dst_rate);
+
             retval->resampler_func = SDL_ResampleAudioStream;
             retval->reset_resampler_func = SDL_ResetAudioStreamResampler;
             retval->cleanup_resampler_func = SDL_CleanupAudioStreamResampler;
@@ -0,0 +1,522 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+/* A software mixer for any number of voices, see SDL_AudioMixer in SDL_audio.h */
+
+#include "SDL_audio.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_mutex.h"
+#include "SDL_assert.h"
+
+#ifdef __SSE2__
+#define HAVE_SSE2_INTRINSICS 1
+#endif
+
+/* The output is mixed this many frames at a time, so the mixer's buffers
+   can be allocated up front instead of on the audio thread. */
+#define MIXER_CHUNK_FRAMES 1024
+#define MIXER_MAX_CHANNELS 8
+
+typedef struct SDL_AudioVoice
+{
+    SDL_AudioStream *stream;  /* NULL if this slot is free */
+    float gain;
+    float pan;
+    float gains[MIXER_MAX_CHANNELS];  /* gain of each output channel, with pan applied */
+    SDL_bool playing;
+    SDL_bool flushed;
+    Uint64 start;  /* output frame to start playing at */
+} SDL_AudioVoice;
+
+struct _SDL_AudioMixer
+{
+    SDL_mutex *lock;
+    SDL_AudioFormat format;
+    int channels;
+    int freq;
+    int frame_size;  /* of the output format */
+    SDL_AudioCVT cvt;  /* float to the output format, if needed */
+    SDL_AudioVoice *voices;
+    int numvoices;
+    float *mixbuf;
+    float *voicebuf;
+    Uint64 position;
+};
+
+typedef void (*SDL_MixVoiceFunc)(float *dst, const float *src, const int samples, const float *gains, const int chans);
+
+static void
+SDL_MixVoice_Scalar(float *dst, const float *src, const int samples, const float *gains, const int chans)
+{
+    int i, chan;
+
+    for (i = 0; i < samples; i += chans) {
+        for (chan = 0; chan < chans; chan++) {
+            dst[i + chan] += src[i + chan] * gains[chan];
+        }
+    }
+}
+
+#if HAVE_SSE2_INTRINSICS
+/* 4 samples at a time, for channel counts that divide or are divided by 4 */
+static void
+SDL_MixVoice_SSE2(float *dst, const float *src, const int samples, const float *gains, const int chans)
+{
+    __m128 gain1, gain2;
+    int i = 0;
+
+    if (chans == 8) {
+        gain1 = _mm_loadu_ps(gains);
+        gain2 = _mm_loadu_ps(gains + 4);
+    } else {
+        gain1 = _mm_set_ps(gains[3 % chans], gains[2 % chans], gains[1 % chans], gains[0]);
+        gain2 = gain1;
+    }
+
+    for ( ; i + 8 <= samples; i += 8) {
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), gain1)));
+        _mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_mul_ps(_mm_loadu_ps(src + i + 4), gain2)));
+    }
+
+    /* Finish off any leftover mono or stereo frames */
+    for ( ; i < samples; i++) {
+        dst[i] += src[i] * gains[i % chans];
+    }
+}
+
+static void
+SDL_ClampMix_SSE2(float *buf, const int samples)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minusone = _mm_set1_ps(-1.0f);
+    int i = 0;
+
+    for ( ; i + 4 <= samples; i += 4) {
+        _mm_storeu_ps(buf + i, _mm_max_ps(_mm_min_ps(_mm_loadu_ps(buf + i), one), minusone));
+    }
+    for ( ; i < samples; i++) {
+        buf[i] = SDL_max(SDL_min(buf[i], 1.0f), -1.0f);
+    }
+}
+#endif
+
+static void
+SDL_ClampMix_Scalar(float *buf, const int samples)
+{
+    int i;
+
+    for (i = 0; i < samples; i++) {
+        buf[i] = SDL_max(SDL_min(buf[i], 1.0f), -1.0f);
+    }
+}
+
+static SDL_AudioVoice *
+GetVoice(SDL_AudioMixer *mixer, const SDL_AudioVoiceID voice)
+{
+    if (!mixer) {
+        SDL_InvalidParamError("mixer");
+        return NULL;
+    }
+    if (voice == 0 || voice > (SDL_AudioVoiceID) mixer->numvoices || !mixer->voices[voice - 1].stream) {
+        SDL_SetError("Invalid audio voice");
+        return NULL;
+    }
+    return &mixer->voices[voice - 1];
+}
+
+static void
+UpdateVoiceGains(SDL_AudioMixer *mixer, SDL_AudioVoice *v)
+{
+    int chan;
+
+    for (chan = 0; chan < mixer->channels; chan++) {
+        v->gains[chan] = v->gain;
+    }
+    if (mixer->channels >= 2) {
+        v->gains[0] *= SDL_min(1.0f, 1.0f - v->pan);
+        v->gains[1] *= SDL_min(1.0f, 1.0f + v->pan);
+    }
+}
+
+SDL_AudioMixer *
+SDL_NewAudioMixer(const SDL_AudioSpec *spec)
+{
+    SDL_AudioMixer *mixer;
+
+    if (!spec) {
+        SDL_InvalidParamError("spec");
+        return NULL;
+    }
+    if (spec->channels == 0 || spec->channels > MIXER_MAX_CHANNELS) {
+        SDL_SetError("Unsupported number of audio channels.");
+        return NULL;
+    }
+
+    mixer = (SDL_AudioMixer *) SDL_calloc(1, sizeof (*mixer));
+    if (!mixer) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    mixer->format = spec->format;
+    mixer->channels = spec->channels;
+    mixer->freq = spec->freq;
+    mixer->frame_size = (SDL_AUDIO_BITSIZE(spec->format) / 8) * spec->channels;
+
+    if (SDL_BuildAudioCVT(&mixer->cvt, AUDIO_F32SYS, spec->channels, spec->freq, spec->format, spec->channels, spec->freq) < 0) {
+        SDL_FreeAudioMixer(mixer);
+        return NULL;
+    }
+
+    mixer->lock = SDL_CreateMutex();
+    mixer->mixbuf = (float *) SDL_malloc(MIXER_CHUNK_FRAMES * mixer->channels * sizeof (float) * SDL_max(1, mixer->cvt.len_mult));
+    mixer->voicebuf = (float *) SDL_malloc(MIXER_CHUNK_FRAMES * mixer->channels * sizeof (float));
+    if (!mixer->mixbuf || !mixer->voicebuf) {
+        SDL_FreeAudioMixer(mixer);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    return mixer;
+}
+
+SDL_AudioVoiceID
+SDL_AudioMixerNewVoice(SDL_AudioMixer *mixer, const SDL_AudioFormat format, const Uint8 channels, const int rate)
+{
+    SDL_AudioStream *stream;
+    SDL_AudioVoice *v;
+    int i;
+
+    if (!mixer) {
+        SDL_InvalidParamError("mixer");
+        return 0;
+    }
+
+    stream = SDL_NewAudioStream(format, channels, rate, AUDIO_F32SYS, mixer->channels, mixer->freq);
+    if (!stream) {
+        return 0;
+    }
+
+    SDL_LockMutex(mixer->lock);
+    for (i = 0; i < mixer->numvoices; i++) {
+        if (!mixer->voices[i].stream) {
+            break;
+        }
+    }
+    if (i == mixer->numvoices) {
+        v = (SDL_AudioVoice *) SDL_realloc(mixer->voices, (mixer->numvoices + 1) * sizeof (*v));
+        if (!v) {
+            SDL_UnlockMutex(mixer->lock);
+            SDL_FreeAudioStream(stream);
+            SDL_OutOfMemory();
+            return 0;
+        }
+        mixer->voices = v;
+        mixer->numvoices++;
+    }
+
+    v = &mixer->voices[i];
+    SDL_zerop(v);
+    v->stream = stream;
+    v->gain = 1.0f;
+    v->pan = 0.0f;
+    UpdateVoiceGains(mixer, v);
+    SDL_UnlockMutex(mixer->lock);
+
+    return (SDL_AudioVoiceID) (i + 1);
+}
+
+int
+SDL_AudioMixerPutVoice(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice, const void *buf, int len)
+{
+    SDL_AudioVoice *v;
+    int retval;
+
+    if (!mixer) {
+        return SDL_InvalidParamError("mixer");
+    }
+
+    SDL_LockMutex(mixer->lock);
+    v = GetVoice(mixer, voice);
+    if (!v) {
+        retval = -1;
+    } else if (v->flushed) {
+        retval = SDL_SetError("Audio voice was already flushed");
+    } else {
+        retval = SDL_AudioStreamPut(v->stream, buf, len);
+    }
+    SDL_UnlockMutex(mixer->lock);
+    return retval;
+}
+
+int
+SDL_AudioMixerFlushVoice(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice)
+{
+    SDL_AudioVoice *v;
+    int retval;
+
+    if (!mixer) {
+        return SDL_InvalidParamError("mixer");
+    }
+
+    SDL_LockMutex(mixer->lock);
+    v = GetVoice(mixer, voice);
+    if (!v) {
+        retval = -1;
+    } else {
+        retval = SDL_AudioStreamFlush(v->stream);
+        v->flushed = SDL_TRUE;
+    }
+    SDL_UnlockMutex(mixer->lock);
+    return retval;
+}
+
+int
+SDL_AudioMixerSetVoiceGain(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice, float gain)
+{
+    SDL_AudioVoice *v;
+
+    if (!mixer) {
+        return SDL_InvalidParamError("mixer");
+    }
+
+    SDL_LockMutex(mixer->lock);
+    v = GetVoice(mixer, voice);
+    if (v) {
+        v->gain = gain;
+        UpdateVoiceGains(mixer, v);
+    }
+    SDL_UnlockMutex(mixer->lock);
+    return v ? 0 : -1;
+}
+
+int
+SDL_AudioMixerSetVoicePan(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice, float pan)
+{
+    SDL_AudioVoice *v;
+
+    if (!mixer) {
+        return SDL_InvalidParamError("mixer");
+    }
+
+    SDL_LockMutex(mixer->lock);
+    v = GetVoice(mixer, voice);
+    if (v) {
+        v->pan = SDL_max(SDL_min(pan, 1.0f), -1.0f);
+        UpdateVoiceGains(mixer, v);
+    }
+    SDL_UnlockMutex(mixer->lock);
+    return v ? 0 : -1;
+}
+
+int
+SDL_AudioMixerPlayVoice(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice, Uint64 frame)
+{
+    SDL_AudioVoice *v;
+
+    if (!mixer) {
+        return SDL_InvalidParamError("mixer");
+    }
+
+    SDL_LockMutex(mixer->lock);
+    v = GetVoice(mixer, voice);
+    if (v) {
+        v->playing = SDL_TRUE;
+        v->start = frame;
+    }
+    SDL_UnlockMutex(mixer->lock);
+    return v ? 0 : -1;
+}
+
+int
+SDL_AudioMixerStopVoice(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice)
+{
+    SDL_AudioVoice *v;
+
+    if (!mixer) {
+        return SDL_InvalidParamError("mixer");
+    }
+
+    SDL_LockMutex(mixer->lock);
+    v = GetVoice(mixer, voice);
+    if (v) {
+        v->playing = SDL_FALSE;
+    }
+    SDL_UnlockMutex(mixer->lock);
+    return v ? 0 : -1;
+}
+
+SDL_bool
+SDL_AudioMixerVoicePlaying(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice)
+{
+    SDL_AudioVoice *v;
+    SDL_bool retval = SDL_FALSE;
+
+    if (!mixer) {
+        return SDL_FALSE;
+    }
+
+    SDL_LockMutex(mixer->lock);
+    v = GetVoice(mixer, voice);
+    if (v) {
+        retval = v->playing;
+    }
+    SDL_UnlockMutex(mixer->lock);
+    return retval;
+}
+
+void
+SDL_AudioMixerFreeVoice(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice)
+{
+    SDL_AudioVoice *v;
+
+    if (!mixer) {
+        return;
+    }
+
+    SDL_LockMutex(mixer->lock);
+    v = GetVoice(mixer, voice);
+    if (v) {
+        SDL_FreeAudioStream(v->stream);
+        SDL_zerop(v);
+    }
+    SDL_UnlockMutex(mixer->lock);
+}
+
+Uint64
+SDL_AudioMixerPosition(SDL_AudioMixer *mixer)
+{
+    Uint64 retval;
+
+    if (!mixer) {
+        return 0;
+    }
+
+    SDL_LockMutex(mixer->lock);
+    retval = mixer->position;
+    SDL_UnlockMutex(mixer->lock);
+    return retval;
+}
+
+/* Mix the next (frames) output frames into mixer->mixbuf -- called with the mixer locked */
+static void
+SDL_MixAudioMixerChunk(SDL_AudioMixer *mixer, const int frames, const SDL_MixVoiceFunc MixVoice)
+{
+    const int chans = mixer->channels;
+    const int framelen = chans * (int) sizeof (float);
+    int i;
+
+    SDL_memset(mixer->mixbuf, '\0', frames * framelen);
+
+    for (i = 0; i < mixer->numvoices; i++) {
+        SDL_AudioVoice *v = &mixer->voices[i];
+        int offset = 0;
+        int got;
+
+        if (!v->stream || !v->playing) {
+            continue;
+        }
+
+        /* Start scheduled voices on their exact frame */
+        if (v->start > mixer->position) {
+            if (v->start >= mixer->position + frames) {
+                continue;
+            }
+            offset = (int) (v->start - mixer->position);
+        }
+
+        got = SDL_AudioStreamGet(v->stream, mixer->voicebuf, (frames - offset) * framelen);
+        if (got > 0) {
+            MixVoice(mixer->mixbuf + (offset * chans), mixer->voicebuf, got / (int) sizeof (float), v->gains, chans);
+        }
+
+        if (v->flushed && SDL_AudioStreamAvailable(v->stream) == 0) {
+            v->playing = SDL_FALSE;  /* played out */
+        }
+    }
+
+    mixer->position += frames;
+}
+
+void SDLCALL
+SDL_AudioMixerCallback(void *userdata, Uint8 *stream, int len)
+{
+    SDL_AudioMixer *mixer = (SDL_AudioMixer *) userdata;
+    SDL_MixVoiceFunc MixVoice = SDL_MixVoice_Scalar;
+    void (*ClampMix)(float *buf, const int samples) = SDL_ClampMix_Scalar;
+    int frames = len / mixer->frame_size;
+
+#if HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        if (mixer->channels == 1 || mixer->channels == 2 || mixer->channels == 4 || mixer->channels == 8) {
+            MixVoice = SDL_MixVoice_SSE2;
+        }
+        ClampMix = SDL_ClampMix_SSE2;
+    }
+#endif
+
+    while (frames > 0) {
+        const int chunk = SDL_min(frames, MIXER_CHUNK_FRAMES);
+        const int samples = chunk * mixer->channels;
+
+        SDL_LockMutex(mixer->lock);
+        SDL_MixAudioMixerChunk(mixer, chunk, MixVoice);
+        SDL_UnlockMutex(mixer->lock);
+
+        /* Clamp once, while converting to the output format if we need to */
+        if (mixer->cvt.needed) {
+            mixer->cvt.buf = (Uint8 *) mixer->mixbuf;
+            mixer->cvt.len = samples * (int) sizeof (float);
+            SDL_ConvertAudio(&mixer->cvt);
+            SDL_memcpy(stream, mixer->mixbuf, mixer->cvt.len_cvt);
+        } else {
+            ClampMix(mixer->mixbuf, samples);
+            SDL_memcpy(stream, mixer->mixbuf, samples * sizeof (float));
+        }
+
+        stream += chunk * mixer->frame_size;
+        frames -= chunk;
+    }
+}
+
+void
+SDL_FreeAudioMixer(SDL_AudioMixer *mixer)
+{
+    int i;
+
+    if (!mixer) {
+        return;
+    }
+
+    for (i = 0; i < mixer->numvoices; i++) {
+        if (mixer->voices[i].stream) {
+            SDL_FreeAudioStream(mixer->voices[i].stream);
+        }
+    }
+    SDL_free(mixer->voices);
+    SDL_free(mixer->mixbuf);
+    SDL_free(mixer->voicebuf);
+    SDL_DestroyMutex(mixer->lock);
+    SDL_free(mixer);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
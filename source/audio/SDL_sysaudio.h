@@ -72,6 +72,7 @@ typedef struct SDL_AudioDriverImpl
     void (*WaitDevice) (_THIS);
     void (*PlayDevice) (_THIS);
     int (*GetPendingBytes) (_THIS);
+    int (*GetDeviceLatency) (_THIS);  /**< Sample frames between the mixer and the speaker */
     Uint8 *(*GetDeviceBuf) (_THIS);
     int (*CaptureFromDevice) (_THIS, void *buffer, int buflen);
     void (*FlushCapture) (_THIS);
@@ -164,6 +165,19 @@ struct SDL_AudioDevice
     /* Queued buffers (if app not using callback). */
     SDL_DataQueue *buffer_queue;
 
+    /* Lock-free queue used instead of buffer_queue with SDL_HINT_AUDIO_QUEUE_LOCKFREE.
+       The positions count bytes ever written and read, wrapping around. */
+    Uint8 *ring;
+    Uint32 ring_size;           /* a power of two */
+    SDL_atomic_t ring_head;     /* written by SDL_QueueAudio() */
+    SDL_atomic_t ring_tail;     /* written by the audio thread */
+    SDL_atomic_t ring_clear;    /* SDL_ClearQueuedAudio() moves the tail up to here */
+
+    /* SDL_GetQueuedAudioStats() */
+    SDL_atomic_t underruns;
+    SDL_atomic_t overruns;
+    SDL_bool starved;
+
     /* * * */
     /* Data private to this driver */
     struct SDL_PrivateAudioData *hidden;
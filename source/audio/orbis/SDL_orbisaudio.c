@@ -29,99 +29,246 @@
 #include "SDL_audio.h"
 #include "SDL_error.h"
 #include "SDL_timer.h"
+#include "SDL_cpuinfo.h"
 #include "../SDL_audio_c.h"
 #include "../SDL_audiodev_c.h"
 #include "../SDL_sysaudio.h"
 #include "SDL_orbisaudio.h"
 
 #include <kernel.h>
+#include <audioout.h>
 #include <orbisAudio.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define HAVE_SSE2_INTRINSICS 1
+#endif
 
 /* The tag name used by VITA audio */
 #define ORBISAUD_DRIVER_NAME         "orbisaudio"
 
+/* sceAudioOut parameters */
+#define ORBISAUD_USER_ID_SYSTEM      255
+#define ORBISAUD_PORT_TYPE_MAIN      0
+#define ORBISAUD_PARAM_S16_MONO      0
+#define ORBISAUD_PARAM_S16_STEREO    1
+#define ORBISAUD_PARAM_FLOAT_MONO    3
+#define ORBISAUD_PARAM_FLOAT_STEREO  4
+#define ORBISAUD_PARAM_S16_8CH_STD   6  /* FL FR FC LFE BL BR SL SR, as SDL lays out 7.1 */
+#define ORBISAUD_PARAM_FLOAT_8CH_STD 7
+#define ORBISAUD_VOLUME_0DB          32768
+
+/* The hardware takes sample frames in grains of 256, from 256 up to 2048.
+   At its fixed 48 kHz that's 5.3 to 42.7 ms per buffer. */
+#define ORBISAUD_GRAIN               256
+#define ORBISAUD_MIN_SAMPLES         256
+#define ORBISAUD_MAX_SAMPLES         2048
+#define ORBISAUD_FREQ                48000
+
+/* Port parameter for a channel count and sample type */
+static unsigned int
+ORBISAUD_PortParam(int channels, SDL_bool isfloat)
+{
+    switch (channels) {
+        case 1:
+            return isfloat ? ORBISAUD_PARAM_FLOAT_MONO : ORBISAUD_PARAM_S16_MONO;
+        case 2:
+            return isfloat ? ORBISAUD_PARAM_FLOAT_STEREO : ORBISAUD_PARAM_S16_STEREO;
+        default:
+            return isfloat ? ORBISAUD_PARAM_FLOAT_8CH_STD : ORBISAUD_PARAM_S16_8CH_STD;
+    }
+}
+
+/* Open our own port, so the grain is ours to pick rather than liborbis' preset */
+static int
+ORBISAUD_OpenPort(Uint32 samples, int channels, SDL_bool isfloat)
+{
+    return sceAudioOutOpen(ORBISAUD_USER_ID_SYSTEM, ORBISAUD_PORT_TYPE_MAIN, 0,
+                           samples, ORBISAUD_FREQ,
+                           ORBISAUD_PortParam(channels, isfloat));
+}
+
+/* Convert a float buffer to S16 in place, the way SDL_AudioCVT would:
+   clamp to [-1, 1] and scale by 32767. Each write lands behind what's
+   already been read, so the buffer can be shared. */
+static void
+ORBISAUD_ConvertF32toS16_Scalar(void *buf, int samples)
+{
+    const float *src = (const float *) buf;
+    Sint16 *dst = (Sint16 *) buf;
+    int i;
+
+    for (i = 0; i < samples; i++) {
+        const float sample = SDL_max(SDL_min(src[i], 1.0f), -1.0f);
+        dst[i] = (Sint16) (sample * 32767.0f);
+    }
+}
+
+#if HAVE_SSE2_INTRINSICS
+static void
+ORBISAUD_ConvertF32toS16_SSE2(void *buf, int samples)
+{
+    const float *src = (const float *) buf;
+    Sint16 *dst = (Sint16 *) buf;
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minusone = _mm_set1_ps(-1.0f);
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    int i = 0;
+
+    for ( ; i + 8 <= samples; i += 8) {
+        const __m128 a = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i), one), minusone);
+        const __m128 b = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i + 4), one), minusone);
+        const __m128i ia = _mm_cvttps_epi32(_mm_mul_ps(a, scale));
+        const __m128i ib = _mm_cvttps_epi32(_mm_mul_ps(b, scale));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi32(ia, ib));
+    }
+    for ( ; i < samples; i++) {
+        const float sample = SDL_max(SDL_min(src[i], 1.0f), -1.0f);
+        dst[i] = (Sint16) (sample * 32767.0f);
+    }
+}
+#endif
+
 static int
 ORBISAUD_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
 {
     int i;
+    int vols[8];
+    int channels;
+    Uint32 samples;
+    SDL_bool isfloat, convert;
     this->hidden = (struct SDL_PrivateAudioData *)
         SDL_malloc(sizeof(*this->hidden));
     if (this->hidden == NULL) {
         return SDL_OutOfMemory();
     }
     SDL_memset(this->hidden, 0, sizeof(*this->hidden));
-    switch (this->spec.format & 0xff) {
-        case 16:
-            this->spec.format = AUDIO_S16LSB;
+    this->hidden->port = -1;
+
+    /* Honor the requested buffer size, rounded up to what the hardware takes. */
+    samples = ((this->spec.samples + ORBISAUD_GRAIN - 1) / ORBISAUD_GRAIN) * ORBISAUD_GRAIN;
+    samples = SDL_max(samples, ORBISAUD_MIN_SAMPLES);
+    samples = SDL_min(samples, ORBISAUD_MAX_SAMPLES);
+
+    /* The hardware takes S16 or float, in mono, stereo or 7.1; above
+       stereo we try 7.1 and SDL upmixes quad and 5.1 to it. */
+    isfloat = SDL_AUDIO_ISFLOAT(this->spec.format) ? SDL_TRUE : SDL_FALSE;
+    channels = (this->spec.channels <= 2) ? this->spec.channels : 8;
+    convert = SDL_FALSE;
+    for ( ; ; ) {
+        this->hidden->port = ORBISAUD_OpenPort(samples, channels, isfloat);
+        if ((this->hidden->port < 0) && isfloat) {
+            /* No float port; keep taking float and convert it ourselves in
+               PlayDevice, rather than have SDL run it through a stream. */
+            this->hidden->port = ORBISAUD_OpenPort(samples, channels, SDL_FALSE);
+            convert = SDL_TRUE;
+        }
+        if ((this->hidden->port >= 0) || (channels != 8)) {
             break;
-        default:
-            return SDL_SetError("Unsupported audio format");
-    }
-    OrbisAudioConfig *audioConf=orbisAudioGetConf();
-    if(audioConf!=NULL)
-    {
-        if(audioConf->channels[ORBISAUDIO_CHANNEL_MAIN]->orbisaudiochannel_initialized==1)
-        {
-            this->spec.channels = audioConf->channels[ORBISAUDIO_CHANNEL_MAIN]->stereo*2;  
-            this->spec.size = audioConf->channels[ORBISAUDIO_CHANNEL_MAIN]->samples[0]*16*this->spec.channels;
-            this->spec.freq = 48000;
-            this->spec.silence = 0x00;
-            this->hidden->channel=audioConf->channels[ORBISAUDIO_CHANNEL_MAIN]->audioHandle;
-
-            /* Allocate the mixing buffer.  Its size and starting address must
-            be a multiple of ORBISAUDIO_MIN_LEN bytes.  Our sample count is already a multiple of
-            ORBISAUDIO_MIN_LEN, so spec->size should be a multiple of ORBISAUDIO_MIN_LEN as well. */
-            this->hidden->rawbuf = (Uint8 *) SDL_malloc(this->spec.size * NUM_BUFFERS);
-            // this->hidden->rawbuf = (Uint8 *) memalign(ORBISAUDIO_MIN_LEN, mixlen);
-            if (this->hidden->rawbuf == NULL) {
-                return SDL_SetError("Couldn't allocate mixing buffer");
-            }
         }
-        else
-        {
-            free(this->hidden->rawbuf);
-            this->hidden->rawbuf = NULL;
-            return SDL_SetError("Couldn't reserve hardware channel");
+        /* No 7.1 port to be had, SDL downmixes to stereo instead */
+        channels = 2;
+        convert = SDL_FALSE;
+    }
+    if (this->hidden->port < 0) {
+        this->hidden->port = -1;
+        return SDL_SetError("Couldn't reserve hardware channel");
+    }
+    if (convert) {
+        this->hidden->ConvertF32toS16 = ORBISAUD_ConvertF32toS16_Scalar;
+#if HAVE_SSE2_INTRINSICS
+        if (SDL_HasSSE2()) {
+            this->hidden->ConvertF32toS16 = ORBISAUD_ConvertF32toS16_SSE2;
         }
+#endif
+    }
+
+    this->spec.format = isfloat ? AUDIO_F32LSB : AUDIO_S16LSB;
+    this->spec.channels = (Uint8) channels;
+    this->spec.freq = ORBISAUD_FREQ;
+    this->spec.samples = (Uint16) samples;
+    SDL_CalculateAudioSpec(&this->spec);
+
+    for (i = 0; i < SDL_arraysize(vols); i++) {
+        vols[i] = ORBISAUD_VOLUME_0DB;
+    }
+    sceAudioOutSetVolume(this->hidden->port, 0xFF, vols);
+
+    /* One buffer plays while we mix the other. */
+    this->hidden->rawbuf = (Uint8 *) SDL_malloc(this->spec.size * NUM_BUFFERS);
+    if (this->hidden->rawbuf == NULL) {
+        return SDL_SetError("Couldn't allocate mixing buffer");
     }
-    memset(this->hidden->rawbuf, 0, this->spec.size * NUM_BUFFERS);
+    SDL_memset(this->hidden->rawbuf, this->spec.silence, this->spec.size * NUM_BUFFERS);
     for (i = 0; i < NUM_BUFFERS; i++) {
         this->hidden->mixbufs[i] = &this->hidden->rawbuf[i * this->spec.size];
     }
 
     this->hidden->next_buffer = 0;
+    this->hidden->submitted = SDL_FALSE;
     return 0;
 }
 
 static void ORBISAUD_PlayDevice(_THIS)
 {
+    if (this->hidden->ConvertF32toS16) {
+        this->hidden->ConvertF32toS16(this->hidden->mixbufs[this->hidden->next_buffer],
+                                      this->spec.size / sizeof (float));
+    }
 
-    orbisAudioPlayBlock(ORBISAUDIO_CHANNEL_MAIN,ORBISAUDIO_VOLUME_MAX,ORBISAUDIO_VOLUME_MAX,this->hidden->mixbufs[this->hidden->next_buffer]);
+    /* Blocks until the buffer submitted before has finished playing, so
+       this one starts right after it and the port never runs empty. */
+    sceAudioOutOutput(this->hidden->port, this->hidden->mixbufs[this->hidden->next_buffer]);
     this->hidden->next_buffer = (this->hidden->next_buffer + 1) % NUM_BUFFERS;
+    this->hidden->submitted = SDL_TRUE;
 }
 
 /* This function waits until it is possible to write a full sound buffer */
 static void ORBISAUD_WaitDevice(_THIS)
 {
-    /* Because we block when sending audio, there's no need for this function to do anything. */
+    /* Because we block when sending audio, there's no need for this function
+       to do anything.  Waiting here for the port to drain would leave it
+       empty while the next buffer is mixed. */
+}
+
+static int ORBISAUD_GetPendingBytes(_THIS)
+{
+    /* the buffer now playing, as SDL sees it before any conversion */
+    return this->hidden->submitted ? (int) this->spec.size : 0;
+}
+
+static int ORBISAUD_GetDeviceLatency(_THIS)
+{
+    /* A buffer is submitted while the one before it still plays, and
+       PlayDevice() returns once it starts. */
+    return this->spec.samples * 2;
 }
+
 static Uint8 *ORBISAUD_GetDeviceBuf(_THIS)
 {
     return this->hidden->mixbufs[this->hidden->next_buffer];
 }
 
+static void ORBISAUD_PrepareToClose(_THIS)
+{
+    /* let what was queued finish before the port goes away. */
+    if (this->hidden->submitted) {
+        sceAudioOutOutput(this->hidden->port, NULL);
+    }
+}
+
 static void ORBISAUD_CloseDevice(_THIS)
 {
-    if (this->hidden->channel >= 0) {
-        orbisAudioStop();
-        this->hidden->channel = -1;
+    if (this->hidden->port >= 0) {
+        sceAudioOutClose(this->hidden->port);
+        this->hidden->port = -1;
     }
 
     if (this->hidden->rawbuf != NULL) {
-        free(this->hidden->rawbuf);
+        SDL_free(this->hidden->rawbuf);
         this->hidden->rawbuf = NULL;
     }
+    SDL_free(this->hidden);
 }
 static void ORBISAUD_ThreadInit(_THIS)
 {
@@ -144,7 +291,10 @@ ORBISAUD_Init(SDL_AudioDriverImpl * impl)
     impl->OpenDevice = ORBISAUD_OpenDevice;
     impl->PlayDevice = ORBISAUD_PlayDevice;
     impl->WaitDevice = ORBISAUD_WaitDevice;
+    impl->GetPendingBytes = ORBISAUD_GetPendingBytes;
+    impl->GetDeviceLatency = ORBISAUD_GetDeviceLatency;
     impl->GetDeviceBuf = ORBISAUD_GetDeviceBuf;
+    impl->PrepareToClose = ORBISAUD_PrepareToClose;
     impl->CloseDevice = ORBISAUD_CloseDevice;
     impl->ThreadInit = ORBISAUD_ThreadInit;
 
@@ -30,14 +30,18 @@
 #define NUM_BUFFERS 2
 
 struct SDL_PrivateAudioData {
-    /* The hardware output channel. */
-    int     channel;
+    /* The sceAudioOut port. */
+    int     port;
     /* The raw allocated mixing buffer. */
     Uint8   *rawbuf;
     /* Individual mixing buffers. */
     Uint8   *mixbufs[NUM_BUFFERS];
     /* Index of the next available mixing buffer. */
     int     next_buffer;
+    /* Whether the port has a buffer to wait on. */
+    SDL_bool submitted;
+    /* Set when a float device had to fall back to an S16 port. */
+    void (*ConvertF32toS16)(void *buf, int samples);
 };
 
 #endif /* _SDL_orbisaudio_h */
@@ -61,6 +61,10 @@
 #include <sys/syspage.h>
 #endif
 
+#if defined(__ORBIS__)
+#include <kernel.h>
+#endif
+
 #if (defined(__LINUX__) || defined(__ANDROID__)) && defined(__ARM_ARCH)
 /*#include <asm/hwcap.h>*/
 #ifndef AT_HWCAP
@@ -427,6 +431,17 @@ SDL_GetCPUCount(void)
             SDL_CPUCount = info.dwNumberOfProcessors;
         }
 #endif
+#ifdef __ORBIS__
+        if (SDL_CPUCount <= 0) {
+            /* Count the cores the game may run on, there's no sysconf() */
+            SceKernelCpumask mask = 0;
+            if (scePthreadGetaffinity(scePthreadSelf(), &mask) == 0) {
+                for ( ; mask; mask &= mask - 1) {
+                    ++SDL_CPUCount;
+                }
+            }
+        }
+#endif
 #ifdef __OS2__
         if (SDL_CPUCount <= 0) {
             DosQuerySysInfo(QSV_NUMPROCESSORS, QSV_NUMPROCESSORS,
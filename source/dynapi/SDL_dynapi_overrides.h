@@ -670,3 +670,31 @@
 #define SDL_log10 SDL_log10_REAL
 #define SDL_log10f SDL_log10f_REAL
 #define SDL_GameControllerMappingForDeviceIndex SDL_GameControllerMappingForDeviceIndex_REAL
+#define SDL_RenderFlush SDL_RenderFlush_REAL
+#define SDL_RenderGetORBISPixelsTouched SDL_RenderGetORBISPixelsTouched_REAL
+#define SDL_RenderReadPixelsAsync SDL_RenderReadPixelsAsync_REAL
+#define SDL_GetLockContentionStats SDL_GetLockContentionStats_REAL
+#define SDL_ResetLockContentionStats SDL_ResetLockContentionStats_REAL
+#define SDL_GetTicks64 SDL_GetTicks64_REAL
+#define SDL_SetThreadAffinityMask SDL_SetThreadAffinityMask_REAL
+#define SDL_CreateJobGroup SDL_CreateJobGroup_REAL
+#define SDL_DestroyJobGroup SDL_DestroyJobGroup_REAL
+#define SDL_RunJob SDL_RunJob_REAL
+#define SDL_WaitJobGroup SDL_WaitJobGroup_REAL
+#define SDL_GetJobWorkerCount SDL_GetJobWorkerCount_REAL
+#define SDL_GetEventPerformanceCounter SDL_GetEventPerformanceCounter_REAL
+#define SDL_NewAudioMixer SDL_NewAudioMixer_REAL
+#define SDL_AudioMixerNewVoice SDL_AudioMixerNewVoice_REAL
+#define SDL_AudioMixerPutVoice SDL_AudioMixerPutVoice_REAL
+#define SDL_AudioMixerFlushVoice SDL_AudioMixerFlushVoice_REAL
+#define SDL_AudioMixerSetVoiceGain SDL_AudioMixerSetVoiceGain_REAL
+#define SDL_AudioMixerSetVoicePan SDL_AudioMixerSetVoicePan_REAL
+#define SDL_AudioMixerPlayVoice SDL_AudioMixerPlayVoice_REAL
+#define SDL_AudioMixerStopVoice SDL_AudioMixerStopVoice_REAL
+#define SDL_AudioMixerVoicePlaying SDL_AudioMixerVoicePlaying_REAL
+#define SDL_AudioMixerFreeVoice SDL_AudioMixerFreeVoice_REAL
+#define SDL_AudioMixerPosition SDL_AudioMixerPosition_REAL
+#define SDL_AudioMixerCallback SDL_AudioMixerCallback_REAL
+#define SDL_FreeAudioMixer SDL_FreeAudioMixer_REAL
+#define SDL_GetQueuedAudioStats SDL_GetQueuedAudioStats_REAL
+#define SDL_GetAudioDeviceLatency SDL_GetAudioDeviceLatency_REAL
@@ -38,6 +38,9 @@
 /* An arbitrary limit so we don't have unbounded growth */
 #define SDL_MAX_QUEUED_EVENTS   65535
 
+/* Slots in the lock-free ring events are pushed into, must be a power of two */
+#define SDL_EVENT_RING_SIZE     8192
+
 typedef struct SDL_EventWatcher {
     SDL_EventFilter callback;
     void *userdata;
@@ -65,14 +68,38 @@ typedef struct _SDL_EventEntry
     SDL_SysWMmsg msg;
     struct _SDL_EventEntry *prev;
     struct _SDL_EventEntry *next;
+    struct _SDL_EventEntry *type_prev;  /* same bucket */
+    struct _SDL_EventEntry *type_next;
+    Uint32 bucket;  /* SDL_EventBucket() of the type it was added with */
 } SDL_EventEntry;
 
+/* Event types are grouped by their high byte, SDL_KEYDOWN..SDL_KEYMAPCHANGED
+   and so on; each group has its own list through the queue so queries for
+   one group don't walk past the others.  Types 64K or more apart share a
+   bucket, so a range can only use one list if its ends are in the same
+   group. */
+#define SDL_EventBucket(type)   (((type) >> 8) & 0xff)
+#define SDL_EventRangeBucketed(minType, maxType)    (((minType) >> 8) == ((maxType) >> 8))
+
 typedef struct _SDL_SysWMEntry
 {
     SDL_SysWMmsg msg;
     struct _SDL_SysWMEntry *next;
 } SDL_SysWMEntry;
 
+/* A slot in the event ring.  Its sequence number says whose turn it is:
+   equal to the position a producer claims when free, one past it once the
+   event is written, and the position plus the ring size after it is read. */
+typedef struct _SDL_EventSlot
+{
+    SDL_atomic_t sequence;
+    SDL_Event event;
+    SDL_SysWMmsg msg;
+} SDL_EventSlot;
+
+/* Any thread pushes events into the ring without taking the lock.  The
+   reading side holds the lock and moves events from the ring to the end of
+   the list, which is where peeking, filtering and cutting happen. */
 static struct
 {
     SDL_mutex *lock;
@@ -84,7 +111,70 @@ static struct
     SDL_EventEntry *free;
     SDL_SysWMEntry *wmmsg_used;
     SDL_SysWMEntry *wmmsg_free;
-} SDL_EventQ = { NULL, { 1 }, { 0 }, 0, NULL, NULL, NULL, NULL, NULL };
+    SDL_EventEntry *type_head[256];
+    SDL_EventEntry *type_tail[256];
+    SDL_EventSlot *ring;
+    int ring_head;
+    char cache_pad[SDL_CACHELINE_SIZE];
+    SDL_atomic_t ring_tail;
+} SDL_EventQ = { NULL, { 1 }, { 0 }, 0, NULL, NULL, NULL, NULL, NULL, { NULL }, { NULL }, NULL, 0, { 0 }, { 0 } };
+
+/* SDL_HINT_EVENT_COALESCING */
+static SDL_bool SDL_event_coalescing = SDL_FALSE;
+
+/* The performance counter value of an event is kept in the last bytes of
+   SDL_Event, past the end of every event structure except
+   SDL_TextEditingEvent, so the layout of SDL_Event doesn't change. */
+#define SDL_EVENT_COUNTER_OFFSET    (sizeof(SDL_Event) - sizeof(Uint64))
+#define SDL_EventHasCounter(type)   ((type) != SDL_TEXTEDITING)
+
+SDL_COMPILE_TIME_ASSERT(event_counter_window, sizeof(SDL_WindowEvent) <= SDL_EVENT_COUNTER_OFFSET);
+SDL_COMPILE_TIME_ASSERT(event_counter_text, sizeof(SDL_TextInputEvent) <= SDL_EVENT_COUNTER_OFFSET);
+SDL_COMPILE_TIME_ASSERT(event_counter_user, sizeof(SDL_UserEvent) <= SDL_EVENT_COUNTER_OFFSET);
+SDL_COMPILE_TIME_ASSERT(event_counter_tfinger, sizeof(SDL_TouchFingerEvent) <= SDL_EVENT_COUNTER_OFFSET);
+SDL_COMPILE_TIME_ASSERT(event_counter_mgesture, sizeof(SDL_MultiGestureEvent) <= SDL_EVENT_COUNTER_OFFSET);
+SDL_COMPILE_TIME_ASSERT(event_counter_dgesture, sizeof(SDL_DollarGestureEvent) <= SDL_EVENT_COUNTER_OFFSET);
+SDL_COMPILE_TIME_ASSERT(event_counter_drop, sizeof(SDL_DropEvent) <= SDL_EVENT_COUNTER_OFFSET);
+
+/* Set by input drivers with SDL_SetEventSampleTime(), per thread: points
+   to the counter value events pushed from that thread get, if not 0 */
+static SDL_TLSID SDL_event_sample_tls = 0;
+
+static SDL_INLINE void
+SDL_SetEventCounter(SDL_Event * event, Uint64 counter)
+{
+    if (SDL_EventHasCounter(event->type)) {
+        SDL_memcpy(event->padding + SDL_EVENT_COUNTER_OFFSET, &counter, sizeof(counter));
+    }
+}
+
+/* The counter value for an event generated now on this thread */
+static Uint64
+SDL_GetEventStamp(void)
+{
+    const Uint64 *sample = (const Uint64 *) SDL_TLSGet(SDL_event_sample_tls);
+
+    if (sample && *sample) {
+        return *sample;
+    }
+    return SDL_GetPerformanceCounter();
+}
+
+/* Give an event a counter value unless it already has one */
+static void
+SDL_StampEvent(SDL_Event * event)
+{
+    Uint64 counter;
+
+    if (SDL_EventHasCounter(event->type)) {
+        SDL_memcpy(&counter, event->padding + SDL_EVENT_COUNTER_OFFSET, sizeof(counter));
+        if (counter == 0) {
+            SDL_SetEventCounter(event, SDL_GetEventStamp());
+        }
+    }
+}
+
+static SDL_bool SDL_DrainEventRing(void);
 
 
 #ifdef SDL_DEBUG_EVENTS
@@ -311,6 +401,12 @@ SDL_DebugPrintEvent(const SDL_Event *event)
 
 
 
+static void SDLCALL
+SDL_EventCoalescingChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    SDL_event_coalescing = (hint && *hint && SDL_atoi(hint)) ? SDL_TRUE : SDL_FALSE;
+}
+
 /* Public functions */
 
 void
@@ -332,7 +428,9 @@ SDL_StopEventLoop(void)
                 SDL_EventQ.max_events_seen);
     }
 
-    /* Clean out EventQ */
+    /* Clean out EventQ.  The ring itself is kept, other threads may still
+       be pushing into it */
+    SDL_DrainEventRing();
     for (entry = SDL_EventQ.head; entry; ) {
         SDL_EventEntry *next = entry->next;
         SDL_free(entry);
@@ -361,6 +459,10 @@ SDL_StopEventLoop(void)
     SDL_EventQ.free = NULL;
     SDL_EventQ.wmmsg_used = NULL;
     SDL_EventQ.wmmsg_free = NULL;
+    SDL_zero(SDL_EventQ.type_head);
+    SDL_zero(SDL_EventQ.type_tail);
+
+    SDL_DelHintCallback(SDL_HINT_EVENT_COALESCING, SDL_EventCoalescingChanged, NULL);
 
     /* Clear disabled event state */
     for (i = 0; i < SDL_arraysize(SDL_disabled_events); ++i) {
@@ -413,6 +515,26 @@ SDL_StartEventLoop(void)
     }
 #endif /* !SDL_THREADS_DISABLED */
 
+    if (!SDL_EventQ.ring) {
+        int i;
+
+        SDL_EventQ.ring = (SDL_EventSlot *) SDL_malloc(SDL_EVENT_RING_SIZE * sizeof(*SDL_EventQ.ring));
+        if (!SDL_EventQ.ring) {
+            return SDL_OutOfMemory();
+        }
+        for (i = 0; i < SDL_EVENT_RING_SIZE; ++i) {
+            SDL_AtomicSet(&SDL_EventQ.ring[i].sequence, i);
+        }
+        SDL_EventQ.ring_head = 0;
+        SDL_AtomicSet(&SDL_EventQ.ring_tail, 0);
+    }
+
+    if (!SDL_event_sample_tls) {
+        SDL_event_sample_tls = SDL_TLSCreate();
+    }
+
+    SDL_AddHintCallback(SDL_HINT_EVENT_COALESCING, SDL_EventCoalescingChanged, NULL);
+
     /* Process most event types */
     SDL_EventState(SDL_TEXTINPUT, SDL_DISABLE);
     SDL_EventState(SDL_TEXTEDITING, SDL_DISABLE);
@@ -424,36 +546,85 @@ SDL_StartEventLoop(void)
 }
 
 
-/* Add an event to the event queue -- called with the queue locked */
-static int
-SDL_AddEvent(SDL_Event * event)
+/* Fold a motion event into the motion event before it from the same
+   device, keeping the newest position and summing relative motion */
+static SDL_bool
+SDL_CoalesceEvent(SDL_Event * last, const SDL_Event * event)
+{
+    if (last->type != event->type) {
+        return SDL_FALSE;
+    }
+
+    switch (event->type) {
+    case SDL_MOUSEMOTION:
+        if (last->motion.which != event->motion.which ||
+            last->motion.windowID != event->motion.windowID ||
+            last->motion.state != event->motion.state) {
+            return SDL_FALSE;
+        }
+        last->motion.timestamp = event->motion.timestamp;
+        SDL_SetEventCounter(last, SDL_GetEventPerformanceCounter(event));
+        last->motion.x = event->motion.x;
+        last->motion.y = event->motion.y;
+        last->motion.xrel += event->motion.xrel;
+        last->motion.yrel += event->motion.yrel;
+        return SDL_TRUE;
+
+    case SDL_JOYAXISMOTION:
+        if (last->jaxis.which != event->jaxis.which ||
+            last->jaxis.axis != event->jaxis.axis) {
+            return SDL_FALSE;
+        }
+        last->jaxis.timestamp = event->jaxis.timestamp;
+        SDL_SetEventCounter(last, SDL_GetEventPerformanceCounter(event));
+        last->jaxis.value = event->jaxis.value;
+        return SDL_TRUE;
+
+    case SDL_FINGERMOTION:
+        if (last->tfinger.touchId != event->tfinger.touchId ||
+            last->tfinger.fingerId != event->tfinger.fingerId) {
+            return SDL_FALSE;
+        }
+        last->tfinger.timestamp = event->tfinger.timestamp;
+        SDL_SetEventCounter(last, SDL_GetEventPerformanceCounter(event));
+        last->tfinger.x = event->tfinger.x;
+        last->tfinger.y = event->tfinger.y;
+        last->tfinger.dx += event->tfinger.dx;
+        last->tfinger.dy += event->tfinger.dy;
+        last->tfinger.pressure = event->tfinger.pressure;
+        return SDL_TRUE;
+
+    default:
+        return SDL_FALSE;
+    }
+}
+
+/* Add an event to the end of the list -- called with the queue locked */
+static SDL_bool
+SDL_AppendEvent(const SDL_Event * event, const SDL_SysWMmsg * msg)
 {
     SDL_EventEntry *entry;
-    const int initial_count = SDL_AtomicGet(&SDL_EventQ.count);
-    int final_count;
+    const Uint32 bucket = SDL_EventBucket(event->type);
 
-    if (initial_count >= SDL_MAX_QUEUED_EVENTS) {
-        SDL_SetError("Event queue is full (%d events)", initial_count);
-        return 0;
+    if (SDL_event_coalescing && SDL_EventQ.tail &&
+        SDL_CoalesceEvent(&SDL_EventQ.tail->event, event)) {
+        SDL_AtomicAdd(&SDL_EventQ.count, -1);
+        return SDL_TRUE;
     }
 
     if (SDL_EventQ.free == NULL) {
         entry = (SDL_EventEntry *)SDL_malloc(sizeof(*entry));
         if (!entry) {
-            return 0;
+            return SDL_FALSE;
         }
     } else {
         entry = SDL_EventQ.free;
         SDL_EventQ.free = entry->next;
     }
 
-    #ifdef SDL_DEBUG_EVENTS
-    SDL_DebugPrintEvent(event);
-    #endif
-
     entry->event = *event;
     if (event->type == SDL_SYSWMEVENT) {
-        entry->msg = *event->syswm.msg;
+        entry->msg = *msg;
         entry->event.syswm.msg = &entry->msg;
     }
 
@@ -470,11 +641,152 @@ SDL_AddEvent(SDL_Event * event)
         entry->next = NULL;
     }
 
-    final_count = SDL_AtomicAdd(&SDL_EventQ.count, 1) + 1;
+    entry->bucket = bucket;
+    entry->type_prev = SDL_EventQ.type_tail[bucket];
+    entry->type_next = NULL;
+    if (entry->type_prev) {
+        entry->type_prev->type_next = entry;
+    } else {
+        SDL_EventQ.type_head[bucket] = entry;
+    }
+    SDL_EventQ.type_tail[bucket] = entry;
+    return SDL_TRUE;
+}
+
+/* Push an event into the ring, fails if the ring is full */
+static SDL_bool
+SDL_PushEventRing(const SDL_Event * event)
+{
+    SDL_EventSlot *slot;
+    int pos = SDL_AtomicGet(&SDL_EventQ.ring_tail);
+
+    for ( ; ; ) {
+        int diff;
+
+        slot = &SDL_EventQ.ring[pos & (SDL_EVENT_RING_SIZE - 1)];
+        diff = SDL_AtomicGet(&slot->sequence) - pos;
+        if (diff == 0) {
+            if (SDL_AtomicCAS(&SDL_EventQ.ring_tail, pos, pos + 1)) {
+                break;
+            }
+            pos = SDL_AtomicGet(&SDL_EventQ.ring_tail);
+        } else if (diff < 0) {
+            /* The reader hasn't freed this slot yet */
+            return SDL_FALSE;
+        } else {
+            /* Another thread took this position */
+            pos = SDL_AtomicGet(&SDL_EventQ.ring_tail);
+        }
+    }
+
+    slot->event = *event;
+    if (event->type == SDL_SYSWMEVENT) {
+        slot->msg = *event->syswm.msg;
+    }
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&slot->sequence, pos + 1);
+    return SDL_TRUE;
+}
+
+/* Get the oldest published event in the ring -- called with the queue locked */
+static SDL_EventSlot *
+SDL_PeekEventRing(void)
+{
+    SDL_EventSlot *slot;
+
+    if (!SDL_EventQ.ring) {
+        return NULL;
+    }
+    slot = &SDL_EventQ.ring[SDL_EventQ.ring_head & (SDL_EVENT_RING_SIZE - 1)];
+    if (SDL_AtomicGet(&slot->sequence) != SDL_EventQ.ring_head + 1) {
+        return NULL;
+    }
+    SDL_MemoryBarrierAcquire();
+    return slot;
+}
+
+/* Hand the slot returned by SDL_PeekEventRing() back to the producers */
+static void
+SDL_ReleaseEventRing(SDL_EventSlot *slot)
+{
+    SDL_AtomicSet(&slot->sequence, SDL_EventQ.ring_head + SDL_EVENT_RING_SIZE);
+    ++SDL_EventQ.ring_head;
+}
+
+/* Move everything in the ring to the list -- called with the queue locked */
+static SDL_bool
+SDL_DrainEventRing(void)
+{
+    SDL_EventSlot *slot;
+    SDL_bool moved = SDL_FALSE;
+
+    while ((slot = SDL_PeekEventRing()) != NULL) {
+        if (!SDL_AppendEvent(&slot->event, &slot->msg)) {
+            /* Out of memory, the event is lost */
+            SDL_AtomicAdd(&SDL_EventQ.count, -1);
+        }
+        SDL_ReleaseEventRing(slot);
+        moved = SDL_TRUE;
+    }
+    return moved;
+}
+
+/* Add an event to the event queue -- safe to call without the queue locked */
+static int
+SDL_AddEvent(SDL_Event * event)
+{
+    /* Count the event before it can be seen, a reader may take it out of
+       the ring as soon as it is published */
+    const int final_count = SDL_AtomicAdd(&SDL_EventQ.count, 1) + 1;
+    SDL_bool added;
+
+    if (final_count > SDL_MAX_QUEUED_EVENTS) {
+        SDL_AtomicAdd(&SDL_EventQ.count, -1);
+        SDL_SetError("Event queue is full (%d events)", final_count - 1);
+        return 0;
+    }
     if (final_count > SDL_EventQ.max_events_seen) {
         SDL_EventQ.max_events_seen = final_count;
     }
 
+    /* Events from SDL_PushEvent() are stamped already, ones added with
+       SDL_PeepEvents() are stamped here */
+    SDL_StampEvent(event);
+
+    #ifdef SDL_DEBUG_EVENTS
+    SDL_DebugPrintEvent(event);
+    #endif
+
+    while (!SDL_EventQ.ring || !SDL_PushEventRing(event)) {
+        /* The ring is full, make room under the lock */
+        if (SDL_EventQ.lock && SDL_LockMutex(SDL_EventQ.lock) < 0) {
+            SDL_AtomicAdd(&SDL_EventQ.count, -1);
+            return 0;
+        }
+        if (!SDL_EventQ.ring) {
+            added = SDL_AppendEvent(event, event->syswm.msg);
+            if (SDL_EventQ.lock) {
+                SDL_UnlockMutex(SDL_EventQ.lock);
+            }
+            if (!added) {
+                SDL_AtomicAdd(&SDL_EventQ.count, -1);
+                return 0;
+            }
+            break;
+        }
+        added = SDL_DrainEventRing();
+        if (SDL_EventQ.lock) {
+            SDL_UnlockMutex(SDL_EventQ.lock);
+        }
+        if (!added) {
+            /* The oldest slot was claimed by another thread that hasn't
+               written it yet.  Events of ours may be queued behind it, so
+               wait for it rather than add this one to the list ahead of
+               them. */
+            SDL_Delay(0);
+        }
+    }
+
     return 1;
 }
 
@@ -498,18 +810,35 @@ SDL_CutEvent(SDL_EventEntry *entry)
         SDL_EventQ.tail = entry->prev;
     }
 
+    if (entry->type_prev) {
+        entry->type_prev->type_next = entry->type_next;
+    } else {
+        SDL_EventQ.type_head[entry->bucket] = entry->type_next;
+    }
+    if (entry->type_next) {
+        entry->type_next->type_prev = entry->type_prev;
+    } else {
+        SDL_EventQ.type_tail[entry->bucket] = entry->type_prev;
+    }
+
     entry->next = SDL_EventQ.free;
     SDL_EventQ.free = entry;
     SDL_assert(SDL_AtomicGet(&SDL_EventQ.count) > 0);
     SDL_AtomicAdd(&SDL_EventQ.count, -1);
 }
 
-/* Lock the event queue, take a peep at it, and unlock it */
+/* Lock the event queue, take a peep at it, and unlock it.
+   Adding events doesn't need the lock. */
 int
 SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
                Uint32 minType, Uint32 maxType)
 {
     int i, used;
+    SDL_EventEntry *entry, *next;
+    SDL_SysWMEntry *wmmsg, *wmmsg_next;
+    SDL_EventSlot *slot;
+    SDL_bool bucketed;
+    Uint32 type;
 
     /* Don't look after we've quit */
     if (!SDL_AtomicGet(&SDL_EventQ.active)) {
@@ -519,59 +848,76 @@ SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
         }
         return (-1);
     }
-    /* Lock the event queue */
     used = 0;
+    if (action == SDL_ADDEVENT) {
+        for (i = 0; i < numevents; ++i) {
+            used += SDL_AddEvent(&events[i]);
+        }
+        return (used);
+    }
+
+    /* Lock the event queue */
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
-        if (action == SDL_ADDEVENT) {
-            for (i = 0; i < numevents; ++i) {
-                used += SDL_AddEvent(&events[i]);
+        if (action == SDL_GETEVENT) {
+            /* Clean out any used wmmsg data
+               FIXME: Do we want to retain the data for some period of time?
+             */
+            for (wmmsg = SDL_EventQ.wmmsg_used; wmmsg; wmmsg = wmmsg_next) {
+                wmmsg_next = wmmsg->next;
+                wmmsg->next = SDL_EventQ.wmmsg_free;
+                SDL_EventQ.wmmsg_free = wmmsg;
             }
-        } else {
-            SDL_EventEntry *entry, *next;
-            SDL_SysWMEntry *wmmsg, *wmmsg_next;
-            Uint32 type;
-
-            if (action == SDL_GETEVENT) {
-                /* Clean out any used wmmsg data
-                   FIXME: Do we want to retain the data for some period of time?
-                 */
-                for (wmmsg = SDL_EventQ.wmmsg_used; wmmsg; wmmsg = wmmsg_next) {
-                    wmmsg_next = wmmsg->next;
-                    wmmsg->next = SDL_EventQ.wmmsg_free;
-                    SDL_EventQ.wmmsg_free = wmmsg;
+            SDL_EventQ.wmmsg_used = NULL;
+
+            /* With nothing older in the list, take events straight
+               out of the ring.  When coalescing, motion events go through
+               the list to be merged. */
+            while (!SDL_EventQ.head && events && used < numevents &&
+                   !SDL_event_coalescing && (slot = SDL_PeekEventRing()) != NULL) {
+                type = slot->event.type;
+                if (minType <= type && type <= maxType && type != SDL_SYSWMEVENT) {
+                    events[used++] = slot->event;
+                    SDL_AtomicAdd(&SDL_EventQ.count, -1);
+                } else if (!SDL_AppendEvent(&slot->event, &slot->msg)) {
+                    SDL_AtomicAdd(&SDL_EventQ.count, -1);
                 }
-                SDL_EventQ.wmmsg_used = NULL;
+                SDL_ReleaseEventRing(slot);
             }
+        }
+        if (!events || used < numevents) {
+            SDL_DrainEventRing();
+        }
 
-            for (entry = SDL_EventQ.head; entry && (!events || used < numevents); entry = next) {
-                next = entry->next;
-                type = entry->event.type;
-                if (minType <= type && type <= maxType) {
-                    if (events) {
-                        events[used] = entry->event;
-                        if (entry->event.type == SDL_SYSWMEVENT) {
-                            /* We need to copy the wmmsg somewhere safe.
-                               For now we'll guarantee it's valid at least until
-                               the next call to SDL_PeepEvents()
-                             */
-                            if (SDL_EventQ.wmmsg_free) {
-                                wmmsg = SDL_EventQ.wmmsg_free;
-                                SDL_EventQ.wmmsg_free = wmmsg->next;
-                            } else {
-                                wmmsg = (SDL_SysWMEntry *)SDL_malloc(sizeof(*wmmsg));
-                            }
-                            wmmsg->msg = *entry->event.syswm.msg;
-                            wmmsg->next = SDL_EventQ.wmmsg_used;
-                            SDL_EventQ.wmmsg_used = wmmsg;
-                            events[used].syswm.msg = &wmmsg->msg;
+        bucketed = SDL_EventRangeBucketed(minType, maxType) ? SDL_TRUE : SDL_FALSE;
+        entry = bucketed ? SDL_EventQ.type_head[SDL_EventBucket(minType)] : SDL_EventQ.head;
+        for ( ; entry && (!events || used < numevents); entry = next) {
+            next = bucketed ? entry->type_next : entry->next;
+            type = entry->event.type;
+            if (minType <= type && type <= maxType) {
+                if (events) {
+                    events[used] = entry->event;
+                    if (entry->event.type == SDL_SYSWMEVENT) {
+                        /* We need to copy the wmmsg somewhere safe.
+                           For now we'll guarantee it's valid at least until
+                           the next call to SDL_PeepEvents()
+                         */
+                        if (SDL_EventQ.wmmsg_free) {
+                            wmmsg = SDL_EventQ.wmmsg_free;
+                            SDL_EventQ.wmmsg_free = wmmsg->next;
+                        } else {
+                            wmmsg = (SDL_SysWMEntry *)SDL_malloc(sizeof(*wmmsg));
                         }
+                        wmmsg->msg = *entry->event.syswm.msg;
+                        wmmsg->next = SDL_EventQ.wmmsg_used;
+                        SDL_EventQ.wmmsg_used = wmmsg;
+                        events[used].syswm.msg = &wmmsg->msg;
+                    }
 
-                        if (action == SDL_GETEVENT) {
-                            SDL_CutEvent(entry);
-                        }
+                    if (action == SDL_GETEVENT) {
+                        SDL_CutEvent(entry);
                     }
-                    ++used;
                 }
+                ++used;
             }
         }
         if (SDL_EventQ.lock) {
@@ -620,9 +966,13 @@ SDL_FlushEvents(Uint32 minType, Uint32 maxType)
     /* Lock the event queue */
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         SDL_EventEntry *entry, *next;
+        SDL_bool bucketed = SDL_EventRangeBucketed(minType, maxType) ? SDL_TRUE : SDL_FALSE;
         Uint32 type;
-        for (entry = SDL_EventQ.head; entry; entry = next) {
-            next = entry->next;
+
+        SDL_DrainEventRing();
+        entry = bucketed ? SDL_EventQ.type_head[SDL_EventBucket(minType)] : SDL_EventQ.head;
+        for ( ; entry; entry = next) {
+            next = bucketed ? entry->type_next : entry->next;
             type = entry->event.type;
             if (minType <= type && type <= maxType) {
                 SDL_CutEvent(entry);
@@ -704,6 +1054,7 @@ int
 SDL_PushEvent(SDL_Event * event)
 {
     event->common.timestamp = SDL_GetTicks();
+    SDL_SetEventCounter(event, SDL_GetEventStamp());
 
     if (SDL_EventOK.callback || SDL_event_watchers_count > 0) {
         if (!SDL_event_watchers_lock || SDL_LockMutex(SDL_event_watchers_lock) == 0) {
@@ -817,6 +1168,41 @@ SDL_AddEventWatch(SDL_EventFilter filter, void *userdata)
     }
 }
 
+Uint64
+SDL_GetEventPerformanceCounter(const SDL_Event * event)
+{
+    Uint64 counter;
+
+    if (!SDL_EventHasCounter(event->type)) {
+        /* Counter values don't start with the ticks, go back from now */
+        const Uint32 age = SDL_GetTicks() - event->common.timestamp;
+        return SDL_GetPerformanceCounter() - ((Uint64)age * SDL_GetPerformanceFrequency()) / 1000;
+    }
+    SDL_memcpy(&counter, event->padding + SDL_EVENT_COUNTER_OFFSET, sizeof(counter));
+    return counter;
+}
+
+void
+SDL_SetEventSampleTime(Uint64 counter)
+{
+    Uint64 *sample = (Uint64 *) SDL_TLSGet(SDL_event_sample_tls);
+
+    if (!sample) {
+        if (!counter || !SDL_event_sample_tls) {
+            return;
+        }
+        sample = (Uint64 *) SDL_malloc(sizeof(*sample));
+        if (!sample) {
+            return;
+        }
+        if (SDL_TLSSet(SDL_event_sample_tls, sample, SDL_free) < 0) {
+            SDL_free(sample);
+            return;
+        }
+    }
+    *sample = counter;
+}
+
 void
 SDL_DelEventWatch(SDL_EventFilter filter, void *userdata)
 {
@@ -849,6 +1235,8 @@ SDL_FilterEvents(SDL_EventFilter filter, void *userdata)
 {
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         SDL_EventEntry *entry, *next;
+
+        SDL_DrainEventRing();
         for (entry = SDL_EventQ.head; entry; entry = next) {
             next = entry->next;
             if (!filter(userdata, &entry->event)) {
@@ -46,4 +46,9 @@ extern void SDL_QuitQuit(void);
 
 extern void SDL_SendPendingQuit(void);
 
+/* Make events pushed from the calling thread carry the given performance
+   counter value instead of the time they are pushed; 0 turns that off.
+   Input drivers call this around delivering the state read in one poll. */
+extern void SDL_SetEventSampleTime(Uint64 counter);
+
 /* vi: set ts=4 sw=4 expandtab: */
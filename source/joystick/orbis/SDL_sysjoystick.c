@@ -35,6 +35,7 @@
 #include "SDL_thread.h"
 #include "SDL_mutex.h"
 #include "SDL_timer.h"
+#include "../../events/SDL_events_c.h"
 
 /* Current pad state */ 
 static int SDL_numjoysticks = 1;
@@ -193,6 +194,7 @@ void SDL_SYS_JoystickUpdate(SDL_Joystick *joystick)
 {
 	int i;
     orbisPadUpdate();
+    SDL_SetEventSampleTime(SDL_GetPerformanceCounter());
     //if(orbisPadGetCurrentButtonsPressed() || orbisPadGetCurrentButtonsReleased())
     //{
         for(i=0; i<sizeof(button_map)/sizeof(button_map[0]); i++) {
@@ -212,6 +214,7 @@ void SDL_SYS_JoystickUpdate(SDL_Joystick *joystick)
 			}
 		}
 		//}
+    SDL_SetEventSampleTime(0);
 }
 
 /* Function to close a joystick after use */
@@ -113,6 +113,358 @@ static char texture_magic;
 
 static int UpdateLogicalSize(SDL_Renderer *renderer);
 
+static int
+FlushRenderCommands(SDL_Renderer *renderer)
+{
+    int retval;
+
+    SDL_assert((renderer->render_commands == NULL) == (renderer->render_commands_tail == NULL));
+
+    if (renderer->render_commands == NULL) {  /* nothing to do! */
+        SDL_assert(renderer->vertex_data_used == 0);
+        return 0;
+    }
+
+    retval = renderer->RunCommandQueue(renderer, renderer->render_commands, renderer->vertex_data, renderer->vertex_data_used);
+
+    /* Move the whole render command queue to the unused pool so we can reuse them next time. */
+    renderer->render_commands_tail->next = renderer->render_commands_pool;
+    renderer->render_commands_pool = renderer->render_commands;
+    renderer->render_commands_tail = NULL;
+    renderer->render_commands = NULL;
+    renderer->vertex_data_used = 0;
+    renderer->render_command_generation++;
+    return retval;
+}
+
+static int
+FlushRenderCommandsIfTextureNeeded(SDL_Texture *texture)
+{
+    SDL_Renderer *renderer = texture->renderer;
+    if (texture->last_command_generation == renderer->render_command_generation) {
+        /* the current command queue depends on this texture, flush the queue now before it changes */
+        return FlushRenderCommands(renderer);
+    }
+    return 0;
+}
+
+static SDL_INLINE int
+FlushRenderCommandsIfNotBatching(SDL_Renderer *renderer)
+{
+    return renderer->batching ? 0 : FlushRenderCommands(renderer);
+}
+
+static void
+DiscardRenderCommands(SDL_Renderer *renderer)
+{
+    if (renderer->render_commands_tail != NULL) {
+        renderer->render_commands_tail->next = renderer->render_commands_pool;
+        renderer->render_commands_pool = renderer->render_commands;
+        renderer->render_commands_tail = NULL;
+        renderer->render_commands = NULL;
+    }
+    renderer->vertex_data_used = 0;
+}
+
+/* Reserve 'numbytes' of vertex data at the end of the queue's arena.
+   Allocations are 8-byte aligned so every vertex type can live there. */
+static void *
+AllocateRenderVertices(SDL_Renderer *renderer, const size_t numbytes, size_t *offset)
+{
+    const size_t aligned = (renderer->vertex_data_used + 7) & ~((size_t) 7);
+    const size_t needed = aligned + numbytes;
+    void *ptr;
+
+    if (needed > renderer->vertex_data_allocation) {
+        size_t newsize = renderer->vertex_data_allocation * 2;
+        if (newsize == 0) {
+            newsize = 4096;
+        }
+        while (newsize < needed) {
+            newsize *= 2;
+        }
+        ptr = SDL_realloc(renderer->vertex_data, newsize);
+        if (ptr == NULL) {
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        renderer->vertex_data = ptr;
+        renderer->vertex_data_allocation = newsize;
+    }
+
+    if (offset) {
+        *offset = aligned;
+    }
+
+    renderer->vertex_data_used = needed;
+    return ((Uint8 *) renderer->vertex_data) + aligned;
+}
+
+static SDL_RenderCommand *
+AllocateRenderCommand(SDL_Renderer *renderer)
+{
+    SDL_RenderCommand *retval = NULL;
+
+    /* !!! FIXME: are there threading limitations in SDL's render API? If not, we need to mutex this. */
+    retval = renderer->render_commands_pool;
+    if (retval != NULL) {
+        renderer->render_commands_pool = retval->next;
+        retval->next = NULL;
+    } else {
+        retval = SDL_calloc(1, sizeof (*retval));
+        if (!retval) {
+            SDL_OutOfMemory();
+            return NULL;
+        }
+    }
+
+    SDL_assert((renderer->render_commands == NULL) == (renderer->render_commands_tail == NULL));
+    if (renderer->render_commands_tail != NULL) {
+        renderer->render_commands_tail->next = retval;
+    } else {
+        renderer->render_commands = retval;
+    }
+    renderer->render_commands_tail = retval;
+
+    return retval;
+}
+
+static int
+QueueCmdSetViewport(SDL_Renderer *renderer)
+{
+    if (!renderer->RunCommandQueue) {
+        return renderer->UpdateViewport(renderer);
+    }
+    /* picked up by the next queued draw */
+    renderer->viewport_queued = SDL_FALSE;
+    return 0;
+}
+
+static int
+QueueCmdSetClipRect(SDL_Renderer *renderer)
+{
+    if (!renderer->RunCommandQueue) {
+        return renderer->UpdateClipRect ? renderer->UpdateClipRect(renderer) : 0;
+    }
+    /* picked up by the next queued draw */
+    renderer->cliprect_queued = SDL_FALSE;
+    return 0;
+}
+
+static int
+PrepQueueCmdState(SDL_Renderer *renderer)
+{
+    SDL_RenderCommand *cmd;
+
+    if (!renderer->viewport_queued) {
+        cmd = AllocateRenderCommand(renderer);
+        if (cmd == NULL) {
+            return -1;
+        }
+        cmd->command = SDL_RENDERCMD_SETVIEWPORT;
+        cmd->data.viewport.rect = renderer->viewport;
+        renderer->viewport_queued = SDL_TRUE;
+    }
+
+    if (!renderer->cliprect_queued) {
+        cmd = AllocateRenderCommand(renderer);
+        if (cmd == NULL) {
+            return -1;
+        }
+        cmd->command = SDL_RENDERCMD_SETCLIPRECT;
+        cmd->data.cliprect.enabled = renderer->clipping_enabled;
+        cmd->data.cliprect.rect = renderer->clip_rect;
+        renderer->cliprect_queued = SDL_TRUE;
+    }
+    return 0;
+}
+
+/* Append 'count' elements of 'vertsize' bytes to the queue. If the last
+   queued command is the same kind of draw with the same color, blend mode
+   and texture, it is extended instead of starting a new command, so runs
+   of same-state draws reach the driver as a single batch. */
+static void *
+PrepQueueCmdDraw(SDL_Renderer *renderer, const SDL_RenderCommandType cmdtype,
+                 SDL_Texture *texture, const size_t vertsize, const int count)
+{
+    SDL_RenderCommand *cmd;
+    Uint8 r, g, b, a;
+    SDL_BlendMode blend;
+    size_t first;
+    void *verts;
+
+    if (PrepQueueCmdState(renderer) < 0) {
+        return NULL;
+    }
+
+    if (texture) {
+        r = texture->r;
+        g = texture->g;
+        b = texture->b;
+        a = texture->a;
+        blend = texture->blendMode;
+        texture->last_command_generation = renderer->render_command_generation;
+    } else {
+        r = renderer->r;
+        g = renderer->g;
+        b = renderer->b;
+        a = renderer->a;
+        blend = renderer->blendMode;
+    }
+
+    verts = AllocateRenderVertices(renderer, vertsize * count, &first);
+    if (verts == NULL) {
+        return NULL;
+    }
+
+    cmd = renderer->render_commands_tail;
+    if (cmd && cmd->command == cmdtype &&
+        cmd->data.draw.texture == texture &&
+        cmd->data.draw.blend == blend &&
+        cmd->data.draw.r == r && cmd->data.draw.g == g &&
+        cmd->data.draw.b == b && cmd->data.draw.a == a &&
+        (cmd->data.draw.first + cmd->data.draw.count * vertsize) == first) {
+        cmd->data.draw.count += count;
+        return verts;
+    }
+
+    cmd = AllocateRenderCommand(renderer);
+    if (cmd == NULL) {
+        return NULL;
+    }
+    cmd->command = cmdtype;
+    cmd->data.draw.first = first;
+    cmd->data.draw.count = count;
+    cmd->data.draw.r = r;
+    cmd->data.draw.g = g;
+    cmd->data.draw.b = b;
+    cmd->data.draw.a = a;
+    cmd->data.draw.blend = blend;
+    cmd->data.draw.texture = texture;
+    return verts;
+}
+
+static int
+QueueCmdClear(SDL_Renderer *renderer)
+{
+    SDL_RenderCommand *cmd;
+
+    if (!renderer->RunCommandQueue) {
+        return renderer->RenderClear(renderer);
+    }
+
+    if (PrepQueueCmdState(renderer) < 0) {
+        return -1;
+    }
+    cmd = AllocateRenderCommand(renderer);
+    if (cmd == NULL) {
+        return -1;
+    }
+    cmd->command = SDL_RENDERCMD_CLEAR;
+    cmd->data.color.r = renderer->r;
+    cmd->data.color.g = renderer->g;
+    cmd->data.color.b = renderer->b;
+    cmd->data.color.a = renderer->a;
+    return FlushRenderCommandsIfNotBatching(renderer);
+}
+
+static int
+QueueCmdDrawPoints(SDL_Renderer *renderer, const SDL_FPoint *points, const int count)
+{
+    SDL_FPoint *verts;
+
+    if (!renderer->RunCommandQueue) {
+        return renderer->RenderDrawPoints(renderer, points, count);
+    }
+
+    verts = (SDL_FPoint *) PrepQueueCmdDraw(renderer, SDL_RENDERCMD_DRAW_POINTS, NULL, sizeof (SDL_FPoint), count);
+    if (verts == NULL) {
+        return -1;
+    }
+    SDL_memcpy(verts, points, count * sizeof (SDL_FPoint));
+    return FlushRenderCommandsIfNotBatching(renderer);
+}
+
+static int
+QueueCmdDrawLines(SDL_Renderer *renderer, const SDL_FPoint *points, const int count)
+{
+    SDL_FPoint *verts;
+    int i;
+
+    if (!renderer->RunCommandQueue) {
+        return renderer->RenderDrawLines(renderer, points, count);
+    }
+
+    /* Store the strip as independent segments so consecutive strips merge */
+    verts = (SDL_FPoint *) PrepQueueCmdDraw(renderer, SDL_RENDERCMD_DRAW_LINES, NULL, 2 * sizeof (SDL_FPoint), count - 1);
+    if (verts == NULL) {
+        return -1;
+    }
+    for (i = 0; i < count - 1; ++i) {
+        *(verts++) = points[i];
+        *(verts++) = points[i + 1];
+    }
+    return FlushRenderCommandsIfNotBatching(renderer);
+}
+
+static int
+QueueCmdFillRects(SDL_Renderer *renderer, const SDL_FRect *rects, const int count)
+{
+    SDL_FRect *verts;
+
+    if (!renderer->RunCommandQueue) {
+        return renderer->RenderFillRects(renderer, rects, count);
+    }
+
+    verts = (SDL_FRect *) PrepQueueCmdDraw(renderer, SDL_RENDERCMD_FILL_RECTS, NULL, sizeof (SDL_FRect), count);
+    if (verts == NULL) {
+        return -1;
+    }
+    SDL_memcpy(verts, rects, count * sizeof (SDL_FRect));
+    return FlushRenderCommandsIfNotBatching(renderer);
+}
+
+static int
+QueueCmdCopy(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_FRect *dstrect)
+{
+    SDL_RenderCopyData *verts;
+
+    if (!renderer->RunCommandQueue) {
+        return renderer->RenderCopy(renderer, texture, srcrect, dstrect);
+    }
+
+    verts = (SDL_RenderCopyData *) PrepQueueCmdDraw(renderer, SDL_RENDERCMD_COPY, texture, sizeof (SDL_RenderCopyData), 1);
+    if (verts == NULL) {
+        return -1;
+    }
+    verts->srcrect = *srcrect;
+    verts->dstrect = *dstrect;
+    return FlushRenderCommandsIfNotBatching(renderer);
+}
+
+static int
+QueueCmdCopyEx(SDL_Renderer *renderer, SDL_Texture *texture,
+               const SDL_Rect *srcrect, const SDL_FRect *dstrect,
+               const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip)
+{
+    SDL_RenderCopyExData *verts;
+
+    if (!renderer->RunCommandQueue) {
+        return renderer->RenderCopyEx(renderer, texture, srcrect, dstrect, angle, center, flip);
+    }
+
+    verts = (SDL_RenderCopyExData *) PrepQueueCmdDraw(renderer, SDL_RENDERCMD_COPY_EX, texture, sizeof (SDL_RenderCopyExData), 1);
+    if (verts == NULL) {
+        return -1;
+    }
+    verts->srcrect = *srcrect;
+    verts->dstrect = *dstrect;
+    verts->angle = angle;
+    verts->center = *center;
+    verts->flip = flip;
+    return FlushRenderCommandsIfNotBatching(renderer);
+}
+
 int
 SDL_GetNumRenderDrivers(void)
 {
@@ -179,7 +531,7 @@ SDL_RendererEventWatch(void *userdata, SDL_Event *event)
                         renderer->viewport.y = 0;
                         renderer->viewport.w = w;
                         renderer->viewport.h = h;
-                        renderer->UpdateViewport(renderer);
+                        QueueCmdSetViewport(renderer);
                     }
                 }
 
@@ -356,6 +708,11 @@ SDL_CreateRenderer(SDL_Window * window, int index, Uint32 flags)
         renderer->dpi_scale.x = 1.0f;
         renderer->dpi_scale.y = 1.0f;
 
+        /* Batch draw calls on drivers that can run a command queue */
+        renderer->render_command_generation = 1;
+        renderer->batching = renderer->RunCommandQueue &&
+                             SDL_GetHintBoolean(SDL_HINT_RENDER_BATCHING, SDL_TRUE);
+
         if (window && renderer->GetOutputSize) {
             int window_w, window_h;
             int output_w, output_h;
@@ -924,7 +1281,13 @@ SDL_UpdateTexture(SDL_Texture * texture, const SDL_Rect * rect,
 
     if ((rect->w == 0) || (rect->h == 0)) {
         return 0;  /* nothing to do. */
-    } else if (texture->yuv) {
+    }
+
+    if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
+        return -1;
+    }
+
+    if (texture->yuv) {
         return SDL_UpdateTextureYUV(texture, rect, pixels, pitch);
     } else if (texture->native) {
         return SDL_UpdateTextureNative(texture, rect, pixels, pitch);
@@ -1032,6 +1395,10 @@ int SDL_UpdateYUVTexture(SDL_Texture * texture, const SDL_Rect * rect,
         return 0;  /* nothing to do. */
     }
 
+    if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
+        return -1;
+    }
+
     if (texture->yuv) {
         return SDL_UpdateTextureYUVPlanar(texture, rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch);
     } else {
@@ -1086,6 +1453,10 @@ SDL_LockTexture(SDL_Texture * texture, const SDL_Rect * rect,
         rect = &full_rect;
     }
 
+    if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
+        return -1;
+    }
+
     if (texture->yuv) {
         return SDL_LockTextureYUV(texture, rect, pixels, pitch);
     } else if (texture->native) {
@@ -1193,6 +1564,11 @@ SDL_SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
         }
     }
 
+    /* Everything queued so far was meant for the previous target */
+    if (renderer->RunCommandQueue && FlushRenderCommands(renderer) < 0) {
+        return -1;
+    }
+
     if (texture && !renderer->target) {
         /* Make a backup of the viewport */
         renderer->viewport_backup = renderer->viewport;
@@ -1227,10 +1603,10 @@ SDL_SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
         renderer->logical_w = renderer->logical_w_backup;
         renderer->logical_h = renderer->logical_h_backup;
     }
-    if (renderer->UpdateViewport(renderer) < 0) {
+    if (QueueCmdSetViewport(renderer) < 0) {
         return -1;
     }
-    if (renderer->UpdateClipRect(renderer) < 0) {
+    if (QueueCmdSetClipRect(renderer) < 0) {
         return -1;
     }
 
@@ -1417,7 +1793,7 @@ SDL_RenderSetViewport(SDL_Renderer * renderer, const SDL_Rect * rect)
             return -1;
         }
     }
-    return renderer->UpdateViewport(renderer);
+    return QueueCmdSetViewport(renderer);
 }
 
 void
@@ -1448,7 +1824,7 @@ SDL_RenderSetClipRect(SDL_Renderer * renderer, const SDL_Rect * rect)
         renderer->clipping_enabled = SDL_FALSE;
         SDL_zero(renderer->clip_rect);
     }
-    return renderer->UpdateClipRect(renderer);
+    return QueueCmdSetClipRect(renderer);
 }
 
 void
@@ -1558,7 +1934,7 @@ SDL_RenderClear(SDL_Renderer * renderer)
     if (renderer->hidden) {
         return 0;
     }
-    return renderer->RenderClear(renderer);
+    return QueueCmdClear(renderer);
 }
 
 int
@@ -1590,7 +1966,7 @@ RenderDrawPointsWithRects(SDL_Renderer * renderer,
         frects[i].h = renderer->scale.y;
     }
 
-    status = renderer->RenderFillRects(renderer, frects, count);
+    status = QueueCmdFillRects(renderer, frects, count);
 
     SDL_stack_free(frects);
 
@@ -1632,7 +2008,7 @@ SDL_RenderDrawPoints(SDL_Renderer * renderer,
         fpoints[i].y = points[i].y * renderer->scale.y;
     }
 
-    status = renderer->RenderDrawPoints(renderer, fpoints, count);
+    status = QueueCmdDrawPoints(renderer, fpoints, count);
 
     SDL_stack_free(fpoints);
 
@@ -1693,11 +2069,11 @@ RenderDrawLinesWithRects(SDL_Renderer * renderer,
             fpoints[0].y = points[i].y * renderer->scale.y;
             fpoints[1].x = points[i+1].x * renderer->scale.x;
             fpoints[1].y = points[i+1].y * renderer->scale.y;
-            status += renderer->RenderDrawLines(renderer, fpoints, 2);
+            status += QueueCmdDrawLines(renderer, fpoints, 2);
         }
     }
 
-    status += renderer->RenderFillRects(renderer, frects, nrects);
+    status += QueueCmdFillRects(renderer, frects, nrects);
 
     SDL_stack_free(frects);
 
@@ -1742,7 +2118,7 @@ SDL_RenderDrawLines(SDL_Renderer * renderer,
         fpoints[i].y = points[i].y * renderer->scale.y;
     }
 
-    status = renderer->RenderDrawLines(renderer, fpoints, count);
+    status = QueueCmdDrawLines(renderer, fpoints, count);
 
     SDL_stack_free(fpoints);
 
@@ -1856,7 +2232,7 @@ SDL_RenderFillRects(SDL_Renderer * renderer,
         frects[i].h = rects[i].h * renderer->scale.y;
     }
 
-    status = renderer->RenderFillRects(renderer, frects, count);
+    status = QueueCmdFillRects(renderer, frects, count);
 
     SDL_stack_free(frects);
 
@@ -1912,7 +2288,7 @@ SDL_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
     frect.w = real_dstrect.w * renderer->scale.x;
     frect.h = real_dstrect.h * renderer->scale.y;
 
-    return renderer->RenderCopy(renderer, texture, &real_srcrect, &frect);
+    return QueueCmdCopy(renderer, texture, &real_srcrect, &frect);
 }
 
 
@@ -1937,7 +2313,7 @@ SDL_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
     if (renderer != texture->renderer) {
         return SDL_SetError("Texture was not created with this renderer");
     }
-    if (!renderer->RenderCopyEx) {
+    if (!renderer->RenderCopyEx && !renderer->RunCommandQueue) {
         return SDL_SetError("Renderer does not support RenderCopyEx");
     }
 
@@ -1984,7 +2360,40 @@ SDL_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
     fcenter.x = real_center.x * renderer->scale.x;
     fcenter.y = real_center.y * renderer->scale.y;
 
-    return renderer->RenderCopyEx(renderer, texture, &real_srcrect, &frect, angle, &fcenter, flip);
+    return QueueCmdCopyEx(renderer, texture, &real_srcrect, &frect, angle, &fcenter, flip);
+}
+
+/* Flush and clip a read to the viewport. Returns 1 if there is something
+   to read, 0 if not and -1 on error. */
+static int
+PrepareReadPixels(SDL_Renderer * renderer, const SDL_Rect * rect,
+                  Uint32 * format, void ** pixels, int pitch, SDL_Rect * real_rect)
+{
+    if (renderer->RunCommandQueue && FlushRenderCommands(renderer) < 0) {
+        return -1;
+    }
+
+    if (!*format) {
+        *format = SDL_GetWindowPixelFormat(renderer->window);
+    }
+
+    real_rect->x = renderer->viewport.x;
+    real_rect->y = renderer->viewport.y;
+    real_rect->w = renderer->viewport.w;
+    real_rect->h = renderer->viewport.h;
+    if (rect) {
+        if (!SDL_IntersectRect(rect, real_rect, real_rect)) {
+            return 0;
+        }
+        if (real_rect->y > rect->y) {
+            *pixels = (Uint8 *)*pixels + pitch * (real_rect->y - rect->y);
+        }
+        if (real_rect->x > rect->x) {
+            int bpp = SDL_BYTESPERPIXEL(*format);
+            *pixels = (Uint8 *)*pixels + bpp * (real_rect->x - rect->x);
+        }
+    }
+    return 1;
 }
 
 int
@@ -1992,6 +2401,7 @@ SDL_RenderReadPixels(SDL_Renderer * renderer, const SDL_Rect * rect,
                      Uint32 format, void * pixels, int pitch)
 {
     SDL_Rect real_rect;
+    int retval;
 
     CHECK_RENDERER_MAGIC(renderer, -1);
 
@@ -1999,31 +2409,53 @@ SDL_RenderReadPixels(SDL_Renderer * renderer, const SDL_Rect * rect,
         return SDL_Unsupported();
     }
 
-    if (!format) {
-        format = SDL_GetWindowPixelFormat(renderer->window);
-    }
-
-    real_rect.x = renderer->viewport.x;
-    real_rect.y = renderer->viewport.y;
-    real_rect.w = renderer->viewport.w;
-    real_rect.h = renderer->viewport.h;
-    if (rect) {
-        if (!SDL_IntersectRect(rect, &real_rect, &real_rect)) {
-            return 0;
-        }
-        if (real_rect.y > rect->y) {
-            pixels = (Uint8 *)pixels + pitch * (real_rect.y - rect->y);
-        }
-        if (real_rect.x > rect->x) {
-            int bpp = SDL_BYTESPERPIXEL(format);
-            pixels = (Uint8 *)pixels + bpp * (real_rect.x - rect->x);
-        }
+    retval = PrepareReadPixels(renderer, rect, &format, &pixels, pitch, &real_rect);
+    if (retval <= 0) {
+        return retval;
     }
 
     return renderer->RenderReadPixels(renderer, &real_rect,
                                       format, pixels, pitch);
 }
 
+int
+SDL_RenderReadPixelsAsync(SDL_Renderer * renderer, const SDL_Rect * rect,
+                          Uint32 format, void * pixels, int pitch,
+                          SDL_ReadPixelsCallback callback, void *userdata)
+{
+    SDL_Rect real_rect;
+    int retval;
+
+    CHECK_RENDERER_MAGIC(renderer, -1);
+
+    if (!callback) {
+        return SDL_InvalidParamError("callback");
+    }
+    if (!renderer->RenderReadPixels && !renderer->RenderReadPixelsAsync) {
+        return SDL_Unsupported();
+    }
+
+    retval = PrepareReadPixels(renderer, rect, &format, &pixels, pitch, &real_rect);
+    if (retval < 0) {
+        return retval;
+    }
+    if (retval == 0) {
+        callback(userdata, 0);
+        return 0;
+    }
+
+    if (renderer->RenderReadPixelsAsync) {
+        return renderer->RenderReadPixelsAsync(renderer, &real_rect, format,
+                                               pixels, pitch, callback, userdata);
+    }
+
+    retval = renderer->RenderReadPixels(renderer, &real_rect, format, pixels, pitch);
+    if (retval == 0) {
+        callback(userdata, 0);
+    }
+    return retval;
+}
+
 void
 SDL_RenderPresent(SDL_Renderer * renderer)
 {
@@ -2033,9 +2465,24 @@ SDL_RenderPresent(SDL_Renderer * renderer)
     if (renderer->hidden) {
         return;
     }
+
+    if (renderer->RunCommandQueue) {
+        FlushRenderCommands(renderer);  /* time to send everything to the driver! */
+    }
     renderer->RenderPresent(renderer);
 }
 
+int
+SDL_RenderFlush(SDL_Renderer * renderer)
+{
+    CHECK_RENDERER_MAGIC(renderer, -1);
+
+    if (!renderer->RunCommandQueue) {
+        return 0;
+    }
+    return FlushRenderCommands(renderer);
+}
+
 void
 SDL_DestroyTexture(SDL_Texture * texture)
 {
@@ -2045,7 +2492,9 @@ SDL_DestroyTexture(SDL_Texture * texture)
 
     renderer = texture->renderer;
     if (texture == renderer->target) {
-        SDL_SetRenderTarget(renderer, NULL);
+        SDL_SetRenderTarget(renderer, NULL);  /* implies command queue flush */
+    } else if (renderer->RunCommandQueue) {
+        FlushRenderCommandsIfTextureNeeded(texture);
     }
 
     texture->magic = NULL;
@@ -2078,6 +2527,9 @@ SDL_DestroyRenderer(SDL_Renderer * renderer)
 
     SDL_DelEventWatch(SDL_RendererEventWatch, renderer);
 
+    /* Nothing queued will ever be presented */
+    DiscardRenderCommands(renderer);
+
     /* Free existing textures for this renderer */
     while (renderer->textures) {
         SDL_Texture *tex = renderer->textures; (void) tex;
@@ -2092,6 +2544,16 @@ SDL_DestroyRenderer(SDL_Renderer * renderer)
     /* It's no longer magical... */
     renderer->magic = NULL;
 
+    /* Free the command queue and its vertex arena */
+    DiscardRenderCommands(renderer);
+    while (renderer->render_commands_pool) {
+        SDL_RenderCommand *next = renderer->render_commands_pool->next;
+        SDL_free(renderer->render_commands_pool);
+        renderer->render_commands_pool = next;
+    }
+    SDL_free(renderer->vertex_data);
+    renderer->vertex_data = NULL;
+
     /* Free the renderer instance */
     renderer->DestroyRenderer(renderer);
 }
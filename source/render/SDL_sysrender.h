@@ -66,12 +66,73 @@ struct SDL_Texture
     int pitch;
     SDL_Rect locked_rect;
 
+    Uint32 last_command_generation; /* last command queue generation this texture was in. */
+
     void *driverdata;           /**< Driver specific texture representation */
 
     SDL_Texture *prev;
     SDL_Texture *next;
 };
 
+typedef enum
+{
+    SDL_RENDERCMD_NO_OP,
+    SDL_RENDERCMD_SETVIEWPORT,
+    SDL_RENDERCMD_SETCLIPRECT,
+    SDL_RENDERCMD_CLEAR,
+    SDL_RENDERCMD_DRAW_POINTS,
+    SDL_RENDERCMD_DRAW_LINES,
+    SDL_RENDERCMD_FILL_RECTS,
+    SDL_RENDERCMD_COPY,
+    SDL_RENDERCMD_COPY_EX
+} SDL_RenderCommandType;
+
+/* Vertex data for SDL_RENDERCMD_COPY, one per queued copy */
+typedef struct
+{
+    SDL_Rect srcrect;
+    SDL_FRect dstrect;
+} SDL_RenderCopyData;
+
+/* Vertex data for SDL_RENDERCMD_COPY_EX, one per queued copy */
+typedef struct
+{
+    SDL_Rect srcrect;
+    SDL_FRect dstrect;
+    double angle;
+    SDL_FPoint center;
+    SDL_RendererFlip flip;
+} SDL_RenderCopyExData;
+
+/* A queued render command. Draw commands reference 'count' elements of
+   vertex data starting at byte offset 'first': SDL_FPoint for points,
+   pairs of SDL_FPoint (one segment each) for lines, SDL_FRect for rects,
+   and SDL_RenderCopyData / SDL_RenderCopyExData for copies. */
+typedef struct SDL_RenderCommand
+{
+    SDL_RenderCommandType command;
+    union {
+        struct {
+            SDL_Rect rect;
+        } viewport;
+        struct {
+            SDL_bool enabled;
+            SDL_Rect rect;
+        } cliprect;
+        struct {
+            size_t first;
+            size_t count;
+            Uint8 r, g, b, a;
+            SDL_BlendMode blend;
+            SDL_Texture *texture;
+        } draw;
+        struct {
+            Uint8 r, g, b, a;
+        } color;
+    } data;
+    struct SDL_RenderCommand *next;
+} SDL_RenderCommand;
+
 /* Define the SDL renderer structure */
 struct SDL_Renderer
 {
@@ -115,7 +176,19 @@ struct SDL_Renderer
                        const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip);
     int (*RenderReadPixels) (SDL_Renderer * renderer, const SDL_Rect * rect,
                              Uint32 format, void * pixels, int pitch);
+    /* Optional. Like RenderReadPixels, but may return before 'pixels' is
+       written; 'callback' is called, from any thread, once it is. */
+    int (*RenderReadPixelsAsync) (SDL_Renderer * renderer, const SDL_Rect * rect,
+                                  Uint32 format, void * pixels, int pitch,
+                                  SDL_ReadPixelsCallback callback, void *userdata);
     void (*RenderPresent) (SDL_Renderer * renderer);
+
+    /* If set, drawing is queued by SDL_render.c and handed to the driver in
+       one pass; RenderClear, RenderDrawPoints, RenderDrawLines,
+       RenderFillRects, RenderCopy, RenderCopyEx and UpdateViewport are
+       not used. */
+    int (*RunCommandQueue) (SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertices, size_t vertsize);
+
     void (*DestroyTexture) (SDL_Renderer * renderer, SDL_Texture * texture);
 
     void (*DestroyRenderer) (SDL_Renderer * renderer);
@@ -168,6 +241,18 @@ struct SDL_Renderer
     Uint8 r, g, b, a;                   /**< Color for drawing operations values */
     SDL_BlendMode blendMode;            /**< The drawing blend mode */
 
+    SDL_bool batching;
+    SDL_RenderCommand *render_commands;
+    SDL_RenderCommand *render_commands_tail;
+    SDL_RenderCommand *render_commands_pool;
+    Uint32 render_command_generation;
+    SDL_bool viewport_queued;
+    SDL_bool cliprect_queued;
+
+    void *vertex_data;
+    size_t vertex_data_used;
+    size_t vertex_data_allocation;
+
     void *driverdata;
 };
 
@@ -23,7 +23,10 @@
 #if SDL_VIDEO_RENDER_ORBIS
 
 #include "SDL_hints.h"
+#include "SDL_system.h"
+#include "../../thread/SDL_systhread.h"
 #include "../SDL_sysrender.h"
+#include "SDL_render_orbis_raster.h"
 
 #include <kernel.h>
 #include <stdio.h>
@@ -53,25 +56,48 @@ static void ORBIS_UnlockTexture(SDL_Renderer *renderer,
 	 SDL_Texture *texture);
 static int ORBIS_SetRenderTarget(SDL_Renderer *renderer,
 		 SDL_Texture *texture);
-static int ORBIS_UpdateViewport(SDL_Renderer *renderer);
-static int ORBIS_RenderClear(SDL_Renderer *renderer);
-static int ORBIS_RenderDrawPoints(SDL_Renderer *renderer,
-		const SDL_FPoint *points, int count);
-static int ORBIS_RenderDrawLines(SDL_Renderer *renderer,
-		const SDL_FPoint *points, int count);
-static int ORBIS_RenderFillRects(SDL_Renderer *renderer,
-		const SDL_FRect *rects, int count);
-static int ORBIS_RenderCopy(SDL_Renderer *renderer, SDL_Texture *texture,
-	const SDL_Rect *srcrect, const SDL_FRect *dstrect);
+static int ORBIS_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd,
+	void *vertices, size_t vertsize);
 static int ORBIS_RenderReadPixels(SDL_Renderer *renderer, const SDL_Rect *rect,
 	Uint32 pixel_format, void *pixels, int pitch);
-static int ORBIS_RenderCopyEx(SDL_Renderer *renderer, SDL_Texture *texture,
-	const SDL_Rect *srcrect, const SDL_FRect *dstrect,
-	const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip);
+static int ORBIS_RenderReadPixelsAsync(SDL_Renderer *renderer, const SDL_Rect *rect,
+	Uint32 pixel_format, void *pixels, int pitch,
+	SDL_ReadPixelsCallback callback, void *userdata);
 static void ORBIS_RenderPresent(SDL_Renderer *renderer);
 static void ORBIS_DestroyTexture(SDL_Renderer *renderer, SDL_Texture *texture);
 static void ORBIS_DestroyRenderer(SDL_Renderer *renderer);
 
+/* Damage kept per list before rects start getting merged into bigger ones */
+#define ORBIS_MAX_DAMAGE_RECTS	16
+
+/* Number of orbis2d display buffers */
+#define ORBIS_NUM_FRAMEBUFFERS	2
+
+typedef struct
+{
+	SDL_Rect	rects[ORBIS_MAX_DAMAGE_RECTS];
+	int		count;
+} ORBIS_DamageList;
+
+typedef struct
+{
+	ORBIS_DamageList	dirty;	/* drawn to since the last clear */
+	SDL_bool	cleared;	/* buffer is clearColor outside of 'dirty' */
+	Uint32		clearColor;
+} ORBIS_FrameBuffer;
+
+/* A pixel read handed to the read thread */
+typedef struct
+{
+	ORBIS_Surface	src;
+	SDL_Rect	rect;
+	Uint32		format;
+	void		*pixels;
+	int		pitch;
+	SDL_ReadPixelsCallback	callback;
+	void		*userdata;
+} ORBIS_ReadPixelsJob;
+
 typedef struct
 {
 	void		*frontbuffer;
@@ -82,19 +108,67 @@ typedef struct
 	unsigned int	bpp;
 	SDL_bool	vsync;
 	unsigned int	currentColor;
-	int		 currentBlendMode;
+	SDL_BlendMode	currentBlendMode;
+	ORBIS_FillSpanFunc	fillspan;	/* kernels for currentBlendMode */
+	ORBIS_CopySpanFunc	copyspan;
+	SDL_Rect	viewport;	/* as last set by the command queue */
+	SDL_bool	cliprect_enabled;
+	SDL_Rect	cliprect;	/* relative to the viewport */
+	SDL_Texture	*target;	/* NULL when drawing to the screen */
+	SDL_bool	dirtyrects;	/* SDL_HINT_ORBIS_RENDER_DIRTY_RECTS */
+	ORBIS_FrameBuffer	buffers[ORBIS_NUM_FRAMEBUFFERS];
+	ORBIS_DamageList	frameDamage;	/* screen changes of the current frame */
+	ORBIS_DamageList	lastFrameDamage;	/* and of the last presented one */
+	int		lastBuffer;	/* buffer presented last */
+	SDL_bool	frameSynced;	/* back buffer caught up with the front one */
+	Uint64		pixelsTouched;	/* screen pixels written this frame */
+	Uint64		lastPixelsTouched;	/* and in the last presented one */
+	SDL_Thread	*readThread;	/* started by the first async read */
+	SDL_sem		*readStart;
+	SDL_sem		*readDone;
+	SDL_bool	readPending;	/* readJob is queued or running */
+	SDL_bool	readQuit;
+	ORBIS_ReadPixelsJob	readJob;
 
 } ORBIS_RenderData;
 
 
+/* Textures wider or taller than this are split into tiles, so a single
+   orbis2d allocation never grows past 16 MB */
+#define ORBIS_MAX_TILE_SIZE	2048
+
 typedef struct
 {
-	Orbis2dTexture	*tex;
-	unsigned int	pitch;
+	Orbis2dTexture	**texs;	/* one per tile */
+	ORBIS_Tile	*tiles;
+	int		numtiles;
+	ORBIS_TexelFormat	format;	/* upload format; texels are kept as ARGB8888 */
+	unsigned int	bpp;	/* of the upload format */
 	unsigned int	w;
 	unsigned int	h;
+	void		*lockbuf;	/* staging for a lock that can't be written in place */
+	size_t		lockbufsize;
+	SDL_Rect	lockrect;
 } ORBIS_TextureData;
 
+/* Staging buffers up to this size are kept for the next lock, so
+   streaming textures don't allocate every frame */
+#define ORBIS_MAX_KEPT_LOCKBUF	(256 * 1024)
+
+
+/* Wait for the pending async read if it is reading from 'surface',
+   or whatever it is reading if 'surface' is NULL */
+static void
+ORBIS_WaitReadPixels(ORBIS_RenderData *data, const void *surface)
+{
+	if (!data->readPending)
+		return;
+	if (surface && surface != data->readJob.src.pixels)
+		return;
+
+	SDL_SemWait(data->readDone);
+	data->readPending = SDL_FALSE;
+}
 
 static int
 GetScaleQuality(void)
@@ -108,23 +182,31 @@ GetScaleQuality(void)
 	}
 }
 
-/*
-static int
-PixelFormatToVITAFMT(Uint32 format)
+/* YUV formats aren't listed; SDL_CreateTexture() converts them to
+   ARGB8888 through its software YUV texture */
+static SDL_bool
+PixelFormatToORBISFMT(Uint32 format, ORBIS_TexelFormat *texelFormat)
 {
 	switch (format) {
-	case SDL_PIXELFORMAT_BGR565:
-		return SCE_GXM_COLOR_FORMAT_R5G6B5;
-	case SDL_PIXELFORMAT_ABGR1555:
-		return SCE_GXM_COLOR_FORMAT_A1R5G5B5;
-	case SDL_PIXELFORMAT_ABGR4444:
-		return SCE_GXM_COLOR_FORMAT_A4R4G4B4;
+	case SDL_PIXELFORMAT_ARGB8888:
+		*texelFormat = ORBIS_TEXEL_ARGB8888;
+		return SDL_TRUE;
 	case SDL_PIXELFORMAT_ABGR8888:
+		*texelFormat = ORBIS_TEXEL_ABGR8888;
+		return SDL_TRUE;
+	case SDL_PIXELFORMAT_RGBA8888:
+		*texelFormat = ORBIS_TEXEL_RGBA8888;
+		return SDL_TRUE;
+	case SDL_PIXELFORMAT_BGRA8888:
+		*texelFormat = ORBIS_TEXEL_BGRA8888;
+		return SDL_TRUE;
+	case SDL_PIXELFORMAT_RGB565:
+		*texelFormat = ORBIS_TEXEL_RGB565;
+		return SDL_TRUE;
 	default:
-		return SCE_GXM_COLOR_FORMAT_A8B8G8R8;
+		return SDL_FALSE;
 	}
 }
-*/
 
 void
 StartDrawing(SDL_Renderer *renderer)
@@ -165,14 +247,9 @@ ORBIS_CreateRenderer(SDL_Window *window, Uint32 flags)
 	renderer->LockTexture = ORBIS_LockTexture;
 	renderer->UnlockTexture = ORBIS_UnlockTexture;
 	renderer->SetRenderTarget = ORBIS_SetRenderTarget;
-	renderer->UpdateViewport = ORBIS_UpdateViewport;
-	renderer->RenderClear = ORBIS_RenderClear;
-	renderer->RenderDrawPoints = ORBIS_RenderDrawPoints;
-	renderer->RenderDrawLines = ORBIS_RenderDrawLines;
-	renderer->RenderFillRects = ORBIS_RenderFillRects;
-	renderer->RenderCopy = ORBIS_RenderCopy;
+	renderer->RunCommandQueue = ORBIS_RunCommandQueue;
 	renderer->RenderReadPixels = ORBIS_RenderReadPixels;
-	renderer->RenderCopyEx = ORBIS_RenderCopyEx;
+	renderer->RenderReadPixelsAsync = ORBIS_RenderReadPixelsAsync;
 	renderer->RenderPresent = ORBIS_RenderPresent;
 	renderer->DestroyTexture = ORBIS_DestroyTexture;
 	renderer->DestroyRenderer = ORBIS_DestroyRenderer;
@@ -191,6 +268,7 @@ ORBIS_CreateRenderer(SDL_Window *window, Uint32 flags)
 		} else {
 			data->vsync = SDL_FALSE;
 		}
+		data->dirtyrects = SDL_GetHintBoolean(SDL_HINT_ORBIS_RENDER_DIRTY_RECTS, SDL_FALSE);
 		return renderer;
 			
 	}
@@ -204,22 +282,79 @@ ORBIS_WindowEvent(SDL_Renderer *renderer, const SDL_WindowEvent *event)
 }
 
 
+static void
+ORBIS_FreeTextureData(ORBIS_TextureData *orbis_texture)
+{
+	int i;
+
+	if (orbis_texture->texs) {
+		for (i = 0; i < orbis_texture->numtiles; ++i) {
+			if (orbis_texture->texs[i])
+				orbis2dDestroyTexture(orbis_texture->texs[i]);
+		}
+	}
+	SDL_free(orbis_texture->texs);
+	SDL_free(orbis_texture->tiles);
+	SDL_free(orbis_texture->lockbuf);
+	SDL_free(orbis_texture);
+}
+
 static int
 ORBIS_CreateTexture(SDL_Renderer *renderer, SDL_Texture *texture)
 {
-	ORBIS_TextureData* orbis_texture = (ORBIS_TextureData *) SDL_calloc(1, sizeof(*orbis_texture));
+	ORBIS_TextureData* orbis_texture;
+	ORBIS_TexelFormat format;
+	const int cols = (texture->w + ORBIS_MAX_TILE_SIZE - 1) / ORBIS_MAX_TILE_SIZE;
+	const int rows = (texture->h + ORBIS_MAX_TILE_SIZE - 1) / ORBIS_MAX_TILE_SIZE;
+	int i;
 
-	if(!orbis_texture)
-		return -1;
+	if (!PixelFormatToORBISFMT(texture->format, &format))
+		return SDL_SetError("Unsupported texture format");
+
+	/* The rasterizer only draws to ARGB8888 */
+	if (texture->access == SDL_TEXTUREACCESS_TARGET && format != ORBIS_TEXEL_ARGB8888)
+		return SDL_SetError("Render targets must be SDL_PIXELFORMAT_ARGB8888");
 
-	orbis_texture->tex = orbis2dCreateEmptyTexture(texture->w, texture->h);
+	/* and to a single surface */
+	if (texture->access == SDL_TEXTUREACCESS_TARGET && cols * rows > 1)
+		return SDL_SetError("Render targets can't be larger than %dx%d", ORBIS_MAX_TILE_SIZE, ORBIS_MAX_TILE_SIZE);
 
-	if(!orbis_texture->tex)
-	{
-		SDL_free(orbis_texture);
+	orbis_texture = (ORBIS_TextureData *) SDL_calloc(1, sizeof(*orbis_texture));
+	if(!orbis_texture)
+		return SDL_OutOfMemory();
+
+	orbis_texture->format = format;
+	orbis_texture->bpp = SDL_BYTESPERPIXEL(texture->format);
+	orbis_texture->w = texture->w;
+	orbis_texture->h = texture->h;
+	orbis_texture->numtiles = cols * rows;
+	orbis_texture->texs = (Orbis2dTexture **) SDL_calloc(orbis_texture->numtiles, sizeof(*orbis_texture->texs));
+	orbis_texture->tiles = (ORBIS_Tile *) SDL_calloc(orbis_texture->numtiles, sizeof(*orbis_texture->tiles));
+	if (!orbis_texture->texs || !orbis_texture->tiles) {
+		ORBIS_FreeTextureData(orbis_texture);
 		return SDL_OutOfMemory();
 	}
 
+	for (i = 0; i < orbis_texture->numtiles; ++i) {
+		ORBIS_Tile *tile = &orbis_texture->tiles[i];
+		Orbis2dTexture *tex;
+
+		tile->x = (i % cols) * ORBIS_MAX_TILE_SIZE;
+		tile->y = (i / cols) * ORBIS_MAX_TILE_SIZE;
+		tile->surface.w = SDL_min(texture->w - tile->x, ORBIS_MAX_TILE_SIZE);
+		tile->surface.h = SDL_min(texture->h - tile->y, ORBIS_MAX_TILE_SIZE);
+
+		tex = orbis2dCreateEmptyTexture(tile->surface.w, tile->surface.h);
+		if (!tex) {
+			ORBIS_FreeTextureData(orbis_texture);
+			return SDL_OutOfMemory();
+		}
+		orbis_texture->texs[i] = tex;
+
+		tile->surface.pixels = (Uint32 *) orbis2dTextureGetDataPointer(tex);
+		tile->surface.pitch = tex->width * 4;
+	}
+
 	/* 
 	set texture filtering according to SDL_HINT_RENDER_SCALE_QUALITY
 	suported hint values are nearest (0, default) or linear (1)
@@ -229,38 +364,59 @@ ORBIS_CreateTexture(SDL_Renderer *renderer, SDL_Texture *texture)
 	//int scaleMode = GetScaleQuality();
 	//vita2d_texture_set_filters(vita_texture->tex, scaleMode, scaleMode); 
 
-	orbis_texture->w = orbis_texture->tex->width;
-	orbis_texture->h = orbis_texture->tex->height;
-	orbis_texture->pitch = orbis_texture->w *SDL_BYTESPERPIXEL(texture->format);
-
 	texture->driverdata = orbis_texture;
 
 	return 0;
 }
 
+/* Convert 'rect' of texel data in the upload format to wherever it lives
+   in the texture's tiles, or copy it back from the tiles if 'fromtiles' is
+   set, which only ARGB8888 textures can do */
+static void
+ORBIS_CopyTiles(ORBIS_TextureData *orbis_texture, const SDL_Rect *rect,
+				void *pixels, int pitch, SDL_bool fromtiles)
+{
+	const int bpp = orbis_texture->bpp;
+	int i, row;
+
+	for (i = 0; i < orbis_texture->numtiles; ++i) {
+		const ORBIS_Tile *tile = &orbis_texture->tiles[i];
+		SDL_Rect tilerect, part;
+		Uint8 *src, *dst;
+		int length;
+
+		tilerect.x = tile->x;
+		tilerect.y = tile->y;
+		tilerect.w = tile->surface.w;
+		tilerect.h = tile->surface.h;
+		if (!SDL_IntersectRect(rect, &tilerect, &part))
+			continue;
+
+		src = (Uint8 *) pixels + (part.y - rect->y) * pitch + (part.x - rect->x) * bpp;
+		dst = (Uint8 *) tile->surface.pixels + (part.y - tile->y) * tile->surface.pitch + (part.x - tile->x) * 4;
+		length = part.w * 4;
+		for (row = 0; row < part.h; ++row) {
+			if (fromtiles) {
+				SDL_memcpy(src, dst, length);
+			} else {
+				ORBIS_ConvertTexels((Uint32 *) dst, src, part.w, orbis_texture->format);
+			}
+			src += pitch;
+			dst += tile->surface.pitch;
+		}
+	}
+}
 
 static int
 ORBIS_UpdateTexture(SDL_Renderer *renderer, SDL_Texture *texture,
 				   const SDL_Rect *rect, const void *pixels, int pitch)
 {
-	const Uint8 *src;
-	Uint8 *dst;
-	int row, length,dpitch;
-	src = pixels;
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
+	ORBIS_TextureData *orbis_texture = (ORBIS_TextureData *) texture->driverdata;
 
-	ORBIS_LockTexture(renderer, texture, rect, (void **)&dst, &dpitch);
-	length = rect->w * SDL_BYTESPERPIXEL(texture->format);
-	if (length == pitch && length == dpitch) {
-		SDL_memcpy(dst, src, length*rect->h);
-	} else {
-		for (row = 0; row < rect->h; ++row) {
-			SDL_memcpy(dst, src, length);
-			src += pitch;
-			dst += dpitch;
-		}
-	}
+	ORBIS_WaitReadPixels(data, orbis_texture->tiles[0].surface.pixels);
+	ORBIS_CopyTiles(orbis_texture, rect, (void *) pixels, pitch, SDL_FALSE);
 
-	//sceKernelDcacheWritebackAll();
 	return 0;
 }
 
@@ -268,289 +424,640 @@ static int
 ORBIS_LockTexture(SDL_Renderer *renderer, SDL_Texture *texture,
 				 const SDL_Rect *rect, void **pixels, int *pitch)
 {
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
 	ORBIS_TextureData *orbis_texture = (ORBIS_TextureData *) texture->driverdata;
+	const ORBIS_Surface *surface = &orbis_texture->tiles[0].surface;
+	size_t size;
 
-	*pixels =
-		(void *) ((Uint8 *) orbis2dTextureGetDataPointer(orbis_texture->tex)
-			+ (rect->y * orbis_texture->w + rect->x) * SDL_BYTESPERPIXEL(texture->format));
-	*pitch = orbis_texture->pitch;
+	ORBIS_WaitReadPixels(data, surface->pixels);
+
+	if (orbis_texture->numtiles == 1 && orbis_texture->format == ORBIS_TEXEL_ARGB8888) {
+		*pixels =
+			(void *) ((Uint8 *) surface->pixels
+				+ rect->y * surface->pitch + rect->x * orbis_texture->bpp);
+		*pitch = surface->pitch;
+		return 0;
+	}
+
+	/* Tiles aren't contiguous, or the texels need converting, so stage the
+	   locked rect and write it to the tiles on unlock */
+	size = (size_t) rect->w * rect->h * orbis_texture->bpp;
+	if (size > orbis_texture->lockbufsize) {
+		void *lockbuf = SDL_realloc(orbis_texture->lockbuf, size);
+		if (!lockbuf)
+			return SDL_OutOfMemory();
+		orbis_texture->lockbuf = lockbuf;
+		orbis_texture->lockbufsize = size;
+	}
+	orbis_texture->lockrect = *rect;
+	*pitch = rect->w * orbis_texture->bpp;
+	*pixels = orbis_texture->lockbuf;
+
+	/* Locks are write-only, but an ARGB8888 texture can cheaply start
+	   with the texels the rect covers. Other formats get whatever was
+	   staged last, rather than converting every texel back. */
+	if (orbis_texture->format == ORBIS_TEXEL_ARGB8888)
+		ORBIS_CopyTiles(orbis_texture, rect, *pixels, *pitch, SDL_TRUE);
 	return 0;
 }
 
 static void
 ORBIS_UnlockTexture(SDL_Renderer *renderer, SDL_Texture *texture)
 {
-	// no needs to update texture data on ps vita. VITA_LockTexture
-	// already return a pointer to the vita2d texture pixels buffer.
-	// This really improve framerate when using lock/unlock.
-	
-	/*
-	VITA_TextureData *vita_texture = (VITA_TextureData *) texture->driverdata;
-	SDL_Rect rect;
-
-	// We do whole texture updates, at least for now
-	rect.x = 0;
-	rect.y = 0;
-	rect.w = texture->w;
-	rect.h = texture->h;
-	VITA_UpdateTexture(renderer, texture, &rect, vita_texture->data, vita_texture->pitch);
-	*/
+	ORBIS_TextureData *orbis_texture = (ORBIS_TextureData *) texture->driverdata;
+	const SDL_Rect *rect = &orbis_texture->lockrect;
+
+	/* Untiled ARGB8888 textures were written in place. The rasterizer
+	   reads them with the CPU, through the caches the app wrote through,
+	   so there is nothing to upload or write back. */
+	if (orbis_texture->numtiles == 1 && orbis_texture->format == ORBIS_TEXEL_ARGB8888)
+		return;
+
+	ORBIS_CopyTiles(orbis_texture, rect, orbis_texture->lockbuf, rect->w * orbis_texture->bpp, SDL_FALSE);
+
+	/* Don't hold on to a big lock's worth of memory until the next one */
+	if (orbis_texture->lockbufsize > ORBIS_MAX_KEPT_LOCKBUF) {
+		SDL_free(orbis_texture->lockbuf);
+		orbis_texture->lockbuf = NULL;
+		orbis_texture->lockbufsize = 0;
+	}
 }
 
 static int
 ORBIS_SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
 {
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
+
+	/* SDL_SetRenderTarget() has already flushed the commands queued for
+	   the previous target, so later draws can simply be redirected. */
+	data->target = texture;
 	return 0;
 }
 
-static int
-ORBIS_UpdateViewport(SDL_Renderer *renderer)
+static void
+ORBIS_SetBlendMode(SDL_Renderer *renderer, SDL_BlendMode blendMode)
 {
-	return 0;
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
+	if (blendMode != data->currentBlendMode || !data->fillspan) {
+		data->fillspan = ORBIS_GetFillSpanFunc(blendMode);
+		data->copyspan = ORBIS_GetCopySpanFunc(blendMode);
+		data->currentBlendMode = blendMode;
+	}
 }
 
 
+
+/* Area of 'dst' the current viewport and clip rect allow drawing to */
 static void
-ORBIS_SetBlendMode(SDL_Renderer *renderer, int blendMode)
-{
-	/*VITA_RenderData *data = (VITA_RenderData *) renderer->driverdata;
-	if (blendMode != data-> currentBlendMode) {
-		switch (blendMode) {
-		case SDL_BLENDMODE_NONE:
-				sceGuTexFunc(GU_TFX_REPLACE, GU_TCC_RGBA);
-				sceGuDisable(GU_BLEND);
-			break;
-		case SDL_BLENDMODE_BLEND:
-				sceGuTexFunc(GU_TFX_MODULATE , GU_TCC_RGBA);
-				sceGuEnable(GU_BLEND);
-				sceGuBlendFunc(GU_ADD, GU_SRC_ALPHA, GU_ONE_MINUS_SRC_ALPHA, 0, 0 );
-			break;
-		case SDL_BLENDMODE_ADD:
-				sceGuTexFunc(GU_TFX_MODULATE , GU_TCC_RGBA);
-				sceGuEnable(GU_BLEND);
-				sceGuBlendFunc(GU_ADD, GU_SRC_ALPHA, GU_FIX, 0, 0x00FFFFFF );
-			break;
-		case SDL_BLENDMODE_MOD:
-				sceGuTexFunc(GU_TFX_MODULATE , GU_TCC_RGBA);
-				sceGuEnable(GU_BLEND);
-				sceGuBlendFunc( GU_ADD, GU_FIX, GU_SRC_COLOR, 0, 0);
-			break;
+ORBIS_GetDrawableRect(ORBIS_RenderData *data, const ORBIS_Surface *dst, SDL_Rect *rect)
+{
+	SDL_Rect bounds;
+
+	bounds.x = 0;
+	bounds.y = 0;
+	bounds.w = dst->w;
+	bounds.h = dst->h;
+	if (!SDL_IntersectRect(&data->viewport, &bounds, rect)) {
+		rect->w = rect->h = 0;
+		return;
+	}
+	if (data->cliprect_enabled) {
+		SDL_Rect clip = data->cliprect;
+		clip.x += data->viewport.x;
+		clip.y += data->viewport.y;
+		if (!SDL_IntersectRect(rect, &clip, rect)) {
+			rect->w = rect->h = 0;
 		}
-		data->currentBlendMode = blendMode;
-	}*/
+	}
 }
 
+/* The back buffer orbis2d is currently drawing to */
+static void
+ORBIS_GetScreenSurface(ORBIS_Surface *surface)
+{
+	Orbis2dConfig *conf = orbis2dGetConf();
 
+	surface->pixels = (Uint32 *) conf->surfaceAddr[conf->currentBuffer];
+	surface->w = conf->width;
+	surface->h = conf->height;
+	surface->pitch = conf->pitch * 4;
+}
 
-static int
-ORBIS_RenderClear(SDL_Renderer *renderer)
+static void
+ORBIS_GetTextureSurface(SDL_Texture *texture, ORBIS_Surface *surface)
 {
-	/* start list */
-	StartDrawing(renderer);
-	uint32_t color = renderer->a << 24 | renderer->r << 16 | renderer->g << 8 | renderer->b;
-	if(orbis2dGetStatus()) {
-		orbis2dSetBgColor(color);
+	ORBIS_TextureData *orbis_texture = (ORBIS_TextureData *) texture->driverdata;
+
+	/* Render targets are never tiled */
+	*surface = orbis_texture->tiles[0].surface;
+}
+
+/* Where draws currently land: the render target texture or the back buffer */
+static void
+ORBIS_GetTargetSurface(SDL_Renderer *renderer, ORBIS_Surface *surface)
+{
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
+
+	if (data->target) {
+		ORBIS_GetTextureSurface(data->target, surface);
+	} else {
+		ORBIS_GetScreenSurface(surface);
 	}
-	orbis2dClearBuffer(1);
-	
-	return 0;
 }
 
-static int
-ORBIS_RenderDrawPoints(SDL_Renderer *renderer, const SDL_FPoint *points,
-					  int count)
+/* Add 'rect' to 'list', merging it with every rect it overlaps. When the
+   list is full the rect goes into the entry whose area grows the least. */
+static void
+ORBIS_AddDamage(ORBIS_DamageList *list, const SDL_Rect *rect)
 {
-	uint32_t color = renderer->a << 24 | renderer->r << 16 | renderer->g << 8 | renderer->b;
+	SDL_Rect merged = *rect;
 	int i;
-	StartDrawing(renderer);
 
-	for (i = 0; i < count; ++i) {
-		orbis2dDrawPixelColor(points[i].x, points[i].y, color);
-	}
+	if (SDL_RectEmpty(&merged))
+		return;
 
-	return 0;
+	for (;;) {
+		for (i = 0; i < list->count; ++i) {
+			if (SDL_HasIntersection(&merged, &list->rects[i]))
+				break;
+		}
+		if (i == list->count && list->count < ORBIS_MAX_DAMAGE_RECTS) {
+			list->rects[list->count++] = merged;
+			return;
+		}
+		if (i == list->count) {
+			int best = 0, j;
+			Sint64 bestgrowth = 0;
+			for (j = 0; j < list->count; ++j) {
+				SDL_Rect u;
+				Sint64 growth;
+				SDL_UnionRect(&merged, &list->rects[j], &u);
+				growth = (Sint64) u.w * u.h - (Sint64) list->rects[j].w * list->rects[j].h;
+				if (j == 0 || growth < bestgrowth) {
+					best = j;
+					bestgrowth = growth;
+				}
+			}
+			i = best;
+		}
+		/* The union may now overlap other entries, so go around again */
+		SDL_UnionRect(&merged, &list->rects[i], &merged);
+		list->rects[i] = list->rects[--list->count];
+	}
 }
 
 static int
-ORBIS_RenderDrawLines(SDL_Renderer *renderer, const SDL_FPoint *points,
-					 int count)
+ORBIS_GetBackBufferIndex(void)
 {
-	uint32_t color = renderer->a << 24 | renderer->r << 16 | renderer->g << 8 | renderer->b;
-	int i;
-	StartDrawing(renderer);
+	return orbis2dGetConf()->currentBuffer % ORBIS_NUM_FRAMEBUFFERS;
+}
 
-	for (i = 0; i < count; ++i) {
-	if (i < count -1) {
-		orbis2dDrawLineColor(points[i].x, points[i].y, points[i+1].x, points[i+1].y, color);
-	}
+/* Account for a draw that may have written 'rect' (clipped, in target coordinates) */
+static void
+ORBIS_MarkDrawn(ORBIS_RenderData *data, const SDL_Rect *rect)
+{
+	if (data->target || SDL_RectEmpty(rect))
+		return;
+
+	data->pixelsTouched += (Uint64) rect->w * rect->h;
+	if (data->dirtyrects) {
+		ORBIS_AddDamage(&data->buffers[ORBIS_GetBackBufferIndex()].dirty, rect);
+		ORBIS_AddDamage(&data->frameDamage, rect);
 	}
+}
 
-	return 0;
+/* In dirty rect mode the back buffer still holds the frame before last.
+   Before drawing on top of it, copy over what changed in the last frame. */
+static void
+ORBIS_SyncBackBuffer(ORBIS_RenderData *data)
+{
+	Orbis2dConfig *conf = orbis2dGetConf();
+	const int back = ORBIS_GetBackBufferIndex();
+	const int pitch = conf->pitch * 4;
+	int i, y;
+
+	data->frameSynced = SDL_TRUE;
+	if (back == data->lastBuffer)
+		return;
+
+	for (i = 0; i < data->lastFrameDamage.count; ++i) {
+		const SDL_Rect *rect = &data->lastFrameDamage.rects[i];
+		const Uint8 *src = (const Uint8 *) conf->surfaceAddr[data->lastBuffer] + rect->y * pitch + rect->x * 4;
+		Uint8 *dst = (Uint8 *) conf->surfaceAddr[back] + rect->y * pitch + rect->x * 4;
+
+		for (y = 0; y < rect->h; ++y, src += pitch, dst += pitch) {
+			SDL_memcpy(dst, src, rect->w * 4);
+		}
+		data->pixelsTouched += (Uint64) rect->w * rect->h;
+		ORBIS_AddDamage(&data->buffers[back].dirty, rect);
+	}
 }
 
-static int
-ORBIS_RenderFillRects(SDL_Renderer *renderer, const SDL_FRect *rects,
-					 int count)
+static void
+ORBIS_RenderClear(SDL_Renderer *renderer, Uint32 color)
 {
-	uint32_t color = renderer->a << 24 | renderer->r << 16 | renderer->g << 8 | renderer->b;
-	int i;
-	StartDrawing(renderer);
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
 
-	for (i = 0; i < count; ++i) {
-		const SDL_FRect *rect = &rects[i];
-		orbis2dDrawRectColor(rect->x, rect->w, rect->y, rect->h, color);
+	if (data->target) {
+		ORBIS_Surface dst;
+		SDL_Rect rect;
+
+		ORBIS_GetTextureSurface(data->target, &dst);
+		rect.x = 0;
+		rect.y = 0;
+		rect.w = dst.w;
+		rect.h = dst.h;
+		ORBIS_RasterFillRect(&dst, &rect, color, ORBIS_GetFillSpanFunc(SDL_BLENDMODE_NONE));
+		return;
 	}
 
-	return 0;
-}
+	if (data->dirtyrects) {
+		const int back = ORBIS_GetBackBufferIndex();
+		ORBIS_FrameBuffer *buffer = &data->buffers[back];
+		const ORBIS_FrameBuffer *front = &data->buffers[data->lastBuffer];
+
+		/* Everything is overwritten, the front buffer has nothing to give */
+		data->frameSynced = SDL_TRUE;
 
+		/* The next frame catches up from this one, so record how it will
+		   differ from the front buffer: if that has the same background,
+		   only where the front buffer was drawn to. */
+		if (data->lastBuffer != back && front->cleared && front->clearColor == color) {
+			data->frameDamage = front->dirty;
+		} else {
+			data->frameDamage.count = 1;
+			data->frameDamage.rects[0].x = 0;
+			data->frameDamage.rects[0].y = 0;
+			data->frameDamage.rects[0].w = orbis2dGetConf()->width;
+			data->frameDamage.rects[0].h = orbis2dGetConf()->height;
+		}
+
+		if (buffer->cleared && buffer->clearColor == color) {
+			/* Only what was drawn since the last clear needs clearing */
+			ORBIS_Surface dst;
+			int i;
+
+			ORBIS_GetScreenSurface(&dst);
+			for (i = 0; i < buffer->dirty.count; ++i) {
+				ORBIS_RasterFillRect(&dst, &buffer->dirty.rects[i], color, ORBIS_GetFillSpanFunc(SDL_BLENDMODE_NONE));
+				data->pixelsTouched += (Uint64) buffer->dirty.rects[i].w * buffer->dirty.rects[i].h;
+			}
+			buffer->dirty.count = 0;
+			return;
+		}
 
-#define PI   3.14159265358979f
+		buffer->cleared = SDL_TRUE;
+		buffer->clearColor = color;
+		buffer->dirty.count = 0;
+	}
 
-#define radToDeg(x) ((x)*180.f/PI)
-#define degToRad(x) ((x)*PI/180.f)
+	if(orbis2dGetStatus()) {
+		orbis2dSetBgColor(color);
+	}
+	orbis2dClearBuffer(1);
+	data->pixelsTouched += (Uint64) orbis2dGetConf()->width * orbis2dGetConf()->height;
+}
 
-float MathAbs(float x)
+static void
+ORBIS_RenderDrawPoints(SDL_Renderer *renderer, const SDL_FPoint *points,
+					  size_t count, Uint32 color)
 {
-	return (x < 0) ? -x : x;
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
+	ORBIS_Surface dst;
+	SDL_Rect drawable;
+	SDL_Point p;
+	size_t i;
+
+	ORBIS_GetTargetSurface(renderer, &dst);
+	ORBIS_GetDrawableRect(data, &dst, &drawable);
+
+	for (i = 0; i < count; ++i) {
+		p.x = data->viewport.x + (int) points[i].x;
+		p.y = data->viewport.y + (int) points[i].y;
+		if (SDL_PointInRect(&p, &drawable)) {
+			SDL_Rect rect;
+			data->fillspan((Uint32 *) ((Uint8 *) dst.pixels + p.y * dst.pitch) + p.x, color, 1);
+			rect.x = p.x;
+			rect.y = p.y;
+			rect.w = rect.h = 1;
+			ORBIS_MarkDrawn(data, &rect);
+		}
+	}
 }
 
-void MathSincos(float r, float *s, float *c)
+/* 'points' holds 'count' segments as consecutive point pairs */
+static void
+ORBIS_RenderDrawLines(SDL_Renderer *renderer, const SDL_FPoint *points,
+					 size_t count, Uint32 color)
 {
-	*s = sinf(r);
-	*c = cosf(r);
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
+	ORBIS_Surface dst;
+	SDL_Rect drawable;
+	int x1, y1, x2, y2;
+	size_t i;
+
+	ORBIS_GetTargetSurface(renderer, &dst);
+	ORBIS_GetDrawableRect(data, &dst, &drawable);
+
+	for (i = 0; i < count; ++i, points += 2) {
+		x1 = data->viewport.x + (int) points[0].x;
+		y1 = data->viewport.y + (int) points[0].y;
+		x2 = data->viewport.x + (int) points[1].x;
+		y2 = data->viewport.y + (int) points[1].y;
+		if (SDL_IntersectRectAndLine(&drawable, &x1, &y1, &x2, &y2)) {
+			SDL_Rect rect;
+			ORBIS_RasterDrawLine(&dst, x1, y1, x2, y2, color, data->fillspan);
+			rect.x = SDL_min(x1, x2);
+			rect.y = SDL_min(y1, y2);
+			rect.w = SDL_abs(x2 - x1) + 1;
+			rect.h = SDL_abs(y2 - y1) + 1;
+			ORBIS_MarkDrawn(data, &rect);
+		}
+	}
 }
 
-void Swap(float *a, float *b)
+static void
+ORBIS_RenderFillRects(SDL_Renderer *renderer, const SDL_FRect *rects,
+					 size_t count, Uint32 color)
 {
-	float n=*a;
-	*a = *b;
-	*b = n;
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
+	ORBIS_Surface dst;
+	SDL_Rect drawable, rect;
+	size_t i;
+
+	ORBIS_GetTargetSurface(renderer, &dst);
+	ORBIS_GetDrawableRect(data, &dst, &drawable);
+
+	for (i = 0; i < count; ++i) {
+		rect.x = data->viewport.x + (int) rects[i].x;
+		rect.y = data->viewport.y + (int) rects[i].y;
+		rect.w = (int) rects[i].w;
+		rect.h = (int) rects[i].h;
+		if (SDL_IntersectRect(&rect, &drawable, &rect)) {
+			ORBIS_RasterFillRect(&dst, &rect, color, data->fillspan);
+			ORBIS_MarkDrawn(data, &rect);
+		}
+	}
 }
 
-static int
-ORBIS_RenderCopy(SDL_Renderer *renderer, SDL_Texture *texture,
-				const SDL_Rect *srcrect, const SDL_FRect *dstrect)
+
+static void
+ORBIS_RenderCopy(SDL_Renderer *renderer, const ORBIS_TextureData *src,
+				const SDL_Rect *srcrect, const SDL_FRect *dstrect,
+				const ORBIS_DrawState *state)
 {
-	ORBIS_TextureData *orbis_texture = (ORBIS_TextureData *) texture->driverdata;
-	//float scaleX = dstrect->w > srcrect->w ? (float)(dstrect->w/srcrect->w) : 1;
-	//float scaleY = dstrect->h > srcrect->h ? (float)(dstrect->h/srcrect->h) : 1;
-	float scaleX = dstrect->w == srcrect->w ? 1 : (float)(dstrect->w/srcrect->w);
-	float scaleY = dstrect->h == srcrect->h ? 1 : (float)(dstrect->h/srcrect->h);
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
+	ORBIS_Surface dst;
+	SDL_Rect drawable, drawn;
+	SDL_FRect rect = *dstrect;
 
-	StartDrawing(renderer);
+	ORBIS_GetTargetSurface(renderer, &dst);
+	ORBIS_GetDrawableRect(data, &dst, &drawable);
+	rect.x += data->viewport.x;
+	rect.y += data->viewport.y;
 
-	ORBIS_SetBlendMode(renderer, renderer->blendMode);
+	ORBIS_RasterCopy(&dst, &drawable, src->tiles, src->numtiles, srcrect, &rect, state, &drawn);
+	ORBIS_MarkDrawn(data, &drawn);
+}
 
-	//orbis2dDrawTexturePartScale(orbis_texture->tex, dstrect->x, dstrect->y,srcrect->x, srcrect->y, srcrect->w, srcrect->h, scaleX, scaleY);
+/* Copy 'rect' of 'src' into 'pixels', converting from ARGB8888 if needed */
+static int
+ORBIS_ReadSurface(const ORBIS_Surface *src, const SDL_Rect *rect,
+				Uint32 pixel_format, void *pixels, int pitch)
+{
+	const Uint8 *srcpixels = (const Uint8 *) src->pixels + rect->y * src->pitch + rect->x * 4;
+	const int length = rect->w * 4;
+	Uint8 *dstpixels = (Uint8 *) pixels;
+	int row;
+
+	if (pixel_format != SDL_PIXELFORMAT_ARGB8888) {
+		return SDL_ConvertPixels(rect->w, rect->h, SDL_PIXELFORMAT_ARGB8888, srcpixels, src->pitch,
+								 pixel_format, pixels, pitch);
+	}
 
+	if (length == pitch && length == src->pitch) {
+		SDL_memcpy(dstpixels, srcpixels, length * rect->h);
+	} else {
+		for (row = 0; row < rect->h; ++row) {
+			SDL_memcpy(dstpixels, srcpixels, length);
+			srcpixels += src->pitch;
+			dstpixels += pitch;
+		}
+	}
 	return 0;
 }
 
 static int
 ORBIS_RenderReadPixels(SDL_Renderer *renderer, const SDL_Rect *rect,
 					Uint32 pixel_format, void *pixels, int pitch)
-
 {
-		return 0;
-}
+	ORBIS_Surface src;
 
+	ORBIS_GetTargetSurface(renderer, &src);
+	return ORBIS_ReadSurface(&src, rect, pixel_format, pixels, pitch);
+}
 
-static int
-ORBIS_RenderCopyEx(SDL_Renderer *renderer, SDL_Texture *texture,
-				const SDL_Rect *srcrect, const SDL_FRect *dstrect,
-				const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip)
+static int SDLCALL
+ORBIS_ReadPixelsThread(void *userdata)
 {
-	/*float x, y, width, height;
-	float u0, v0, u1, v1;
-	unsigned char alpha;
-	float centerx, centery;
-
-	x = dstrect->x;
-	y = dstrect->y;
-	width = dstrect->w;
-	height = dstrect->h;
+	ORBIS_RenderData *data = (ORBIS_RenderData *) userdata;
 
-	u0 = srcrect->x;
-	v0 = srcrect->y;
-	u1 = srcrect->x + srcrect->w;
-	v1 = srcrect->y + srcrect->h;
+	for (;;) {
+		ORBIS_ReadPixelsJob *job = &data->readJob;
+		int status;
 
-	centerx = center->x;
-	centery = center->y;
+		SDL_SemWait(data->readStart);
+		if (data->readQuit)
+			break;
 
-	alpha = texture->a;
+		status = ORBIS_ReadSurface(&job->src, &job->rect, job->format, job->pixels, job->pitch);
+		job->callback(job->userdata, status);
+		SDL_SemPost(data->readDone);
+	}
+	return 0;
+}
 
-	StartDrawing(renderer);
-	TextureActivate(texture);
-	VITA_SetBlendMode(renderer, renderer->blendMode);
+static int
+ORBIS_RenderReadPixelsAsync(SDL_Renderer *renderer, const SDL_Rect *rect,
+					Uint32 pixel_format, void *pixels, int pitch,
+					SDL_ReadPixelsCallback callback, void *userdata)
+{
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
+	ORBIS_ReadPixelsJob *job = &data->readJob;
 
-	if(alpha != 255)
-	{
-		sceGuTexFunc(GU_TFX_MODULATE, GU_TCC_RGBA);
-		sceGuColor(GU_RGBA(255, 255, 255, alpha));
-	}else{
-		sceGuTexFunc(GU_TFX_REPLACE, GU_TCC_RGBA);
-		sceGuColor(0xFFFFFFFF);
+	if (!data->readThread) {
+		data->readStart = SDL_CreateSemaphore(0);
+		data->readDone = SDL_CreateSemaphore(0);
+		if (data->readStart && data->readDone) {
+			data->readThread = SDL_CreateThreadInternal(ORBIS_ReadPixelsThread, "SDLReadPixels", 0, data);
+		}
+		if (!data->readThread) {
+			if (data->readStart) {
+				SDL_DestroySemaphore(data->readStart);
+				data->readStart = NULL;
+			}
+			if (data->readDone) {
+				SDL_DestroySemaphore(data->readDone);
+				data->readDone = NULL;
+			}
+			return -1;
+		}
 	}
 
-	x += centerx;
-	y += centery;
-
-	float c, s;
+	/* One read in flight at a time */
+	ORBIS_WaitReadPixels(data, NULL);
 
-	MathSincos(degToRad(angle), &s, &c);
+	ORBIS_GetTargetSurface(renderer, &job->src);
+	job->rect = *rect;
+	job->format = pixel_format;
+	job->pixels = pixels;
+	job->pitch = pitch;
+	job->callback = callback;
+	job->userdata = userdata;
 
-	width  -= centerx;
-	height -= centery;
+	data->readPending = SDL_TRUE;
+	SDL_SemPost(data->readStart);
+	return 0;
+}
 
 
-	float cw = c*width;
-	float sw = s*width;
-	float ch = c*height;
-	float sh = s*height;
+static void
+ORBIS_RenderCopyEx(SDL_Renderer *renderer, const ORBIS_TextureData *src,
+				const SDL_Rect *srcrect, const SDL_FRect *dstrect,
+				const ORBIS_DrawState *state,
+				const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip)
+{
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
+	ORBIS_Surface dst;
+	SDL_Rect drawable, drawn;
+	SDL_FRect rect = *dstrect;
 
-	VertTV* vertices = (VertTV*)sceGuGetMemory(sizeof(VertTV)<<2);
+	ORBIS_GetTargetSurface(renderer, &dst);
+	ORBIS_GetDrawableRect(data, &dst, &drawable);
+	rect.x += data->viewport.x;
+	rect.y += data->viewport.y;
 
-	vertices[0].u = u0;
-	vertices[0].v = v0;
-	vertices[0].x = x - cw + sh;
-	vertices[0].y = y - sw - ch;
-	vertices[0].z = 0;
+	ORBIS_RasterCopyEx(&dst, &drawable, src->tiles, src->numtiles, srcrect, &rect, state, angle, center, flip, &drawn);
+	ORBIS_MarkDrawn(data, &drawn);
+}
 
-	vertices[1].u = u0;
-	vertices[1].v = v1;
-	vertices[1].x = x - cw - sh;
-	vertices[1].y = y - sw + ch;
-	vertices[1].z = 0;
+/* Expects ORBIS_SetBlendMode() to have been called for the command */
+static void
+ORBIS_GetDrawState(SDL_Renderer *renderer, const SDL_RenderCommand *cmd, ORBIS_DrawState *state)
+{
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
 
-	vertices[2].u = u1;
-	vertices[2].v = v1;
-	vertices[2].x = x + cw - sh;
-	vertices[2].y = y + sw + ch;
-	vertices[2].z = 0;
+	state->r = cmd->data.draw.r;
+	state->g = cmd->data.draw.g;
+	state->b = cmd->data.draw.b;
+	state->a = cmd->data.draw.a;
+	state->copyspan = data->copyspan;
+}
 
-	vertices[3].u = u1;
-	vertices[3].v = v0;
-	vertices[3].x = x + cw + sh;
-	vertices[3].y = y + sw - ch;
-	vertices[3].z = 0;
+static int
+ORBIS_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd,
+					void *vertices, size_t vertsize)
+{
+	ORBIS_RenderData *data = (ORBIS_RenderData *) renderer->driverdata;
 
-	if (flip & SDL_FLIP_HORIZONTAL) {
-				Swap(&vertices[0].v, &vertices[2].v);
-				Swap(&vertices[1].v, &vertices[3].v);
+	/* start list, textures are drawn to directly */
+	if (!data->target) {
+		StartDrawing(renderer);
 	}
-	if (flip & SDL_FLIP_VERTICAL) {
-				Swap(&vertices[0].u, &vertices[2].u);
-				Swap(&vertices[1].u, &vertices[3].u);
+
+	/* Don't draw under a pending async read */
+	if (data->readPending) {
+		ORBIS_Surface dst;
+		ORBIS_GetTargetSurface(renderer, &dst);
+		ORBIS_WaitReadPixels(data, dst.pixels);
 	}
 
-	sceGuDrawArray(GU_TRIANGLE_FAN, GU_TEXTURE_32BITF|GU_VERTEX_32BITF|GU_TRANSFORM_2D, 4, 0, vertices);
+	while (cmd) {
+		if (data->dirtyrects && !data->target && !data->frameSynced &&
+			cmd->command != SDL_RENDERCMD_SETVIEWPORT &&
+			cmd->command != SDL_RENDERCMD_SETCLIPRECT &&
+			cmd->command != SDL_RENDERCMD_CLEAR &&
+			cmd->command != SDL_RENDERCMD_NO_OP) {
+			ORBIS_SyncBackBuffer(data);
+		}
+
+		switch (cmd->command) {
+			case SDL_RENDERCMD_SETVIEWPORT: {
+				data->viewport = cmd->data.viewport.rect;
+				break;
+			}
+
+			case SDL_RENDERCMD_SETCLIPRECT: {
+				data->cliprect_enabled = cmd->data.cliprect.enabled;
+				data->cliprect = cmd->data.cliprect.rect;
+				break;
+			}
+
+			case SDL_RENDERCMD_CLEAR: {
+				const Uint32 color = cmd->data.color.a << 24 | cmd->data.color.r << 16 | cmd->data.color.g << 8 | cmd->data.color.b;
+				ORBIS_RenderClear(renderer, color);
+				break;
+			}
+
+			case SDL_RENDERCMD_DRAW_POINTS: {
+				const Uint32 color = cmd->data.draw.a << 24 | cmd->data.draw.r << 16 | cmd->data.draw.g << 8 | cmd->data.draw.b;
+				const SDL_FPoint *points = (SDL_FPoint *) (((Uint8 *) vertices) + cmd->data.draw.first);
+				ORBIS_SetBlendMode(renderer, cmd->data.draw.blend);
+				ORBIS_RenderDrawPoints(renderer, points, cmd->data.draw.count, color);
+				break;
+			}
+
+			case SDL_RENDERCMD_DRAW_LINES: {
+				const Uint32 color = cmd->data.draw.a << 24 | cmd->data.draw.r << 16 | cmd->data.draw.g << 8 | cmd->data.draw.b;
+				const SDL_FPoint *points = (SDL_FPoint *) (((Uint8 *) vertices) + cmd->data.draw.first);
+				ORBIS_SetBlendMode(renderer, cmd->data.draw.blend);
+				ORBIS_RenderDrawLines(renderer, points, cmd->data.draw.count, color);
+				break;
+			}
+
+			case SDL_RENDERCMD_FILL_RECTS: {
+				const Uint32 color = cmd->data.draw.a << 24 | cmd->data.draw.r << 16 | cmd->data.draw.g << 8 | cmd->data.draw.b;
+				const SDL_FRect *rects = (SDL_FRect *) (((Uint8 *) vertices) + cmd->data.draw.first);
+				ORBIS_SetBlendMode(renderer, cmd->data.draw.blend);
+				ORBIS_RenderFillRects(renderer, rects, cmd->data.draw.count, color);
+				break;
+			}
+
+			case SDL_RENDERCMD_COPY: {
+				const SDL_RenderCopyData *copy = (SDL_RenderCopyData *) (((Uint8 *) vertices) + cmd->data.draw.first);
+				ORBIS_TextureData *src = (ORBIS_TextureData *) cmd->data.draw.texture->driverdata;
+				ORBIS_DrawState state;
+				size_t i;
+				ORBIS_SetBlendMode(renderer, cmd->data.draw.blend);
+				ORBIS_GetDrawState(renderer, cmd, &state);
+				for (i = 0; i < cmd->data.draw.count; ++i) {
+					ORBIS_RenderCopy(renderer, src, &copy[i].srcrect, &copy[i].dstrect, &state);
+				}
+				break;
+			}
+
+			case SDL_RENDERCMD_COPY_EX: {
+				const SDL_RenderCopyExData *copy = (SDL_RenderCopyExData *) (((Uint8 *) vertices) + cmd->data.draw.first);
+				ORBIS_TextureData *src = (ORBIS_TextureData *) cmd->data.draw.texture->driverdata;
+				ORBIS_DrawState state;
+				size_t i;
+				ORBIS_SetBlendMode(renderer, cmd->data.draw.blend);
+				ORBIS_GetDrawState(renderer, cmd, &state);
+				for (i = 0; i < cmd->data.draw.count; ++i) {
+					ORBIS_RenderCopyEx(renderer, src, &copy[i].srcrect, &copy[i].dstrect, &state,
+									   copy[i].angle, &copy[i].center, copy[i].flip);
+				}
+				break;
+			}
+
+			case SDL_RENDERCMD_NO_OP:
+				break;
+		}
+
+		cmd = cmd->next;
+	}
 
-	if(alpha != 255)
-		sceGuTexFunc(GU_TFX_REPLACE, GU_TCC_RGBA);
-	return 0;*/
-	return 1;
+	return 0;
 }
 
 static void
@@ -560,6 +1067,13 @@ ORBIS_RenderPresent(SDL_Renderer *renderer)
 	if(!data->displayListAvail)
 		return;
 
+	data->lastBuffer = ORBIS_GetBackBufferIndex();
+	data->lastFrameDamage = data->frameDamage;
+	data->frameDamage.count = 0;
+	data->frameSynced = SDL_FALSE;
+	data->lastPixelsTouched = data->pixelsTouched;
+	data->pixelsTouched = 0;
+
 	orbis2dFinishDrawing(flipArg);
 	orbis2dSwapBuffers();
 	flipArg++;
@@ -579,8 +1093,8 @@ ORBIS_DestroyTexture(SDL_Renderer *renderer, SDL_Texture *texture)
 	if(orbis_texture == 0)
 		return;
 
-	orbis2dDestroyTexture(orbis_texture->tex);
-	SDL_free(orbis_texture);
+	ORBIS_WaitReadPixels(renderdata, orbis_texture->tiles[0].surface.pixels);
+	ORBIS_FreeTextureData(orbis_texture);
 	texture->driverdata = NULL;
 }
 
@@ -594,6 +1108,15 @@ ORBIS_DestroyRenderer(SDL_Renderer *renderer)
 
 	//	orbis2dFinish();
 
+		if (data->readThread) {
+			ORBIS_WaitReadPixels(data, NULL);
+			data->readQuit = SDL_TRUE;
+			SDL_SemPost(data->readStart);
+			SDL_WaitThread(data->readThread, NULL);
+			SDL_DestroySemaphore(data->readStart);
+			SDL_DestroySemaphore(data->readDone);
+		}
+
 		data->initialized = SDL_FALSE;
 		data->displayListAvail = SDL_FALSE;
 		SDL_free(data);
@@ -601,17 +1124,34 @@ ORBIS_DestroyRenderer(SDL_Renderer *renderer)
 	SDL_free(renderer);
 }
 
+Uint64
+SDL_RenderGetORBISPixelsTouched(SDL_Renderer *renderer)
+{
+	ORBIS_RenderData *data;
+
+	if (!renderer || renderer->DestroyRenderer != ORBIS_DestroyRenderer) {
+		SDL_SetError("Renderer is not an ORBIS renderer");
+		return 0;
+	}
+	data = (ORBIS_RenderData *) renderer->driverdata;
+	return data->lastPixelsTouched;
+}
+
 SDL_RenderDriver ORBIS_RenderDriver = {
 	.CreateRenderer = ORBIS_CreateRenderer,
 	.info = {
 		.name = "ORBIS",
-		.flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC,
-		.num_texture_formats = 1,
+		.flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE,
+		.num_texture_formats = 5,
 		.texture_formats = {
 		[0] = SDL_PIXELFORMAT_ARGB8888,
+		[1] = SDL_PIXELFORMAT_ABGR8888,
+		[2] = SDL_PIXELFORMAT_RGBA8888,
+		[3] = SDL_PIXELFORMAT_BGRA8888,
+		[4] = SDL_PIXELFORMAT_RGB565,
 		},
-		.max_texture_width = 1280,
-		.max_texture_height = 720,
+		.max_texture_width = 16384,
+		.max_texture_height = 16384,
 	 }
 };
 #endif /* SDL_VIDEO_RENDER_ORBIS */
@@ -0,0 +1,760 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+/* This file has no orbis2d dependency on purpose; see the header. The host
+   tests in test/ build it with SDL_RENDER_ORBIS_HOST_TEST. */
+#if SDL_VIDEO_RENDER_ORBIS || SDL_RENDER_ORBIS_HOST_TEST
+
+#include "SDL_cpuinfo.h"
+#include "SDL_endian.h"
+#include "SDL_render_orbis_raster.h"
+
+#ifdef __SSE2__
+#define HAVE_SSE2_INTRINSICS 1
+#endif
+
+/* Texel coordinates are stepped in 16.16 fixed point */
+#define FIXED_SHIFT 16
+#define FIXED_ONE   (1 << FIXED_SHIFT)
+
+/* Pixels sampled per pass, so the scratch span can live on the stack */
+#define SPAN_CHUNK  256
+
+/* x / 255 rounded, for x in [0, 255 * 255] */
+#define DIV255(x)   ((((x) + 128) + (((x) + 128) >> 8)) >> 8)
+
+#if HAVE_SSE2_INTRINSICS
+/* DIV255() on eight 16-bit lanes */
+static SDL_INLINE __m128i
+Div255_SSE2(__m128i x)
+{
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+#endif
+
+/* RGB565 texel to opaque ARGB8888 */
+static SDL_INLINE Uint32
+ExpandRGB565(Uint32 p)
+{
+    const Uint32 r = (p >> 11) & 0x1F, g = (p >> 5) & 0x3F, b = p & 0x1F;
+    return 0xFF000000 | (((r << 3) | (r >> 2)) << 16) |
+           (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+
+void
+ORBIS_ConvertTexels(Uint32 *dst, const void *src, int n, ORBIS_TexelFormat format)
+{
+    const Uint32 *src32 = (const Uint32 *) src;
+
+    if (format == ORBIS_TEXEL_ARGB8888) {
+        SDL_memcpy(dst, src, n * sizeof (Uint32));
+        return;
+    }
+
+    if (format == ORBIS_TEXEL_RGB565) {
+        const Uint16 *src16 = (const Uint16 *) src;
+#if HAVE_SSE2_INTRINSICS
+        const __m128i mask5 = _mm_set1_epi16(0x1F);
+        const __m128i mask6 = _mm_set1_epi16(0x3F);
+        const __m128i alpha = _mm_set1_epi16((short) 0xFF00);
+
+        for (; n >= 8; n -= 8, src16 += 8, dst += 8) {
+            const __m128i p = _mm_loadu_si128((const __m128i *) src16);
+            const __m128i r = _mm_srli_epi16(p, 11);
+            const __m128i g = _mm_and_si128(_mm_srli_epi16(p, 5), mask6);
+            const __m128i b = _mm_and_si128(p, mask5);
+            const __m128i r8 = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+            const __m128i g8 = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+            const __m128i b8 = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+            /* B, G then R, A in memory order, interleaved into pixels */
+            const __m128i bg = _mm_or_si128(b8, _mm_slli_epi16(g8, 8));
+            const __m128i ra = _mm_or_si128(r8, alpha);
+            _mm_storeu_si128((__m128i *) dst, _mm_unpacklo_epi16(bg, ra));
+            _mm_storeu_si128((__m128i *) (dst + 4), _mm_unpackhi_epi16(bg, ra));
+        }
+#endif
+        for (; n > 0; --n) {
+            *dst++ = ExpandRGB565(*src16++);
+        }
+        return;
+    }
+
+#if HAVE_SSE2_INTRINSICS
+    {
+        const __m128i ag = _mm_set1_epi32(0xFF00FF00);
+        const __m128i lo = _mm_set1_epi32(0x000000FF);
+
+        for (; n >= 4; n -= 4, src32 += 4, dst += 4) {
+            __m128i p = _mm_loadu_si128((const __m128i *) src32);
+            switch (format) {
+            case ORBIS_TEXEL_ABGR8888:  /* swap R and B */
+                p = _mm_or_si128(_mm_and_si128(p, ag),
+                                 _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 16), lo),
+                                              _mm_slli_epi32(_mm_and_si128(p, lo), 16)));
+                break;
+            case ORBIS_TEXEL_RGBA8888:  /* rotate A to the top */
+                p = _mm_or_si128(_mm_srli_epi32(p, 8), _mm_slli_epi32(p, 24));
+                break;
+            case ORBIS_TEXEL_BGRA8888:  /* reverse the bytes */
+                p = _mm_or_si128(_mm_srli_epi16(p, 8), _mm_slli_epi16(p, 8));
+                p = _mm_shufflehi_epi16(_mm_shufflelo_epi16(p, 0xB1), 0xB1);
+                break;
+            default:
+                break;
+            }
+            _mm_storeu_si128((__m128i *) dst, p);
+        }
+    }
+#endif
+
+    for (; n > 0; --n, ++src32, ++dst) {
+        const Uint32 p = *src32;
+        switch (format) {
+        case ORBIS_TEXEL_ABGR8888:
+            *dst = (p & 0xFF00FF00) | ((p >> 16) & 0xFF) | ((p & 0xFF) << 16);
+            break;
+        case ORBIS_TEXEL_RGBA8888:
+            *dst = (p >> 8) | (p << 24);
+            break;
+        case ORBIS_TEXEL_BGRA8888:
+            *dst = SDL_Swap32(p);
+            break;
+        default:
+            *dst = p;
+            break;
+        }
+    }
+}
+
+/* Fetch 'n' texels along a fixed point walk */
+static void
+SampleSpan(Uint32 *out, int n, const ORBIS_Surface *src,
+           Sint32 u, Sint32 v, Sint32 du, Sint32 dv)
+{
+    const Uint8 *base = (const Uint8 *) src->pixels;
+    int i;
+
+    if (dv == 0) {
+        const Uint32 *row = (const Uint32 *) (base + (v >> FIXED_SHIFT) * src->pitch);
+        if (du == FIXED_ONE) {
+            SDL_memcpy(out, row + (u >> FIXED_SHIFT), n * sizeof (Uint32));
+        } else {
+            for (i = 0; i < n; ++i) {
+                out[i] = row[u >> FIXED_SHIFT];
+                u += du;
+            }
+        }
+    } else {
+        for (i = 0; i < n; ++i) {
+            const Uint32 *row = (const Uint32 *) (base + (v >> FIXED_SHIFT) * src->pitch);
+            out[i] = row[u >> FIXED_SHIFT];
+            u += du;
+            v += dv;
+        }
+    }
+}
+
+static void
+ModulateSpan(Uint32 *pixels, int n, const ORBIS_DrawState *state)
+{
+    const Uint32 r = state->r, g = state->g, b = state->b, a = state->a;
+
+#if HAVE_SSE2_INTRINSICS
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mod = _mm_set_epi16(a, r, g, b, a, r, g, b);
+
+    for (; n >= 4; n -= 4, pixels += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *) pixels);
+        __m128i lo = _mm_unpacklo_epi8(p, zero);
+        __m128i hi = _mm_unpackhi_epi8(p, zero);
+        lo = Div255_SSE2(_mm_mullo_epi16(lo, mod));
+        hi = Div255_SSE2(_mm_mullo_epi16(hi, mod));
+        _mm_storeu_si128((__m128i *) pixels, _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; n > 0; --n, ++pixels) {
+        const Uint32 p = *pixels;
+        *pixels = (DIV255((p >> 24) * a) << 24) |
+                  (DIV255(((p >> 16) & 0xFF) * r) << 16) |
+                  (DIV255(((p >> 8) & 0xFF) * g) << 8) |
+                  DIV255((p & 0xFF) * b);
+    }
+}
+
+/* Copy span kernels, one per blend mode. 'src' is already color modulated. */
+
+/* dstRGB = srcRGB, dstA = srcA */
+static void
+CopySpan_None(Uint32 *dst, const Uint32 *src, int n)
+{
+    SDL_memcpy(dst, src, n * sizeof (Uint32));
+}
+
+/* dstRGB = srcRGB * srcA + dstRGB * (1-srcA), dstA = srcA + dstA * (1-srcA) */
+static void
+CopySpan_Blend(Uint32 *dst, const Uint32 *src, int n)
+{
+#if HAVE_SSE2_INTRINSICS
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i amask = _mm_set1_epi32(0xFF000000);
+    const __m128i alane = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i x255 = _mm_set1_epi16(255);
+
+    for (; n >= 4; n -= 4, src += 4, dst += 4) {
+        const __m128i s = _mm_loadu_si128((const __m128i *) src);
+        const __m128i sa = _mm_and_si128(s, amask);
+        __m128i slo, shi, dlo, dhi, alo, ahi, d;
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(sa, amask)) == 0xFFFF) {
+            _mm_storeu_si128((__m128i *) dst, s);   /* all opaque */
+            continue;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(sa, zero)) == 0xFFFF) {
+            continue;   /* all transparent */
+        }
+
+        d = _mm_loadu_si128((const __m128i *) dst);
+        slo = _mm_unpacklo_epi8(s, zero);
+        shi = _mm_unpackhi_epi8(s, zero);
+        dlo = _mm_unpacklo_epi8(d, zero);
+        dhi = _mm_unpackhi_epi8(d, zero);
+        alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(slo, 0xFF), 0xFF);
+        ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(shi, 0xFF), 0xFF);
+
+        /* Treating source alpha as 255 in the alpha lane gives
+           srcA + dstA * (1-srcA) from the same expression */
+        slo = _mm_or_si128(slo, alane);
+        shi = _mm_or_si128(shi, alane);
+
+        slo = Div255_SSE2(_mm_add_epi16(_mm_mullo_epi16(slo, alo),
+                                        _mm_mullo_epi16(dlo, _mm_sub_epi16(x255, alo))));
+        shi = Div255_SSE2(_mm_add_epi16(_mm_mullo_epi16(shi, ahi),
+                                        _mm_mullo_epi16(dhi, _mm_sub_epi16(x255, ahi))));
+        _mm_storeu_si128((__m128i *) dst, _mm_packus_epi16(slo, shi));
+    }
+#endif
+
+    for (; n > 0; --n, ++src, ++dst) {
+        const Uint32 s = *src;
+        const Uint32 sa = s >> 24;
+        const Uint32 d = *dst;
+        Uint32 inva;
+
+        if (sa == 0xFF) {
+            *dst = s;
+            continue;
+        } else if (sa == 0) {
+            continue;
+        }
+
+        inva = 0xFF - sa;
+        *dst = (DIV255(0xFF * sa + (d >> 24) * inva) << 24) |
+               (DIV255(((s >> 16) & 0xFF) * sa + ((d >> 16) & 0xFF) * inva) << 16) |
+               (DIV255(((s >> 8) & 0xFF) * sa + ((d >> 8) & 0xFF) * inva) << 8) |
+               DIV255((s & 0xFF) * sa + (d & 0xFF) * inva);
+    }
+}
+
+/* dstRGB = srcRGB * srcA + dstRGB, dstA = dstA */
+static void
+CopySpan_Add(Uint32 *dst, const Uint32 *src, int n)
+{
+#if HAVE_SSE2_INTRINSICS
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgbmask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+
+    for (; n >= 4; n -= 4, src += 4, dst += 4) {
+        const __m128i s = _mm_loadu_si128((const __m128i *) src);
+        const __m128i d = _mm_loadu_si128((const __m128i *) dst);
+        __m128i slo = _mm_unpacklo_epi8(s, zero);
+        __m128i shi = _mm_unpackhi_epi8(s, zero);
+        /* Zero alpha factor in the alpha lane keeps dstA */
+        const __m128i alo = _mm_and_si128(_mm_shufflehi_epi16(_mm_shufflelo_epi16(slo, 0xFF), 0xFF), rgbmask);
+        const __m128i ahi = _mm_and_si128(_mm_shufflehi_epi16(_mm_shufflelo_epi16(shi, 0xFF), 0xFF), rgbmask);
+
+        slo = Div255_SSE2(_mm_mullo_epi16(slo, alo));
+        shi = Div255_SSE2(_mm_mullo_epi16(shi, ahi));
+        _mm_storeu_si128((__m128i *) dst, _mm_adds_epu8(d, _mm_packus_epi16(slo, shi)));
+    }
+#endif
+
+    for (; n > 0; --n, ++src, ++dst) {
+        const Uint32 s = *src;
+        const Uint32 sa = s >> 24;
+        const Uint32 d = *dst;
+        Uint32 r, g, b;
+
+        r = ((d >> 16) & 0xFF) + DIV255(((s >> 16) & 0xFF) * sa);
+        g = ((d >> 8) & 0xFF) + DIV255(((s >> 8) & 0xFF) * sa);
+        b = (d & 0xFF) + DIV255((s & 0xFF) * sa);
+        *dst = (d & 0xFF000000) |
+               (SDL_min(r, 0xFF) << 16) | (SDL_min(g, 0xFF) << 8) | SDL_min(b, 0xFF);
+    }
+}
+
+/* dstRGB = srcRGB * dstRGB, dstA = dstA */
+static void
+CopySpan_Mod(Uint32 *dst, const Uint32 *src, int n)
+{
+#if HAVE_SSE2_INTRINSICS
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alane = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+    for (; n >= 4; n -= 4, src += 4, dst += 4) {
+        const __m128i s = _mm_loadu_si128((const __m128i *) src);
+        const __m128i d = _mm_loadu_si128((const __m128i *) dst);
+        /* Source alpha forced to 255 so dstA * 255 / 255 leaves dstA as is */
+        const __m128i slo = _mm_or_si128(_mm_unpacklo_epi8(s, zero), alane);
+        const __m128i shi = _mm_or_si128(_mm_unpackhi_epi8(s, zero), alane);
+        const __m128i dlo = Div255_SSE2(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), slo));
+        const __m128i dhi = Div255_SSE2(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), shi));
+        _mm_storeu_si128((__m128i *) dst, _mm_packus_epi16(dlo, dhi));
+    }
+#endif
+
+    for (; n > 0; --n, ++src, ++dst) {
+        const Uint32 s = *src;
+        const Uint32 d = *dst;
+
+        *dst = (d & 0xFF000000) |
+               (DIV255(((s >> 16) & 0xFF) * ((d >> 16) & 0xFF)) << 16) |
+               (DIV255(((s >> 8) & 0xFF) * ((d >> 8) & 0xFF)) << 8) |
+               DIV255((s & 0xFF) * (d & 0xFF));
+    }
+}
+
+ORBIS_CopySpanFunc
+ORBIS_GetCopySpanFunc(SDL_BlendMode blendMode)
+{
+    switch (blendMode) {
+    case SDL_BLENDMODE_BLEND:
+        return CopySpan_Blend;
+    case SDL_BLENDMODE_ADD:
+        return CopySpan_Add;
+    case SDL_BLENDMODE_MOD:
+        return CopySpan_Mod;
+    default:
+        return CopySpan_None;
+    }
+}
+
+/* Fill span kernels, one per blend mode, with the same equations as the
+   copy kernels for a constant source color */
+
+static void
+FillSpan_None(Uint32 *dst, Uint32 color, int n)
+{
+#if HAVE_SSE2_INTRINSICS
+    const __m128i c = _mm_set1_epi32((int) color);
+
+    /* Align so the bulk of a long span uses aligned stores */
+    for (; n > 0 && ((uintptr_t) dst & 15) != 0; --n) {
+        *dst++ = color;
+    }
+    for (; n >= 8; n -= 8, dst += 8) {
+        _mm_store_si128((__m128i *) dst, c);
+        _mm_store_si128((__m128i *) (dst + 4), c);
+    }
+#endif
+
+    for (; n > 0; --n) {
+        *dst++ = color;
+    }
+}
+
+static void
+FillSpan_Blend(Uint32 *dst, Uint32 color, int n)
+{
+    const Uint32 a = color >> 24;
+    const Uint32 inva = 0xFF - a;
+    /* Source terms of the equation are the same for every pixel */
+    const Uint32 sa = 0xFF * a;
+    const Uint32 sr = ((color >> 16) & 0xFF) * a;
+    const Uint32 sg = ((color >> 8) & 0xFF) * a;
+    const Uint32 sb = (color & 0xFF) * a;
+
+    if (a == 0xFF) {
+        FillSpan_None(dst, color, n);
+        return;
+    } else if (a == 0) {
+        return;
+    }
+
+#if HAVE_SSE2_INTRINSICS
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i s = _mm_set_epi16(sa, sr, sg, sb, sa, sr, sg, sb);
+        const __m128i ia = _mm_set1_epi16(inva);
+
+        for (; n >= 4; n -= 4, dst += 4) {
+            const __m128i d = _mm_loadu_si128((const __m128i *) dst);
+            const __m128i lo = Div255_SSE2(_mm_add_epi16(s, _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), ia)));
+            const __m128i hi = Div255_SSE2(_mm_add_epi16(s, _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), ia)));
+            _mm_storeu_si128((__m128i *) dst, _mm_packus_epi16(lo, hi));
+        }
+    }
+#endif
+
+    for (; n > 0; --n, ++dst) {
+        const Uint32 d = *dst;
+        *dst = (DIV255(sa + (d >> 24) * inva) << 24) |
+               (DIV255(sr + ((d >> 16) & 0xFF) * inva) << 16) |
+               (DIV255(sg + ((d >> 8) & 0xFF) * inva) << 8) |
+               DIV255(sb + (d & 0xFF) * inva);
+    }
+}
+
+static void
+FillSpan_Add(Uint32 *dst, Uint32 color, int n)
+{
+    const Uint32 a = color >> 24;
+    const Uint32 r = DIV255(((color >> 16) & 0xFF) * a);
+    const Uint32 g = DIV255(((color >> 8) & 0xFF) * a);
+    const Uint32 b = DIV255((color & 0xFF) * a);
+
+    if ((r | g | b) == 0) {
+        return;
+    }
+
+#if HAVE_SSE2_INTRINSICS
+    {
+        const __m128i add = _mm_set1_epi32((int) ((r << 16) | (g << 8) | b));
+
+        for (; n >= 4; n -= 4, dst += 4) {
+            const __m128i d = _mm_loadu_si128((const __m128i *) dst);
+            _mm_storeu_si128((__m128i *) dst, _mm_adds_epu8(d, add));
+        }
+    }
+#endif
+
+    for (; n > 0; --n, ++dst) {
+        const Uint32 d = *dst;
+        const Uint32 dr = ((d >> 16) & 0xFF) + r;
+        const Uint32 dg = ((d >> 8) & 0xFF) + g;
+        const Uint32 db = (d & 0xFF) + b;
+        *dst = (d & 0xFF000000) |
+               (SDL_min(dr, 0xFF) << 16) | (SDL_min(dg, 0xFF) << 8) | SDL_min(db, 0xFF);
+    }
+}
+
+static void
+FillSpan_Mod(Uint32 *dst, Uint32 color, int n)
+{
+    const Uint32 r = (color >> 16) & 0xFF;
+    const Uint32 g = (color >> 8) & 0xFF;
+    const Uint32 b = color & 0xFF;
+
+    if ((r & g & b) == 0xFF) {
+        return;
+    }
+
+#if HAVE_SSE2_INTRINSICS
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i mod = _mm_set_epi16(255, r, g, b, 255, r, g, b);
+
+        for (; n >= 4; n -= 4, dst += 4) {
+            const __m128i d = _mm_loadu_si128((const __m128i *) dst);
+            const __m128i lo = Div255_SSE2(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), mod));
+            const __m128i hi = Div255_SSE2(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), mod));
+            _mm_storeu_si128((__m128i *) dst, _mm_packus_epi16(lo, hi));
+        }
+    }
+#endif
+
+    for (; n > 0; --n, ++dst) {
+        const Uint32 d = *dst;
+        *dst = (d & 0xFF000000) |
+               (DIV255(r * ((d >> 16) & 0xFF)) << 16) |
+               (DIV255(g * ((d >> 8) & 0xFF)) << 8) |
+               DIV255(b * (d & 0xFF));
+    }
+}
+
+ORBIS_FillSpanFunc
+ORBIS_GetFillSpanFunc(SDL_BlendMode blendMode)
+{
+    switch (blendMode) {
+    case SDL_BLENDMODE_BLEND:
+        return FillSpan_Blend;
+    case SDL_BLENDMODE_ADD:
+        return FillSpan_Add;
+    case SDL_BLENDMODE_MOD:
+        return FillSpan_Mod;
+    default:
+        return FillSpan_None;
+    }
+}
+
+/* Narrow [*k0, *k1) to the steps k where lo <= start + k * step < hi */
+static void
+ClipSpanRange(double start, double step, double lo, double hi, int *k0, int *k1)
+{
+    double t0, t1;
+
+    if (step == 0.0) {
+        if (start < lo || start >= hi) {
+            *k1 = *k0;
+        }
+        return;
+    }
+
+    t0 = (lo - start) / step;
+    t1 = (hi - start) / step;
+    if (t0 > t1) {
+        double tmp = t0;
+        t0 = t1;
+        t1 = tmp;
+    }
+    /* a step near zero puts t0/t1 far outside int range; keep them in
+       [*k0, *k1] before converting */
+    t0 = SDL_min(SDL_max(t0, (double) *k0), (double) *k1);
+    t1 = SDL_min(SDL_max(t1, (double) *k0), (double) *k1);
+    *k0 = (int) SDL_ceil(t0);
+    *k1 = (int) SDL_ceil(t1);
+}
+
+/* Whether step k of a fixed point walk lands inside [lo, hi) texels */
+static SDL_INLINE SDL_bool
+FixedInside(Sint32 start, Sint32 step, int k, int lo, int hi)
+{
+    const int t = (start + k * step) >> FIXED_SHIFT;
+    return (t >= lo && t < hi);
+}
+
+/* Draw the part of one destination row, 'u'/'v' at its first pixel,
+   whose texels fall inside 'texels' of 'tile' */
+static void
+CopyTileSpan(Uint32 *row, int w, const ORBIS_Tile *tile, const SDL_Rect *texels,
+             double u, double v, double dudx, double dvdx,
+             Sint32 fu, Sint32 fv, Sint32 du, Sint32 dv,
+             const ORBIS_DrawState *state, SDL_bool modulate)
+{
+    Uint32 scratch[SPAN_CHUNK];
+    const int x0 = texels->x, x1 = texels->x + texels->w;
+    const int y0 = texels->y, y1 = texels->y + texels->h;
+    int k0 = 0, k1 = w;
+
+    ClipSpanRange(u, dudx, x0, x1, &k0, &k1);
+    ClipSpanRange(v, dvdx, y0, y1, &k0, &k1);
+    k0 = SDL_max(k0, 0);
+    k1 = SDL_min(k1, w);
+
+    /* Rounding in the float solve can be off by a pixel either way */
+    while (k0 < k1 && !(FixedInside(fu, du, k0, x0, x1) && FixedInside(fv, dv, k0, y0, y1))) {
+        ++k0;
+    }
+    while (k0 > 0 && FixedInside(fu, du, k0 - 1, x0, x1) && FixedInside(fv, dv, k0 - 1, y0, y1)) {
+        --k0;
+    }
+    while (k1 > k0 && !(FixedInside(fu, du, k1 - 1, x0, x1) && FixedInside(fv, dv, k1 - 1, y0, y1))) {
+        --k1;
+    }
+    while (k1 < w && FixedInside(fu, du, k1, x0, x1) && FixedInside(fv, dv, k1, y0, y1)) {
+        ++k1;
+    }
+    if (k0 >= k1) {
+        return;
+    }
+
+    /* Walk in tile local texel coordinates from here on */
+    row += k0;
+    fu += k0 * du - (tile->x << FIXED_SHIFT);
+    fv += k0 * dv - (tile->y << FIXED_SHIFT);
+    k1 -= k0;
+    while (k1 > 0) {
+        const int n = SDL_min(k1, SPAN_CHUNK);
+        SampleSpan(scratch, n, &tile->surface, fu, fv, du, dv);
+        if (modulate) {
+            ModulateSpan(scratch, n, state);
+        }
+        state->copyspan(row, scratch, n);
+        fu += n * du;
+        fv += n * dv;
+        row += n;
+        k1 -= n;
+    }
+}
+
+void
+ORBIS_RasterCopyEx(const ORBIS_Surface *dst, const SDL_Rect *cliprect,
+                   const ORBIS_Tile *tiles, int numtiles, const SDL_Rect *srcrect,
+                   const SDL_FRect *dstrect, const ORBIS_DrawState *state,
+                   double angle, const SDL_FPoint *center,
+                   SDL_RendererFlip flip, SDL_Rect *drawn)
+{
+    const SDL_bool modulate = (state->r & state->g & state->b & state->a) != 0xFF;
+    const double rad = angle * M_PI / 180.0;
+    const double c = SDL_cos(rad), s = SDL_sin(rad);
+    const double sx = (double) srcrect->w / dstrect->w;
+    const double sy = (double) srcrect->h / dstrect->h;
+    const double fh = (flip & SDL_FLIP_HORIZONTAL) ? -1.0 : 1.0;
+    const double fv = (flip & SDL_FLIP_VERTICAL) ? -1.0 : 1.0;
+    const double px = dstrect->x + center->x;
+    const double py = dstrect->y + center->y;
+    double dudx, dudy, dvdx, dvdy, u00, v00;
+    double minx, miny, maxx, maxy;
+    SDL_Rect bounds, box;
+    Sint32 du, dv;
+    int i, t, y;
+
+    if (drawn) {
+        SDL_zerop(drawn);
+    }
+    if (dstrect->w <= 0.0f || dstrect->h <= 0.0f || srcrect->w <= 0 || srcrect->h <= 0) {
+        return;
+    }
+
+    /* Screen space bounding box of the rotated quad */
+    minx = miny = 1e30;
+    maxx = maxy = -1e30;
+    for (i = 0; i < 4; ++i) {
+        const double lx = ((i & 1) ? dstrect->w : 0.0) - center->x;
+        const double ly = ((i & 2) ? dstrect->h : 0.0) - center->y;
+        const double x = px + lx * c - ly * s;
+        const double y = py + lx * s + ly * c;
+        minx = SDL_min(minx, x);
+        maxx = SDL_max(maxx, x);
+        miny = SDL_min(miny, y);
+        maxy = SDL_max(maxy, y);
+    }
+    box.x = (int) SDL_floor(minx);
+    box.y = (int) SDL_floor(miny);
+    box.w = (int) SDL_ceil(maxx) - box.x;
+    box.h = (int) SDL_ceil(maxy) - box.y;
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = dst->w;
+    bounds.h = dst->h;
+    if (cliprect && !SDL_IntersectRect(&bounds, cliprect, &bounds)) {
+        return;
+    }
+    if (!SDL_IntersectRect(&box, &bounds, &box)) {
+        return;
+    }
+    if (drawn) {
+        *drawn = box;
+    }
+
+    /* The texel hit by screen point (x, y) is an affine function of it:
+         u = u00 + x * dudx + y * dudy,  v = v00 + x * dvdx + y * dvdy
+       Undo the rotation around the pivot, the flip and the scale. */
+    dudx = fh * c * sx;
+    dudy = fh * s * sx;
+    dvdx = -fv * s * sy;
+    dvdy = fv * c * sy;
+    u00 = srcrect->x + sx * ((fh < 0.0) ? dstrect->w : 0.0) +
+          fh * sx * (center->x - (px * c + py * s));
+    v00 = srcrect->y + sy * ((fv < 0.0) ? dstrect->h : 0.0) +
+          fv * sy * (center->y - (-px * s + py * c));
+
+    du = (Sint32) (dudx * FIXED_ONE);
+    dv = (Sint32) (dvdx * FIXED_ONE);
+
+    for (y = box.y; y < box.y + box.h; ++y) {
+        const double cx = box.x + 0.5, cy = y + 0.5;
+        const double u = u00 + cx * dudx + cy * dudy;
+        const double v = v00 + cx * dvdx + cy * dvdy;
+        const Sint32 fu = (Sint32) SDL_floor(u * FIXED_ONE);
+        const Sint32 fv0 = (Sint32) SDL_floor(v * FIXED_ONE);
+        Uint32 *row = (Uint32 *) ((Uint8 *) dst->pixels + y * dst->pitch) + box.x;
+
+        /* Every pixel maps to a single texel, so tiles never overlap or
+           leave seams between them */
+        for (t = 0; t < numtiles; ++t) {
+            SDL_Rect texels;
+
+            texels.x = tiles[t].x;
+            texels.y = tiles[t].y;
+            texels.w = tiles[t].surface.w;
+            texels.h = tiles[t].surface.h;
+            if (SDL_IntersectRect(&texels, srcrect, &texels)) {
+                CopyTileSpan(row, box.w, &tiles[t], &texels, u, v, dudx, dvdx,
+                             fu, fv0, du, dv, state, modulate);
+            }
+        }
+    }
+}
+
+void
+ORBIS_RasterCopy(const ORBIS_Surface *dst, const SDL_Rect *cliprect,
+                 const ORBIS_Tile *tiles, int numtiles, const SDL_Rect *srcrect,
+                 const SDL_FRect *dstrect, const ORBIS_DrawState *state,
+                 SDL_Rect *drawn)
+{
+    SDL_FPoint center;
+
+    center.x = 0.0f;
+    center.y = 0.0f;
+    ORBIS_RasterCopyEx(dst, cliprect, tiles, numtiles, srcrect, dstrect, state, 0.0, &center, SDL_FLIP_NONE, drawn);
+}
+
+void
+ORBIS_RasterFillRect(const ORBIS_Surface *dst, const SDL_Rect *rect,
+                     Uint32 color, ORBIS_FillSpanFunc fillspan)
+{
+    Uint8 *row = (Uint8 *) dst->pixels + rect->y * dst->pitch + rect->x * 4;
+    int y;
+
+    for (y = 0; y < rect->h; ++y, row += dst->pitch) {
+        fillspan((Uint32 *) row, color, rect->w);
+    }
+}
+
+void
+ORBIS_RasterDrawLine(const ORBIS_Surface *dst, int x1, int y1, int x2, int y2,
+                     Uint32 color, ORBIS_FillSpanFunc fillspan)
+{
+    const int dx = SDL_abs(x2 - x1), dy = SDL_abs(y2 - y1);
+    const int sx = (x1 < x2) ? 1 : -1, sy = (y1 < y2) ? 1 : -1;
+    int err = dx - dy;
+
+    if (dy == 0) {
+        Uint32 *row = (Uint32 *) ((Uint8 *) dst->pixels + y1 * dst->pitch);
+        fillspan(row + SDL_min(x1, x2), color, dx + 1);
+        return;
+    }
+
+    /* Bresenham, with the kernel called once per pixel */
+    for (;;) {
+        const int e2 = 2 * err;
+        fillspan((Uint32 *) ((Uint8 *) dst->pixels + y1 * dst->pitch) + x1, color, 1);
+        if (x1 == x2 && y1 == y2) {
+            break;
+        }
+        if (e2 > -dy) {
+            err -= dy;
+            x1 += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y1 += sy;
+        }
+    }
+}
+
+#endif /* SDL_VIDEO_RENDER_ORBIS || SDL_RENDER_ORBIS_HOST_TEST */
+
+/* vi: set ts=4 sw=4 expandtab: */
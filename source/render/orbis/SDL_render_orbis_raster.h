@@ -0,0 +1,108 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDL_render_orbis_raster_h_
+#define SDL_render_orbis_raster_h_
+
+#include "../../SDL_internal.h"
+#include "../SDL_sysrender.h"
+
+/* CPU rasterizer used by the ORBIS renderer.
+
+   It only draws to ARGB8888 memory, so the same code draws into the
+   orbis2d back buffer, into textures, or into a plain malloc'd buffer.
+ */
+
+/* Pixel layouts textures can be uploaded in. Textures are stored as
+   ARGB8888, the only layout the rasterizer reads, so uploads in any other
+   layout are converted once, by ORBIS_ConvertTexels(). */
+typedef enum
+{
+    ORBIS_TEXEL_ARGB8888,
+    ORBIS_TEXEL_ABGR8888,
+    ORBIS_TEXEL_RGBA8888,
+    ORBIS_TEXEL_BGRA8888,
+    ORBIS_TEXEL_RGB565
+} ORBIS_TexelFormat;
+
+/* An ARGB8888 pixel buffer */
+typedef struct
+{
+    Uint32 *pixels;
+    int w;
+    int h;
+    int pitch;                  /* in bytes */
+} ORBIS_Surface;
+
+/* Part of a texture; its texel (0, 0) is texel (x, y) of the texture */
+typedef struct
+{
+    ORBIS_Surface surface;
+    int x;
+    int y;
+} ORBIS_Tile;
+
+/* Convert 'n' texels of 'format' at 'src' to ARGB8888 at 'dst' */
+extern void ORBIS_ConvertTexels(Uint32 *dst, const void *src, int n, ORBIS_TexelFormat format);
+
+/* Span kernels. Each one implements a single blend mode, so the blend
+   mode is resolved once per batch instead of once per pixel. */
+typedef void (*ORBIS_CopySpanFunc)(Uint32 *dst, const Uint32 *src, int n);
+typedef void (*ORBIS_FillSpanFunc)(Uint32 *dst, Uint32 color, int n);
+
+extern ORBIS_CopySpanFunc ORBIS_GetCopySpanFunc(SDL_BlendMode blendMode);
+extern ORBIS_FillSpanFunc ORBIS_GetFillSpanFunc(SDL_BlendMode blendMode);
+
+/* Color/alpha modulation and blend kernel of a draw */
+typedef struct
+{
+    Uint8 r, g, b, a;
+    ORBIS_CopySpanFunc copyspan;
+} ORBIS_DrawState;
+
+/* Copy 'srcrect' of a texture made of 'numtiles' tiles scaled to 'dstrect',
+   clipped to 'cliprect'.
+   If 'drawn' is not NULL it receives the bounding box of the pixels that
+   may have been written, empty if none were. */
+extern void ORBIS_RasterCopy(const ORBIS_Surface *dst, const SDL_Rect *cliprect,
+                             const ORBIS_Tile *tiles, int numtiles, const SDL_Rect *srcrect,
+                             const SDL_FRect *dstrect, const ORBIS_DrawState *state,
+                             SDL_Rect *drawn);
+
+/* Same as ORBIS_RasterCopy(), rotated 'angle' degrees clockwise around
+   'center' (relative to dstrect) and optionally flipped */
+extern void ORBIS_RasterCopyEx(const ORBIS_Surface *dst, const SDL_Rect *cliprect,
+                               const ORBIS_Tile *tiles, int numtiles, const SDL_Rect *srcrect,
+                               const SDL_FRect *dstrect, const ORBIS_DrawState *state,
+                               double angle, const SDL_FPoint *center,
+                               SDL_RendererFlip flip, SDL_Rect *drawn);
+
+/* Fill 'rect', which must already be clipped to 'dst', with 'color' */
+extern void ORBIS_RasterFillRect(const ORBIS_Surface *dst, const SDL_Rect *rect,
+                                 Uint32 color, ORBIS_FillSpanFunc fillspan);
+
+/* Draw a line between two points inside 'dst', both ends included */
+extern void ORBIS_RasterDrawLine(const ORBIS_Surface *dst, int x1, int y1, int x2, int y2,
+                                 Uint32 color, ORBIS_FillSpanFunc fillspan);
+
+#endif /* SDL_render_orbis_raster_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -5268,6 +5268,160 @@ static struct
     real_malloc, real_calloc, real_realloc, real_free, { 0 }
 };
 
+/* Every block handed out by SDL_malloc() starts with a small header that
+   says which size class it belongs to.  Blocks of the small classes are
+   kept in per-thread caches when freed and reused by the next allocation
+   of the same class on that thread, so the common small allocations don't
+   go through the global allocator, and its lock, every time.  A block
+   freed on another thread than the one that allocated it simply goes into
+   the freeing thread's cache.  Because of the header, SDL_malloc() memory
+   can only be released with SDL_free().
+ */
+#if defined(__ORBIS__)
+#include <kernel.h>
+#define SDL_MEM_THREAD_CACHE 1
+typedef ScePthreadKey SDL_MemCacheKey;
+#define SDL_MemCacheKeyCreate(key, destructor) (scePthreadKeyCreate(key, destructor) == 0)
+#define SDL_MemCacheKeyGet(key) scePthreadGetspecific(key)
+#define SDL_MemCacheKeySet(key, value) scePthreadSetspecific(key, value)
+#elif SDL_THREAD_PTHREAD || SDL_THREAD_ORBIS
+/* Off the console the ORBIS thread backend builds on pthreads */
+#include <pthread.h>
+#define SDL_MEM_THREAD_CACHE 1
+typedef pthread_key_t SDL_MemCacheKey;
+#define SDL_MemCacheKeyCreate(key, destructor) (pthread_key_create(key, destructor) == 0)
+#define SDL_MemCacheKeyGet(key) pthread_getspecific(key)
+#define SDL_MemCacheKeySet(key, value) pthread_setspecific(key, value)
+#else
+#define SDL_MEM_THREAD_CACHE 0
+#endif
+
+/* 16 bytes keeps the alignment the system allocator gives us */
+#define SDL_MEM_HEADER_SIZE 16
+#define SDL_MEM_LARGE ((size_t)-1)
+
+#define SDL_MemHeader(ptr) ((size_t *)((Uint8 *)(ptr) - SDL_MEM_HEADER_SIZE))
+#define SDL_MemBase(header) ((void *)(header))
+#define SDL_MemData(header) ((void *)((Uint8 *)(header) + SDL_MEM_HEADER_SIZE))
+
+static const size_t SDL_mem_class_sizes[] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048
+};
+#define SDL_MEM_NUM_CLASSES SDL_arraysize(SDL_mem_class_sizes)
+
+/* Each class caches up to this many bytes per thread, at least 4 blocks */
+#define SDL_MEM_CACHE_BYTES (32 * 1024)
+
+static size_t
+SDL_MemSizeClass(size_t size)
+{
+    size_t i;
+
+    if (size <= 64) {
+        return (size - 1) / 16;
+    }
+    for (i = 4; i < SDL_MEM_NUM_CLASSES; ++i) {
+        if (size <= SDL_mem_class_sizes[i]) {
+            return i;
+        }
+    }
+    return SDL_MEM_LARGE;
+}
+
+#if SDL_MEM_THREAD_CACHE
+
+typedef struct SDL_MemCache
+{
+    void *blocks[SDL_MEM_NUM_CLASSES];  /* linked through their first word */
+    int count[SDL_MEM_NUM_CLASSES];
+    SDL_free_func free_func;            /* releases the blocks and the cache */
+} SDL_MemCache;
+
+static SDL_MemCacheKey SDL_mem_cache_key;
+static SDL_atomic_t SDL_mem_cache_state;    /* 0: none, 1: creating, 2: ready, 3: failed */
+
+static int
+SDL_MemCacheLimit(size_t size_class)
+{
+    return SDL_max(4, (int)(SDL_MEM_CACHE_BYTES / SDL_mem_class_sizes[size_class]));
+}
+
+/* Give cached blocks of a class back to the allocator, keeping 'keep' */
+static void
+SDL_TrimMemCache(SDL_MemCache *cache, size_t size_class, int keep)
+{
+    while (cache->count[size_class] > keep) {
+        void *block = cache->blocks[size_class];
+        cache->blocks[size_class] = *(void **)SDL_MemData(block);
+        --cache->count[size_class];
+        cache->free_func(SDL_MemBase(block));
+    }
+}
+
+static void
+SDL_FlushMemCache(SDL_MemCache *cache)
+{
+    size_t i;
+
+    for (i = 0; i < SDL_MEM_NUM_CLASSES; ++i) {
+        SDL_TrimMemCache(cache, i, 0);
+    }
+}
+
+static void
+SDL_DestroyMemCache(void *data)
+{
+    SDL_MemCache *cache = (SDL_MemCache *)data;
+
+    SDL_MemCacheKeySet(SDL_mem_cache_key, NULL);
+    SDL_FlushMemCache(cache);
+    cache->free_func(cache);
+}
+
+static SDL_MemCache *
+SDL_GetMemCache(SDL_bool create)
+{
+    SDL_MemCache *cache;
+    int state = SDL_AtomicGet(&SDL_mem_cache_state);
+
+    if (state != 2) {
+        if (state == 0 && SDL_AtomicCAS(&SDL_mem_cache_state, 0, 1)) {
+            if (SDL_MemCacheKeyCreate(&SDL_mem_cache_key, SDL_DestroyMemCache)) {
+                SDL_AtomicSet(&SDL_mem_cache_state, 2);
+            } else {
+                SDL_AtomicSet(&SDL_mem_cache_state, 3);
+            }
+        }
+        while ((state = SDL_AtomicGet(&SDL_mem_cache_state)) == 1) {
+            /* Another thread is creating the key */
+        }
+        if (state != 2) {
+            return NULL;
+        }
+    }
+
+    cache = (SDL_MemCache *)SDL_MemCacheKeyGet(SDL_mem_cache_key);
+    if (cache && cache->free_func != s_mem.free_func) {
+        /* The memory functions were replaced since this thread filled its
+           cache, give everything back to the ones it came from */
+        SDL_DestroyMemCache(cache);
+        cache = NULL;
+    }
+    if (!cache && create) {
+        cache = (SDL_MemCache *)s_mem.calloc_func(1, sizeof(*cache));
+        if (cache) {
+            cache->free_func = s_mem.free_func;
+            if (SDL_MemCacheKeySet(SDL_mem_cache_key, cache) != 0) {
+                s_mem.free_func(cache);
+                cache = NULL;
+            }
+        }
+    }
+    return cache;
+}
+
+#endif /* SDL_MEM_THREAD_CACHE */
+
 void SDL_GetMemoryFunctions(SDL_malloc_func *malloc_func,
                             SDL_calloc_func *calloc_func,
                             SDL_realloc_func *realloc_func,
@@ -5309,6 +5463,13 @@ int SDL_SetMemoryFunctions(SDL_malloc_func malloc_func,
     s_mem.calloc_func = calloc_func;
     s_mem.realloc_func = realloc_func;
     s_mem.free_func = free_func;
+
+#if SDL_MEM_THREAD_CACHE
+    /* Cached blocks belong to the old functions.  Looking at our cache
+       gives ours back now, other threads do the same the next time they
+       use theirs. */
+    SDL_GetMemCache(SDL_FALSE);
+#endif
     return 0;
 }
 
@@ -5317,6 +5478,80 @@ int SDL_GetNumAllocations(void)
     return SDL_AtomicGet(&s_mem.num_allocations);
 }
 
+static void *
+SDL_AllocBlock(size_t size, SDL_bool zero)
+{
+    size_t size_class;
+    size_t *header;
+
+    if (size > (~(size_t)0 - SDL_MEM_HEADER_SIZE)) {
+        return NULL;
+    }
+
+    size_class = SDL_MemSizeClass(size);
+    if (size_class == SDL_MEM_LARGE) {
+        if (zero) {
+            header = (size_t *)s_mem.calloc_func(1, SDL_MEM_HEADER_SIZE + size);
+        } else {
+            header = (size_t *)s_mem.malloc_func(SDL_MEM_HEADER_SIZE + size);
+        }
+        if (!header) {
+            return NULL;
+        }
+        *header = SDL_MEM_LARGE;
+        return SDL_MemData(header);
+    }
+
+#if SDL_MEM_THREAD_CACHE
+    {
+        SDL_MemCache *cache = SDL_GetMemCache(SDL_FALSE);
+        if (cache && cache->blocks[size_class]) {
+            header = (size_t *)cache->blocks[size_class];
+            cache->blocks[size_class] = *(void **)SDL_MemData(header);
+            --cache->count[size_class];
+            if (zero) {
+                SDL_memset(SDL_MemData(header), 0, size);
+            }
+            return SDL_MemData(header);
+        }
+    }
+#endif
+
+    if (zero) {
+        header = (size_t *)s_mem.calloc_func(1, SDL_MEM_HEADER_SIZE + SDL_mem_class_sizes[size_class]);
+    } else {
+        header = (size_t *)s_mem.malloc_func(SDL_MEM_HEADER_SIZE + SDL_mem_class_sizes[size_class]);
+    }
+    if (!header) {
+        return NULL;
+    }
+    *header = size_class;
+    return SDL_MemData(header);
+}
+
+static void
+SDL_FreeBlock(void *ptr)
+{
+    size_t *header = SDL_MemHeader(ptr);
+
+#if SDL_MEM_THREAD_CACHE
+    const size_t size_class = *header;
+
+    if (size_class != SDL_MEM_LARGE) {
+        SDL_MemCache *cache = SDL_GetMemCache(SDL_TRUE);
+        if (cache) {
+            *(void **)ptr = cache->blocks[size_class];
+            cache->blocks[size_class] = header;
+            if (++cache->count[size_class] > SDL_MemCacheLimit(size_class)) {
+                SDL_TrimMemCache(cache, size_class, SDL_MemCacheLimit(size_class) / 2);
+            }
+            return;
+        }
+    }
+#endif
+    s_mem.free_func(SDL_MemBase(header));
+}
+
 void *SDL_malloc(size_t size)
 {
     void *mem;
@@ -5325,7 +5560,7 @@ void *SDL_malloc(size_t size)
         size = 1;
     }
 
-    mem = s_mem.malloc_func(size);
+    mem = SDL_AllocBlock(size, SDL_FALSE);
     if (mem) {
         SDL_AtomicIncRef(&s_mem.num_allocations);
     }
@@ -5340,8 +5575,11 @@ void *SDL_calloc(size_t nmemb, size_t size)
         nmemb = 1;
         size = 1;
     }
+    if (size > (~(size_t)0 / nmemb)) {
+        return NULL;
+    }
 
-    mem = s_mem.calloc_func(nmemb, size);
+    mem = SDL_AllocBlock(nmemb * size, SDL_TRUE);
     if (mem) {
         SDL_AtomicIncRef(&s_mem.num_allocations);
     }
@@ -5350,17 +5588,38 @@ void *SDL_calloc(size_t nmemb, size_t size)
 
 void *SDL_realloc(void *ptr, size_t size)
 {
+    size_t *header;
     void *mem;
 
-    if (!ptr && !size) {
+    if (!ptr) {
+        return SDL_malloc(size);
+    }
+    if (!size) {
         size = 1;
     }
 
-    mem = s_mem.realloc_func(ptr, size);
-    if (mem && !ptr) {
-        SDL_AtomicIncRef(&s_mem.num_allocations);
+    header = SDL_MemHeader(ptr);
+    if (*header != SDL_MEM_LARGE) {
+        const size_t old_size = SDL_mem_class_sizes[*header];
+        if (SDL_MemSizeClass(size) == *header) {
+            return ptr;
+        }
+        mem = SDL_AllocBlock(size, SDL_FALSE);
+        if (mem) {
+            SDL_memcpy(mem, ptr, SDL_min(size, old_size));
+            SDL_FreeBlock(ptr);
+        }
+        return mem;
     }
-    return mem;
+
+    if (size > (~(size_t)0 - SDL_MEM_HEADER_SIZE)) {
+        return NULL;
+    }
+    header = (size_t *)s_mem.realloc_func(SDL_MemBase(header), SDL_MEM_HEADER_SIZE + size);
+    if (!header) {
+        return NULL;
+    }
+    return SDL_MemData(header);
 }
 
 void SDL_free(void *ptr)
@@ -5369,7 +5628,7 @@ void SDL_free(void *ptr)
         return;
     }
 
-    s_mem.free_func(ptr);
+    SDL_FreeBlock(ptr);
     (void)SDL_AtomicDecRef(&s_mem.num_allocations);
 }
 
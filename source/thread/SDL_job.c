@@ -0,0 +1,494 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+/* Work stealing job system */
+
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_job.h"
+#include "SDL_thread.h"
+#include "SDL_job_c.h"
+#include "SDL_systhread.h"
+
+/* Jobs per worker deque, must be a power of two */
+#define SDL_JOB_DEQUE_SIZE  1024
+
+typedef struct SDL_Job
+{
+    SDL_JobFunction fn;
+    void *data;
+    SDL_JobGroup *group;
+} SDL_Job;
+
+struct SDL_JobGroup
+{
+    SDL_atomic_t pending;   /* jobs queued or running */
+};
+
+/* Each worker owns a Chase-Lev deque: the owner pushes and pops at the
+   bottom, other threads steal from the top. */
+typedef struct SDL_JobWorker
+{
+    SDL_atomic_t top;
+    char cache_pad[SDL_CACHELINE_SIZE];
+    SDL_atomic_t bottom;
+    SDL_Job jobs[SDL_JOB_DEQUE_SIZE];
+    SDL_Thread *thread;
+    int index;
+} SDL_JobWorker;
+
+typedef struct
+{
+    SDL_SpinLock init_lock;
+    SDL_atomic_t active;
+    int numworkers;
+    SDL_JobWorker **workers;
+    SDL_TLSID tls;
+
+    /* Idle workers sleep here */
+    SDL_sem *wakeup;
+    SDL_atomic_t sleeping;
+    SDL_atomic_t quit;
+
+    /* Threads in SDL_WaitJobGroup() with nothing to help with sleep here,
+       until a group finishes or more jobs are queued */
+    SDL_mutex *wait_lock;
+    SDL_cond *wait_cond;
+    SDL_atomic_t waiting;
+
+    /* FIFO for jobs submitted from threads outside the pool */
+    SDL_mutex *inject_lock;
+    SDL_Job *inject;
+    int inject_head;
+    int inject_count;
+    int inject_size;
+    SDL_atomic_t inject_pending;
+} SDL_JobData;
+
+static SDL_JobData SDL_job_data;
+
+
+static SDL_bool
+SDL_PushJob(SDL_JobWorker *worker, const SDL_Job *job)
+{
+    const int bottom = SDL_AtomicGet(&worker->bottom);
+    const int top = SDL_AtomicGet(&worker->top);
+
+    if (bottom - top >= SDL_JOB_DEQUE_SIZE) {
+        return SDL_FALSE;
+    }
+    worker->jobs[bottom & (SDL_JOB_DEQUE_SIZE - 1)] = *job;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&worker->bottom, bottom + 1);
+    return SDL_TRUE;
+}
+
+static SDL_bool
+SDL_PopJob(SDL_JobWorker *worker, SDL_Job *job)
+{
+    /* The decrement is a full barrier, so thieves see it before we read top */
+    const int bottom = SDL_AtomicAdd(&worker->bottom, -1) - 1;
+    const int top = SDL_AtomicGet(&worker->top);
+    SDL_bool taken = SDL_TRUE;
+
+    if (bottom - top < 0) {
+        /* Empty */
+        SDL_AtomicSet(&worker->bottom, bottom + 1);
+        return SDL_FALSE;
+    }
+
+    *job = worker->jobs[bottom & (SDL_JOB_DEQUE_SIZE - 1)];
+    if (bottom == top) {
+        /* Last job, race the thieves for it */
+        taken = SDL_AtomicCAS(&worker->top, top, top + 1);
+        SDL_AtomicSet(&worker->bottom, bottom + 1);
+    }
+    return taken;
+}
+
+static SDL_bool
+SDL_StealJob(SDL_JobWorker *worker, SDL_Job *job)
+{
+    const int top = SDL_AtomicGet(&worker->top);
+    const int bottom = SDL_AtomicGet(&worker->bottom);
+
+    if (bottom - top <= 0) {
+        return SDL_FALSE;
+    }
+    /* The copy may be torn if the owner reused the slot, but then top has
+       moved on and the compare and swap fails */
+    *job = worker->jobs[top & (SDL_JOB_DEQUE_SIZE - 1)];
+    return SDL_AtomicCAS(&worker->top, top, top + 1);
+}
+
+static SDL_bool
+SDL_InjectJob(SDL_JobData *data, const SDL_Job *job)
+{
+    SDL_LockMutex(data->inject_lock);
+    if (data->inject_count == data->inject_size) {
+        const int size = data->inject_size ? data->inject_size * 2 : 64;
+        SDL_Job *inject = (SDL_Job *) SDL_malloc(size * sizeof(*inject));
+        int i;
+
+        if (!inject) {
+            SDL_UnlockMutex(data->inject_lock);
+            return SDL_FALSE;
+        }
+        for (i = 0; i < data->inject_count; ++i) {
+            inject[i] = data->inject[(data->inject_head + i) % data->inject_size];
+        }
+        SDL_free(data->inject);
+        data->inject = inject;
+        data->inject_head = 0;
+        data->inject_size = size;
+    }
+    data->inject[(data->inject_head + data->inject_count) % data->inject_size] = *job;
+    ++data->inject_count;
+    SDL_AtomicIncRef(&data->inject_pending);
+    SDL_UnlockMutex(data->inject_lock);
+    return SDL_TRUE;
+}
+
+static SDL_bool
+SDL_TakeInjectedJob(SDL_JobData *data, SDL_Job *job)
+{
+    SDL_bool taken = SDL_FALSE;
+
+    if (SDL_AtomicGet(&data->inject_pending) == 0) {
+        return SDL_FALSE;
+    }
+
+    SDL_LockMutex(data->inject_lock);
+    if (data->inject_count > 0) {
+        *job = data->inject[data->inject_head];
+        data->inject_head = (data->inject_head + 1) % data->inject_size;
+        --data->inject_count;
+        SDL_AtomicAdd(&data->inject_pending, -1);
+        taken = SDL_TRUE;
+    }
+    SDL_UnlockMutex(data->inject_lock);
+    return taken;
+}
+
+/* Whether any job is queued, without taking it */
+static SDL_bool
+SDL_HaveJobs(SDL_JobData *data)
+{
+    int i;
+
+    if (SDL_AtomicGet(&data->inject_pending) > 0) {
+        return SDL_TRUE;
+    }
+    for (i = 0; i < data->numworkers; ++i) {
+        SDL_JobWorker *worker = data->workers[i];
+        if (SDL_AtomicGet(&worker->bottom) - SDL_AtomicGet(&worker->top) > 0) {
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+/* Wake the threads sleeping in SDL_WaitJobGroup() */
+static void
+SDL_WakeJobWaiters(SDL_JobData *data)
+{
+    if (SDL_AtomicGet(&data->waiting) > 0) {
+        SDL_LockMutex(data->wait_lock);
+        SDL_CondBroadcast(data->wait_cond);
+        SDL_UnlockMutex(data->wait_lock);
+    }
+}
+
+/* Find something to run: our own deque first, then jobs from outside the
+   pool, then the other workers' deques */
+static SDL_bool
+SDL_FindJob(SDL_JobData *data, SDL_JobWorker *self, SDL_Job *job)
+{
+    const int start = self ? self->index + 1 : 0;
+    int i;
+
+    if (self && SDL_PopJob(self, job)) {
+        return SDL_TRUE;
+    }
+    if (SDL_TakeInjectedJob(data, job)) {
+        return SDL_TRUE;
+    }
+    for (i = 0; i < data->numworkers; ++i) {
+        SDL_JobWorker *victim = data->workers[(start + i) % data->numworkers];
+        if (victim != self && SDL_StealJob(victim, job)) {
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+static void
+SDL_ExecuteJob(const SDL_Job *job)
+{
+    SDL_JobGroup *group = job->group;
+
+    job->fn(job->data);
+
+    /* The group may be destroyed as soon as pending reaches zero, so it
+       isn't touched after that */
+    if (group && SDL_AtomicDecRef(&group->pending)) {
+        SDL_WakeJobWaiters(&SDL_job_data);
+    }
+}
+
+static int SDLCALL
+SDL_JobWorkerThread(void *_worker)
+{
+    SDL_JobData *data = &SDL_job_data;
+    SDL_JobWorker *worker = (SDL_JobWorker *) _worker;
+    SDL_Job job;
+
+    SDL_TLSSet(data->tls, worker, NULL);
+
+    while (!SDL_AtomicGet(&data->quit)) {
+        if (SDL_FindJob(data, worker, &job)) {
+            SDL_ExecuteJob(&job);
+            continue;
+        }
+
+        /* Announce that we are going to sleep, then look once more so a
+           job queued in between isn't missed */
+        SDL_AtomicIncRef(&data->sleeping);
+        if (SDL_FindJob(data, worker, &job)) {
+            SDL_AtomicAdd(&data->sleeping, -1);
+            SDL_ExecuteJob(&job);
+            continue;
+        }
+        SDL_SemWait(data->wakeup);
+        SDL_AtomicAdd(&data->sleeping, -1);
+    }
+    return 0;
+}
+
+static SDL_bool
+SDL_StartJobWorkers(SDL_JobData *data)
+{
+    int i;
+
+    if (SDL_AtomicGet(&data->active)) {
+        return SDL_TRUE;
+    }
+
+    SDL_AtomicLock(&data->init_lock);
+    if (!SDL_AtomicGet(&data->active)) {
+        const int numworkers = SDL_max(SDL_GetCPUCount() - 1, 1);
+
+        if (!data->tls) {
+            data->tls = SDL_TLSCreate();
+        }
+        data->wakeup = SDL_CreateSemaphore(0);
+        data->inject_lock = SDL_CreateMutex();
+        data->wait_lock = SDL_CreateMutex();
+        data->wait_cond = SDL_CreateCond();
+        data->workers = (SDL_JobWorker **) SDL_calloc(numworkers, sizeof(*data->workers));
+        SDL_AtomicSet(&data->quit, 0);
+        data->numworkers = 0;
+
+        if (data->tls && data->wakeup && data->inject_lock &&
+            data->wait_lock && data->wait_cond && data->workers) {
+            for (i = 0; i < numworkers; ++i) {
+                char name[16];
+                SDL_JobWorker *worker = (SDL_JobWorker *) SDL_calloc(1, sizeof(*worker));
+                if (!worker) {
+                    break;
+                }
+                worker->index = i;
+                SDL_snprintf(name, sizeof(name), "SDLJob%d", i);
+                /* Jobs call into the app, so we can't set a limited stack size here. */
+                worker->thread = SDL_CreateThreadInternal(SDL_JobWorkerThread, name, 0, worker);
+                if (!worker->thread) {
+                    SDL_free(worker);
+                    break;
+                }
+                data->workers[data->numworkers++] = worker;
+            }
+        }
+
+        if (data->numworkers > 0) {
+            SDL_AtomicSet(&data->active, 1);
+        } else {
+            SDL_JobsQuit();
+        }
+    }
+    SDL_AtomicUnlock(&data->init_lock);
+
+    return SDL_AtomicGet(&data->active) ? SDL_TRUE : SDL_FALSE;
+}
+
+void
+SDL_JobsQuit(void)
+{
+    SDL_JobData *data = &SDL_job_data;
+    SDL_Job job;
+    int i;
+
+    SDL_AtomicSet(&data->quit, 1);
+    for (i = 0; i < data->numworkers; ++i) {
+        SDL_SemPost(data->wakeup);
+    }
+    for (i = 0; i < data->numworkers; ++i) {
+        SDL_WaitThread(data->workers[i]->thread, NULL);
+    }
+
+    /* The workers stop between jobs, run what they left behind so no
+       group is left waiting on them. The pool is still marked active,
+       so jobs these add are queued here and run too. */
+    while (SDL_FindJob(data, NULL, &job)) {
+        SDL_ExecuteJob(&job);
+    }
+
+    for (i = 0; i < data->numworkers; ++i) {
+        SDL_free(data->workers[i]);
+    }
+    SDL_free(data->workers);
+    data->workers = NULL;
+    data->numworkers = 0;
+
+    if (data->wakeup) {
+        SDL_DestroySemaphore(data->wakeup);
+        data->wakeup = NULL;
+    }
+    if (data->inject_lock) {
+        SDL_DestroyMutex(data->inject_lock);
+        data->inject_lock = NULL;
+    }
+    if (data->wait_cond) {
+        SDL_DestroyCond(data->wait_cond);
+        data->wait_cond = NULL;
+    }
+    if (data->wait_lock) {
+        SDL_DestroyMutex(data->wait_lock);
+        data->wait_lock = NULL;
+    }
+    SDL_free(data->inject);
+    data->inject = NULL;
+    data->inject_head = data->inject_count = data->inject_size = 0;
+    SDL_AtomicSet(&data->inject_pending, 0);
+
+    SDL_AtomicSet(&data->active, 0);
+}
+
+SDL_JobGroup *
+SDL_CreateJobGroup(void)
+{
+    SDL_JobGroup *group = (SDL_JobGroup *) SDL_calloc(1, sizeof(*group));
+
+    if (!group) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    return group;
+}
+
+void
+SDL_DestroyJobGroup(SDL_JobGroup *group)
+{
+    SDL_free(group);
+}
+
+int
+SDL_RunJob(SDL_JobGroup *group, SDL_JobFunction fn, void *data)
+{
+    SDL_JobData *jobs = &SDL_job_data;
+    SDL_JobWorker *self;
+    SDL_Job job;
+
+    if (!fn) {
+        return SDL_InvalidParamError("fn");
+    }
+
+    job.fn = fn;
+    job.data = data;
+    job.group = group;
+    if (group) {
+        SDL_AtomicIncRef(&group->pending);
+    }
+
+    if (!SDL_StartJobWorkers(jobs)) {
+        SDL_ExecuteJob(&job);
+        return 0;
+    }
+
+    self = (SDL_JobWorker *) SDL_TLSGet(jobs->tls);
+    if (!(self && SDL_PushJob(self, &job)) && !SDL_InjectJob(jobs, &job)) {
+        /* Our deque is full and we're out of memory, do it ourselves */
+        SDL_ExecuteJob(&job);
+        return 0;
+    }
+
+    if (SDL_AtomicGet(&jobs->sleeping) > 0) {
+        SDL_SemPost(jobs->wakeup);
+    }
+    /* A waiter may be the only thread free to run it */
+    SDL_WakeJobWaiters(jobs);
+    return 0;
+}
+
+void
+SDL_WaitJobGroup(SDL_JobGroup *group)
+{
+    SDL_JobData *data = &SDL_job_data;
+    SDL_JobWorker *self;
+    SDL_Job job;
+
+    if (!group) {
+        return;
+    }
+
+    self = SDL_AtomicGet(&data->active) ? (SDL_JobWorker *) SDL_TLSGet(data->tls) : NULL;
+    while (SDL_AtomicGet(&group->pending) > 0) {
+        /* Help out rather than sleep */
+        if (SDL_AtomicGet(&data->active) && SDL_FindJob(data, self, &job)) {
+            SDL_ExecuteJob(&job);
+            continue;
+        }
+
+        /* Sleep until a group finishes or a job is queued. Both are
+           checked after announcing the wait, and signaled after their
+           change, so neither can slip in unseen. */
+        SDL_LockMutex(data->wait_lock);
+        SDL_AtomicIncRef(&data->waiting);
+        if (SDL_AtomicGet(&group->pending) > 0 && !SDL_HaveJobs(data)) {
+            SDL_CondWait(data->wait_cond, data->wait_lock);
+        }
+        SDL_AtomicAdd(&data->waiting, -1);
+        SDL_UnlockMutex(data->wait_lock);
+    }
+}
+
+int
+SDL_GetJobWorkerCount(void)
+{
+    SDL_JobData *data = &SDL_job_data;
+
+    if (!SDL_StartJobWorkers(data)) {
+        return 0;
+    }
+    return data->numworkers;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -46,6 +46,9 @@ extern void SDL_SYS_SetupThread(const char *name);
 /* This function sets the current thread priority */
 extern int SDL_SYS_SetThreadPriority(SDL_ThreadPriority priority);
 
+/* This function sets the CPU affinity of the current thread */
+extern int SDL_SYS_SetThreadAffinityMask(Uint64 mask);
+
 /* This function waits for the thread to finish and frees any data
    allocated by SDL_SYS_CreateThread()
  */
@@ -60,6 +63,9 @@ extern SDL_TLSData *SDL_SYS_GetTLSData(void);
 /* Set the thread local storage for this thread */
 extern int SDL_SYS_SetTLSData(SDL_TLSData *data);
 
+/* Wait on a semaphore for at most 'us' microseconds, for the timer thread */
+extern int SDL_SemWaitTimeoutUS(SDL_sem * sem, Uint32 us);
+
 /* This is for internal SDL use, so we don't need #ifdefs everywhere. */
 extern SDL_Thread *
 SDL_CreateThreadInternal(int (SDLCALL * fn) (void *), const char *name,
@@ -273,6 +273,53 @@ typedef struct
     SDL_sem *wait;
 } thread_args;
 
+#if !SDL_THREAD_ORBIS
+/* Only the ORBIS backend can pin threads so far */
+int
+SDL_SYS_SetThreadAffinityMask(Uint64 mask)
+{
+    if (mask == 0) {
+        return SDL_InvalidParamError("mask");
+    }
+    return SDL_Unsupported();
+}
+#endif
+
+/* Pin a new thread according to SDL_HINT_THREAD_AFFINITY */
+static void
+SDL_ApplyThreadAffinityHint(const char *name)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_THREAD_AFFINITY);
+    const char *entry, *equals;
+    size_t namelen;
+
+    if (!hint || !*hint) {
+        return;
+    }
+
+    namelen = name ? SDL_strlen(name) : 0;
+    for (entry = hint; *entry; ) {
+        while (*entry == ',' || *entry == ' ') {
+            ++entry;
+        }
+        equals = SDL_strchr(entry, '=');
+        if (!equals) {
+            break;
+        }
+        if ((equals - entry == 1 && *entry == '*') ||
+            (name && (size_t)(equals - entry) == namelen && SDL_strncmp(entry, name, namelen) == 0)) {
+            SDL_SYS_SetThreadAffinityMask(SDL_strtoull(equals + 1, NULL, 0));
+            if (*entry != '*') {
+                return;  /* An exact match beats a wildcard */
+            }
+        }
+        entry = SDL_strchr(equals, ',');
+        if (!entry) {
+            break;
+        }
+    }
+}
+
 void
 SDL_RunThread(void *data)
 {
@@ -284,6 +331,7 @@ SDL_RunThread(void *data)
 
     /* Perform any system-dependent setup - this function may not fail */
     SDL_SYS_SetupThread(thread->name);
+    SDL_ApplyThreadAffinityHint(thread->name);
 
     /* Get the thread id */
     thread->threadid = SDL_ThreadID();
@@ -474,6 +522,12 @@ SDL_SetThreadPriority(SDL_ThreadPriority priority)
     return SDL_SYS_SetThreadPriority(priority);
 }
 
+int
+SDL_SetThreadAffinityMask(Uint64 mask)
+{
+    return SDL_SYS_SetThreadAffinityMask(mask);
+}
+
 void
 SDL_WaitThread(SDL_Thread * thread, int *status)
 {
@@ -26,7 +26,10 @@
 #include "SDL_thread.h"
 
 /* Need the definitions of SYS_ThreadHandle */
-#if SDL_THREADS_DISABLED
+#if SDL_THREAD_ORBIS
+/* The ORBIS backend builds with threads disabled too */
+#include "orbis/SDL_systhread_c.h"
+#elif SDL_THREADS_DISABLED
 #include "generic/SDL_systhread_c.h"
 #elif SDL_THREAD_PTHREAD
 #include "pthread/SDL_systhread_c.h"
@@ -36,8 +39,6 @@
 #include "psp/SDL_systhread_c.h"
 #elif SDL_THREAD_VITA
 #include "vita/SDL_systhread_c.h"
-#elif SDL_THREAD_ORBIS
-#include "orbis/SDL_systhread_c.h"
 #elif SDL_THREAD_STDCPP
 #include "stdcpp/SDL_systhread_c.h"
 #else
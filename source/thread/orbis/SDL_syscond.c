@@ -22,21 +22,21 @@
 
 #if SDL_THREAD_ORBIS
 
-/* An implementation of condition variables using semaphores and mutexes */
-/*
-   This implementation borrows heavily from the BeOS condition variable
-   implementation, written by Christopher Tate and Owen Smith.  Thanks!
+/* An implementation of condition variables using the native pthread
+   condition variable. Signalling only wakes a waiter; unlike the old
+   semaphore emulation there is no handshake back to the signalling thread.
  */
 
 #include "SDL_thread.h"
+#include "SDL_sysmutex_c.h"
+
+#if !defined(__ORBIS__)
+#include <sys/time.h>
+#endif
 
 struct SDL_cond
 {
-    SDL_mutex *lock;
-    int waiting;
-    int signals;
-    SDL_sem *wait_sem;
-    SDL_sem *wait_done;
+    ORBIS_NativeCond cond;
 };
 
 /* Create a condition variable */
@@ -44,15 +44,18 @@ SDL_cond *
 SDL_CreateCond(void)
 {
     SDL_cond *cond;
+    int ret;
 
     cond = (SDL_cond *) SDL_malloc(sizeof(SDL_cond));
     if (cond) {
-        cond->lock = SDL_CreateMutex();
-        cond->wait_sem = SDL_CreateSemaphore(0);
-        cond->wait_done = SDL_CreateSemaphore(0);
-        cond->waiting = cond->signals = 0;
-        if (!cond->lock || !cond->wait_sem || !cond->wait_done) {
-            SDL_DestroyCond(cond);
+#if defined(__ORBIS__)
+        ret = scePthreadCondInit(&cond->cond, NULL, "SDL cond");
+#else
+        ret = pthread_cond_init(&cond->cond, NULL);
+#endif
+        if (ret != 0) {
+            SDL_SetError("pthread_cond_init() failed");
+            SDL_free(cond);
             cond = NULL;
         }
     } else {
@@ -66,15 +69,7 @@ void
 SDL_DestroyCond(SDL_cond * cond)
 {
     if (cond) {
-        if (cond->wait_sem) {
-            SDL_DestroySemaphore(cond->wait_sem);
-        }
-        if (cond->wait_done) {
-            SDL_DestroySemaphore(cond->wait_done);
-        }
-        if (cond->lock) {
-            SDL_DestroyMutex(cond->lock);
-        }
+        ORBIS_COND_DESTROY(&cond->cond);
         SDL_free(cond);
     }
 }
@@ -87,19 +82,9 @@ SDL_CondSignal(SDL_cond * cond)
         return SDL_SetError("Passed a NULL condition variable");
     }
 
-    /* If there are waiting threads not already signalled, then
-       signal the condition and wait for the thread to respond.
-     */
-    SDL_LockMutex(cond->lock);
-    if (cond->waiting > cond->signals) {
-        ++cond->signals;
-        SDL_SemPost(cond->wait_sem);
-        SDL_UnlockMutex(cond->lock);
-        SDL_SemWait(cond->wait_done);
-    } else {
-        SDL_UnlockMutex(cond->lock);
+    if (ORBIS_COND_SIGNAL(&cond->cond) != 0) {
+        return SDL_SetError("pthread_cond_signal() failed");
     }
-
     return 0;
 }
 
@@ -111,29 +96,9 @@ SDL_CondBroadcast(SDL_cond * cond)
         return SDL_SetError("Passed a NULL condition variable");
     }
 
-    /* If there are waiting threads not already signalled, then
-       signal the condition and wait for the thread to respond.
-     */
-    SDL_LockMutex(cond->lock);
-    if (cond->waiting > cond->signals) {
-        int i, num_waiting;
-
-        num_waiting = (cond->waiting - cond->signals);
-        cond->signals = cond->waiting;
-        for (i = 0; i < num_waiting; ++i) {
-            SDL_SemPost(cond->wait_sem);
-        }
-        /* Now all released threads are blocked here, waiting for us.
-           Collect them all (and win fabulous prizes!) :-)
-         */
-        SDL_UnlockMutex(cond->lock);
-        for (i = 0; i < num_waiting; ++i) {
-            SDL_SemWait(cond->wait_done);
-        }
-    } else {
-        SDL_UnlockMutex(cond->lock);
+    if (ORBIS_COND_BROADCAST(&cond->cond) != 0) {
+        return SDL_SetError("pthread_cond_broadcast() failed");
     }
-
     return 0;
 }
 
@@ -162,54 +127,43 @@ int
 SDL_CondWaitTimeout(SDL_cond * cond, SDL_mutex * mutex, Uint32 ms)
 {
     int retval;
+#if !defined(__ORBIS__)
+    struct timeval delta;
+    struct timespec abstime;
+#endif
 
     if (!cond) {
         return SDL_SetError("Passed a NULL condition variable");
     }
+    if (!mutex) {
+        return SDL_SetError("Passed a NULL mutex");
+    }
 
-    /* Obtain the protection mutex, and increment the number of waiters.
-       This allows the signal mechanism to only perform a signal if there
-       are waiting threads.
-     */
-    SDL_LockMutex(cond->lock);
-    ++cond->waiting;
-    SDL_UnlockMutex(cond->lock);
-
-    /* Unlock the mutex, as is required by condition variable semantics */
-    SDL_UnlockMutex(mutex);
-
-    /* Wait for a signal */
     if (ms == SDL_MUTEX_MAXWAIT) {
-        retval = SDL_SemWait(cond->wait_sem);
+        retval = ORBIS_COND_WAIT(&cond->cond, &mutex->id);
     } else {
-        retval = SDL_SemWaitTimeout(cond->wait_sem, ms);
-    }
-
-    /* Let the signaler know we have completed the wait, otherwise
-       the signaler can race ahead and get the condition semaphore
-       if we are stopped between the mutex unlock and semaphore wait,
-       giving a deadlock.  See the following URL for details:
-       http://www-classic.be.com/aboutbe/benewsletter/volume_III/Issue40.html
-     */
-    SDL_LockMutex(cond->lock);
-    if (cond->signals > 0) {
-        /* If we timed out, we need to eat a condition signal */
-        if (retval > 0) {
-            SDL_SemWait(cond->wait_sem);
+#if defined(__ORBIS__)
+        /* libkernel takes a relative timeout in microseconds */
+        retval = scePthreadCondTimedwait(&cond->cond, &mutex->id, (SceKernelUseconds) ms * 1000);
+#else
+        gettimeofday(&delta, NULL);
+        abstime.tv_sec = delta.tv_sec + (ms / 1000);
+        abstime.tv_nsec = (delta.tv_usec + (ms % 1000) * 1000) * 1000;
+        if (abstime.tv_nsec >= 1000000000) {
+            abstime.tv_sec += 1;
+            abstime.tv_nsec -= 1000000000;
         }
-        /* We always notify the signal thread that we are done */
-        SDL_SemPost(cond->wait_done);
-
-        /* Signal handshake complete */
-        --cond->signals;
+        retval = pthread_cond_timedwait(&cond->cond, &mutex->id, &abstime);
+#endif
     }
-    --cond->waiting;
-    SDL_UnlockMutex(cond->lock);
-
-    /* Lock the mutex, as is required by condition variable semantics */
-    SDL_LockMutex(mutex);
 
-    return retval;
+    if (retval == 0) {
+        return 0;
+    }
+    if (retval == ORBIS_ETIMEDOUT) {
+        return SDL_MUTEX_TIMEDOUT;
+    }
+    return SDL_SetError("pthread_cond_wait() failed");
 }
 
 /* Wait on the condition variable forever */
@@ -22,38 +22,53 @@
 
 #if SDL_THREAD_ORBIS
 
-/* An implementation of mutexes using semaphores */
+/* An implementation of mutexes using the native pthread mutex.
+   Both the libkernel and the POSIX mutex take an unowned lock with a
+   single atomic compare-and-swap in user space; only a contended lock
+   ends up in the kernel.
+ */
 
 #include "SDL_thread.h"
 #include "SDL_systhread_c.h"
+#include "SDL_sysmutex_c.h"
+#include "../../atomic/SDL_spinlock_c.h"
 
 
-struct SDL_mutex
-{
-    int recursive;
-    SDL_threadID owner;
-    SDL_sem *sem;
-};
-
 /* Create a mutex */
 SDL_mutex *
 SDL_CreateMutex(void)
 {
     SDL_mutex *mutex;
+    int ret;
+#if defined(__ORBIS__)
+    ScePthreadMutexattr attr;
+#else
+    pthread_mutexattr_t attr;
+#endif
 
     /* Allocate mutex memory */
-    mutex = (SDL_mutex *) SDL_malloc(sizeof(*mutex));
-    if (mutex) {
-        /* Create the mutex semaphore, with initial value 1 */
-        mutex->sem = SDL_CreateSemaphore(1);
-        mutex->recursive = 0;
-        mutex->owner = 0;
-        if (!mutex->sem) {
-            SDL_free(mutex);
-            mutex = NULL;
-        }
-    } else {
+    mutex = (SDL_mutex *) SDL_calloc(1, sizeof(*mutex));
+    if (!mutex) {
         SDL_OutOfMemory();
+        return NULL;
+    }
+
+    /* SDL mutexes are recursive */
+#if defined(__ORBIS__)
+    scePthreadMutexattrInit(&attr);
+    scePthreadMutexattrSettype(&attr, SCE_PTHREAD_MUTEX_RECURSIVE);
+    ret = scePthreadMutexInit(&mutex->id, &attr, "SDL mutex");
+    scePthreadMutexattrDestroy(&attr);
+#else
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    ret = pthread_mutex_init(&mutex->id, &attr);
+    pthread_mutexattr_destroy(&attr);
+#endif
+    if (ret != 0) {
+        SDL_SetError("Couldn't create mutex");
+        SDL_free(mutex);
+        mutex = NULL;
     }
     return mutex;
 }
@@ -63,43 +78,63 @@ void
 SDL_DestroyMutex(SDL_mutex * mutex)
 {
     if (mutex) {
-        if (mutex->sem) {
-            SDL_DestroySemaphore(mutex->sem);
-        }
+        ORBIS_MUTEX_DESTROY(&mutex->id);
         SDL_free(mutex);
     }
 }
 
-/* Lock the semaphore */
+#if !SDL_THREADS_DISABLED
+static SDL_bool
+MutexTryLock(void *mutex)
+{
+    return (ORBIS_MUTEX_TRYLOCK(&((SDL_mutex *) mutex)->id) == 0) ? SDL_TRUE : SDL_FALSE;
+}
+#endif
+
+/* Lock the mutex */
 int
 SDL_mutexP(SDL_mutex * mutex)
 {
 #if SDL_THREADS_DISABLED
     return 0;
 #else
-    SDL_threadID this_thread;
-
     if (mutex == NULL) {
         return SDL_SetError("Passed a NULL mutex");
     }
 
-    this_thread = SDL_ThreadID();
-    if (mutex->owner == this_thread) {
-        ++mutex->recursive;
-    } else {
-        /* The order of operations is important.
-           We set the locking thread id after we obtain the lock
-           so unlocks from other threads will fail.
-         */
-        SDL_SemWait(mutex->sem);
-        mutex->owner = this_thread;
-        mutex->recursive = 0;
+    /* Uncontended fast path, never leaves user space */
+    if (ORBIS_MUTEX_TRYLOCK(&mutex->id) == 0) {
+        return 0;
     }
 
+    /* Spin for a while before sleeping in the kernel */
+    if (SDL_SpinTryLock(MutexTryLock, mutex)) {
+        return 0;
+    }
+
+    SDL_CountLockPark();
+    if (ORBIS_MUTEX_LOCK(&mutex->id) != 0) {
+        return SDL_SetError("Couldn't lock mutex");
+    }
     return 0;
 #endif /* SDL_THREADS_DISABLED */
 }
 
+/* Try to lock the mutex */
+int
+SDL_TryLockMutex(SDL_mutex * mutex)
+{
+#if SDL_THREADS_DISABLED
+    return 0;
+#else
+    if (mutex == NULL) {
+        return SDL_SetError("Passed a NULL mutex");
+    }
+
+    return (ORBIS_MUTEX_TRYLOCK(&mutex->id) == 0) ? 0 : SDL_MUTEX_TIMEDOUT;
+#endif /* SDL_THREADS_DISABLED */
+}
+
 /* Unlock the mutex */
 int
 SDL_mutexV(SDL_mutex * mutex)
@@ -111,22 +146,10 @@ SDL_mutexV(SDL_mutex * mutex)
         return SDL_SetError("Passed a NULL mutex");
     }
 
-    /* If we don't own the mutex, we can't unlock it */
-    if (SDL_ThreadID() != mutex->owner) {
+    /* Fails if we don't own the mutex */
+    if (ORBIS_MUTEX_UNLOCK(&mutex->id) != 0) {
         return SDL_SetError("mutex not owned by this thread");
     }
-
-    if (mutex->recursive) {
-        --mutex->recursive;
-    } else {
-        /* The order of operations is important.
-           First reset the owner so another thread doesn't lock
-           the mutex and set the ownership before we reset it,
-           then release the lock semaphore.
-         */
-        mutex->owner = 0;
-        SDL_SemPost(mutex->sem);
-    }
     return 0;
 #endif /* SDL_THREADS_DISABLED */
 }
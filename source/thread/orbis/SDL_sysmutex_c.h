@@ -0,0 +1,80 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2015 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#ifndef SDL_mutex_orbis_h_
+#define SDL_mutex_orbis_h_
+
+/* The ORBIS mutex and condition variable sit directly on the libkernel
+   pthread primitives. Everything else in SDL only goes through the macros
+   below, so building without __ORBIS__ maps them onto plain POSIX threads
+   and the same code can be profiled on a desktop host.
+ */
+
+#if defined(__ORBIS__)
+
+#include <kernel.h>
+
+typedef ScePthreadMutex ORBIS_NativeMutex;
+typedef ScePthreadCond ORBIS_NativeCond;
+
+#define ORBIS_MUTEX_TRYLOCK(m)  scePthreadMutexTrylock(m)
+#define ORBIS_MUTEX_LOCK(m)     scePthreadMutexLock(m)
+#define ORBIS_MUTEX_UNLOCK(m)   scePthreadMutexUnlock(m)
+#define ORBIS_MUTEX_DESTROY(m)  scePthreadMutexDestroy(m)
+
+#define ORBIS_COND_SIGNAL(c)    scePthreadCondSignal(c)
+#define ORBIS_COND_BROADCAST(c) scePthreadCondBroadcast(c)
+#define ORBIS_COND_WAIT(c, m)   scePthreadCondWait(c, m)
+#define ORBIS_COND_DESTROY(c)   scePthreadCondDestroy(c)
+
+#define ORBIS_ETIMEDOUT         SCE_KERNEL_ERROR_ETIMEDOUT
+
+#else
+
+#include <errno.h>
+#include <pthread.h>
+
+typedef pthread_mutex_t ORBIS_NativeMutex;
+typedef pthread_cond_t ORBIS_NativeCond;
+
+#define ORBIS_MUTEX_TRYLOCK(m)  pthread_mutex_trylock(m)
+#define ORBIS_MUTEX_LOCK(m)     pthread_mutex_lock(m)
+#define ORBIS_MUTEX_UNLOCK(m)   pthread_mutex_unlock(m)
+#define ORBIS_MUTEX_DESTROY(m)  pthread_mutex_destroy(m)
+
+#define ORBIS_COND_SIGNAL(c)    pthread_cond_signal(c)
+#define ORBIS_COND_BROADCAST(c) pthread_cond_broadcast(c)
+#define ORBIS_COND_WAIT(c, m)   pthread_cond_wait(c, m)
+#define ORBIS_COND_DESTROY(c)   pthread_cond_destroy(c)
+
+#define ORBIS_ETIMEDOUT         ETIMEDOUT
+
+#endif /* __ORBIS__ */
+
+struct SDL_mutex
+{
+    ORBIS_NativeMutex id;
+};
+
+#endif /* SDL_mutex_orbis_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
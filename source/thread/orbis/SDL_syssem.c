@@ -22,13 +22,16 @@
 
 #if SDL_THREAD_ORBIS
 
-/* Semaphore functions for the VITA. */
+/* Semaphore functions for ORBIS, on libkernel semaphores */
 
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "SDL_error.h"
 #include "SDL_thread.h"
+#include "../SDL_systhread.h"
+
+#if defined(__ORBIS__)
 
 #include <kernel.h>
 typedef void *SceKernelSema;
@@ -74,19 +77,19 @@ void SDL_DestroySemaphore(SDL_sem *sem)
 
 /* TODO: This routine is a bit overloaded.
  * If the timeout is 0 then just poll the semaphore; if it's SDL_MUTEX_MAXWAIT, pass
- * NULL to sceKernelWaitSema() so that it waits indefinitely; and if the timeout
- * is specified, convert it to microseconds. */
-int SDL_SemWaitTimeout(SDL_sem *sem, Uint32 timeout)
+ * NULL to sceKernelWaitSema() so that it waits indefinitely; otherwise the kernel
+ * takes the timeout in microseconds as it is. */
+int SDL_SemWaitTimeoutUS(SDL_sem *sem, Uint32 us)
 {
     Uint32 *pTimeout;
-       unsigned int res;
+    int res;
 
     if (sem == NULL) {
         SDL_SetError("Passed a NULL sem");
         return 0;
     }
 
-    if (timeout == 0) {
+    if (us == 0) {
         res = sceKernelPollSema(sem->semid, 1);
         if (res < 0) {
             return SDL_MUTEX_TIMEDOUT;
@@ -94,11 +97,10 @@ int SDL_SemWaitTimeout(SDL_sem *sem, Uint32 timeout)
         return 0;
     }
 
-    if (timeout == SDL_MUTEX_MAXWAIT) {
+    if (us == SDL_MUTEX_MAXWAIT) {
         pTimeout = NULL;
     } else {
-        timeout *= 1000;  /* Convert to microseconds. */
-        pTimeout = &timeout;
+        pTimeout = &us;
     }
 
     res = sceKernelWaitSema(sem->semid, 1, pTimeout);
@@ -112,6 +114,15 @@ int SDL_SemWaitTimeout(SDL_sem *sem, Uint32 timeout)
     }
 }
 
+int SDL_SemWaitTimeout(SDL_sem *sem, Uint32 timeout)
+{
+    if (timeout != SDL_MUTEX_MAXWAIT) {
+        /* Convert to microseconds. */
+        timeout = SDL_min(timeout, (SDL_MUTEX_MAXWAIT - 1) / 1000) * 1000;
+    }
+    return SDL_SemWaitTimeoutUS(sem, timeout);
+}
+
 int SDL_SemTryWait(SDL_sem *sem)
 {
     return SDL_SemWaitTimeout(sem, 0);
@@ -156,6 +167,123 @@ int SDL_SemPost(SDL_sem *sem)
     return 0;
 }
 
+#else
+
+/* Without __ORBIS__ the semaphore is a POSIX one, so the rest of the
+   backend can run on a desktop host */
+
+#include <errno.h>
+#include <semaphore.h>
+#include <sys/time.h>
+
+struct SDL_semaphore {
+    sem_t sem;
+};
+
+SDL_sem *SDL_CreateSemaphore(Uint32 initial_value)
+{
+    SDL_sem *sem = (SDL_sem *) SDL_malloc(sizeof(*sem));
+
+    if (sem != NULL) {
+        if (sem_init(&sem->sem, 0, initial_value) < 0) {
+            SDL_SetError("sem_init() failed");
+            SDL_free(sem);
+            sem = NULL;
+        }
+    } else {
+        SDL_OutOfMemory();
+    }
+    return sem;
+}
+
+void SDL_DestroySemaphore(SDL_sem *sem)
+{
+    if (sem != NULL) {
+        sem_destroy(&sem->sem);
+        SDL_free(sem);
+    }
+}
+
+int SDL_SemWaitTimeoutUS(SDL_sem *sem, Uint32 us)
+{
+    struct timeval now;
+    struct timespec deadline;
+    int res;
+
+    if (sem == NULL) {
+        return SDL_SetError("Passed a NULL sem");
+    }
+
+    if (us == 0) {
+        return (sem_trywait(&sem->sem) == 0) ? 0 : SDL_MUTEX_TIMEDOUT;
+    }
+
+    if (us == SDL_MUTEX_MAXWAIT) {
+        do {
+            res = sem_wait(&sem->sem);
+        } while (res < 0 && errno == EINTR);
+        return (res == 0) ? 0 : SDL_SetError("sem_wait() failed");
+    }
+
+    gettimeofday(&now, NULL);
+    deadline.tv_sec = now.tv_sec + (us / 1000000);
+    deadline.tv_nsec = (now.tv_usec + (us % 1000000)) * 1000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+    }
+    do {
+        res = sem_timedwait(&sem->sem, &deadline);
+    } while (res < 0 && errno == EINTR);
+    if (res == 0) {
+        return 0;
+    }
+    return (errno == ETIMEDOUT) ? SDL_MUTEX_TIMEDOUT : SDL_SetError("sem_timedwait() failed");
+}
+
+int SDL_SemWaitTimeout(SDL_sem *sem, Uint32 timeout)
+{
+    if (timeout != SDL_MUTEX_MAXWAIT) {
+        timeout = SDL_min(timeout, (SDL_MUTEX_MAXWAIT - 1) / 1000) * 1000;
+    }
+    return SDL_SemWaitTimeoutUS(sem, timeout);
+}
+
+int SDL_SemTryWait(SDL_sem *sem)
+{
+    return SDL_SemWaitTimeout(sem, 0);
+}
+
+int SDL_SemWait(SDL_sem *sem)
+{
+    return SDL_SemWaitTimeout(sem, SDL_MUTEX_MAXWAIT);
+}
+
+Uint32 SDL_SemValue(SDL_sem *sem)
+{
+    int value = 0;
+
+    if (sem == NULL) {
+        SDL_SetError("Passed a NULL sem");
+        return 0;
+    }
+    sem_getvalue(&sem->sem, &value);
+    return (value > 0) ? (Uint32) value : 0;
+}
+
+int SDL_SemPost(SDL_sem *sem)
+{
+    if (sem == NULL) {
+        return SDL_SetError("Passed a NULL sem");
+    }
+    if (sem_post(&sem->sem) < 0) {
+        return SDL_SetError("sem_post() failed");
+    }
+    return 0;
+}
+
+#endif /* __ORBIS__ */
+
 #endif /* SDL_THREAD_ORBIS */
 
 /* vim: ts=4 sw=4
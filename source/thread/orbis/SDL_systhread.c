@@ -18,6 +18,9 @@
      misrepresented as being the original software.
   3. This notice may not be removed or altered from any source distribution.
 */
+#if !defined(__ORBIS__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* pthread_setname_np() and CPU_SET() on Linux */
+#endif
 #include "../../SDL_internal.h"
 
 #if SDL_THREAD_ORBIS
@@ -31,10 +34,50 @@
 #include "SDL_thread.h"
 #include "../SDL_systhread.h"
 #include "../SDL_thread_c.h"
-#include <kernel.h>
 
+/* Without __ORBIS__ this file builds on POSIX threads, so thread creation,
+   naming, priorities and affinity can be exercised on a desktop host */
+#if defined(__ORBIS__)
+#include <kernel.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+
+/* Map an SDL priority onto a libkernel FIFO priority, where lower values
+   run first, or onto a nice value on POSIX */
+static int
+ORBIS_MapThreadPriority(SDL_ThreadPriority priority)
+{
+#if defined(__ORBIS__)
+    switch (priority) {
+    case SDL_THREAD_PRIORITY_LOW:
+        return SCE_KERNEL_PRIO_FIFO_LOWEST;
+    case SDL_THREAD_PRIORITY_HIGH:
+        return SCE_KERNEL_PRIO_FIFO_HIGHEST;
+    default:
+        return SCE_KERNEL_PRIO_FIFO_DEFAULT;
+    }
+#else
+    switch (priority) {
+    case SDL_THREAD_PRIORITY_LOW:
+        return 19;
+    case SDL_THREAD_PRIORITY_HIGH:
+        return -20;
+    default:
+        return 0;
+    }
+#endif
+}
 
-void * ThreadEntry(void *arg)
+static void *
+ThreadEntry(void *arg)
 {
     SDL_RunThread(arg);
     return 0;
@@ -42,43 +85,83 @@ void * ThreadEntry(void *arg)
 
 int SDL_SYS_CreateThread(SDL_Thread *thread, void *args)
 {
+#if defined(__ORBIS__)
+    ScePthreadAttr attr;
     int priority = 0;
-	int ret=0;
-    ScePthread thid; 
-    thid = scePthreadSelf();
-    if (scePthreadGetprio(thid, &priority) == 0 && priority>1) {
-		ret=scePthreadCreate(&thread->handle, NULL, ThreadEntry, NULL, NULL);
-		if(ret==0)
-		{
-			scePthreadSetprio(thread->handle, priority);
-			return 0;
-		}	
-		else
-		{
-	        return SDL_SetError("scePthreadCreate() failed");
-		}	
+    int ret;
+
+    scePthreadAttrInit(&attr);
+    if (thread->stacksize) {
+        scePthreadAttrSetstacksize(&attr, thread->stacksize);
+    }
+    ret = scePthreadCreate(&thread->handle, &attr, ThreadEntry, args,
+                           thread->name ? thread->name : "SDL thread");
+    scePthreadAttrDestroy(&attr);
+    if (ret != 0) {
+        return SDL_SetError("scePthreadCreate() failed");
     }
-    return -1;
+
+    /* New threads run at the creating thread's priority */
+    if (scePthreadGetprio(scePthreadSelf(), &priority) == 0) {
+        scePthreadSetprio(thread->handle, priority);
+    }
+    return 0;
+#else
+    pthread_attr_t attr;
+    int ret;
+
+    pthread_attr_init(&attr);
+    if (thread->stacksize) {
+        pthread_attr_setstacksize(&attr, thread->stacksize);
+    }
+    ret = pthread_create(&thread->handle, &attr, ThreadEntry, args);
+    pthread_attr_destroy(&attr);
+    if (ret != 0) {
+        return SDL_SetError("pthread_create() failed");
+    }
+    return 0;
+#endif
 }
 
 void SDL_SYS_SetupThread(const char *name)
 {
-    /* Do nothing. */
+#if defined(__ORBIS__)
+    /* The name was given to scePthreadCreate() */
+#elif defined(__linux__)
+    if (name) {
+        /* Linux limits thread names to 15 characters */
+        char namebuf[16];
+        SDL_strlcpy(namebuf, name, sizeof(namebuf));
+        pthread_setname_np(pthread_self(), namebuf);
+    }
+#endif
 }
 
 SDL_threadID SDL_ThreadID(void)
 {
+#if defined(__ORBIS__)
     return (SDL_threadID) scePthreadSelf();
+#else
+    return (SDL_threadID) pthread_self();
+#endif
 }
 
 void SDL_SYS_WaitThread(SDL_Thread *thread)
 {
+#if defined(__ORBIS__)
     scePthreadJoin(thread->handle, NULL);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
 }
 
 void SDL_SYS_DetachThread(SDL_Thread *thread)
 {
+#if defined(__ORBIS__)
     scePthreadDetach(thread->handle);
+#else
+    pthread_detach(thread->handle);
+#endif
 }
 
 /*void SDL_SYS_KillThread(SDL_Thread *thread)
@@ -88,16 +171,54 @@ void SDL_SYS_DetachThread(SDL_Thread *thread)
 */
 int SDL_SYS_SetThreadPriority(SDL_ThreadPriority priority)
 {
-    int ret=0;
-
-    ScePthread thid; 
-    thid = scePthreadSelf();
-	ret=scePthreadSetprio(thid, priority);
-	if(ret<0)
-	{
-		return -1;
-	}
-	return ret;
+    const int value = ORBIS_MapThreadPriority(priority);
+
+#if defined(__ORBIS__)
+    if (scePthreadSetprio(scePthreadSelf(), value) < 0) {
+        return SDL_SetError("scePthreadSetprio() failed");
+    }
+#elif defined(__linux__)
+    if (setpriority(PRIO_PROCESS, (id_t) syscall(SYS_gettid), value) < 0) {
+        return SDL_SetError("setpriority() failed");
+    }
+#else
+    if (setpriority(PRIO_PROCESS, 0, value) < 0) {
+        return SDL_SetError("setpriority() failed");
+    }
+#endif
+    return 0;
+}
+
+int SDL_SYS_SetThreadAffinityMask(Uint64 mask)
+{
+#if defined(__linux__) && !defined(__ORBIS__)
+    cpu_set_t cpuset;
+    int cpu;
+#endif
+
+    if (mask == 0) {
+        return SDL_InvalidParamError("mask");
+    }
+
+#if defined(__ORBIS__)
+    if (scePthreadSetaffinity(scePthreadSelf(), (SceKernelCpumask) mask) < 0) {
+        return SDL_SetError("scePthreadSetaffinity() failed");
+    }
+    return 0;
+#elif defined(__linux__)
+    CPU_ZERO(&cpuset);
+    for (cpu = 0; cpu < 64; ++cpu) {
+        if (mask & ((Uint64) 1 << cpu)) {
+            CPU_SET(cpu, &cpuset);
+        }
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0) {
+        return SDL_SetError("pthread_setaffinity_np() failed");
+    }
+    return 0;
+#else
+    return SDL_Unsupported();
+#endif
 }
 
 #endif /* SDL_THREAD_ORBIS */
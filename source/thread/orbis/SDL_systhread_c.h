@@ -19,6 +19,12 @@
   3. This notice may not be removed or altered from any source distribution.
 */
 
+#if defined(__ORBIS__)
 #include <kernel.h>
 
 typedef ScePthread SYS_ThreadHandle;
+#else
+#include <pthread.h>
+
+typedef pthread_t SYS_ThreadHandle;
+#endif
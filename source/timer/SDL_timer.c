@@ -34,9 +34,11 @@ typedef struct _SDL_Timer
     SDL_TimerCallback callback;
     void *param;
     Uint32 interval;
-    Uint32 scheduled;
+    Uint64 scheduled;   /* microseconds, see SDL_GetTicksUS() */
     SDL_atomic_t canceled;
+    int heapindex;      /* position in the heap, -1 when not in it */
     struct _SDL_Timer *next;
+    struct _SDL_Timer *next_canceled;
 } SDL_Timer;
 
 typedef struct _SDL_TimerMap
@@ -46,12 +48,16 @@ typedef struct _SDL_TimerMap
     struct _SDL_TimerMap *next;
 } SDL_TimerMap;
 
-/* The timers are kept in a sorted list */
+/* The timers are kept in a 4-ary min-heap ordered by deadline, and found
+   by ID through a hash table. IDs are handed out in sequence, so the low
+   bits of the ID spread them evenly over the buckets. */
 typedef struct {
     /* Data used by the main thread */
     SDL_Thread *thread;
     SDL_atomic_t nextID;
-    SDL_TimerMap *timermap;
+    SDL_TimerMap **timermap;
+    int timermap_buckets;
+    int timermap_count;
     SDL_mutex *timermap_lock;
 
     /* Padding to separate cache lines between threads */
@@ -61,11 +67,14 @@ typedef struct {
     SDL_SpinLock lock;
     SDL_sem *sem;
     SDL_Timer *pending;
+    SDL_Timer *canceled;
     SDL_Timer *freelist;
     SDL_atomic_t active;
 
-    /* List of timers - this is only touched by the timer thread */
-    SDL_Timer *timers;
+    /* Heap of timers - this is only touched by the timer thread */
+    SDL_Timer **timers;
+    int numtimers;
+    int maxtimers;
 } SDL_TimerData;
 
 static SDL_TimerData SDL_timer_data;
@@ -73,39 +82,136 @@ static SDL_TimerData SDL_timer_data;
 /* The idea here is that any thread might add a timer, but a single
  * thread manages the active timer queue, sorted by scheduling time.
  *
- * Timers are removed by simply setting a canceled flag
+ * Timers are removed by setting a canceled flag and handing them to the
+ * timer thread, which takes them out of the heap on its next pass.
  */
 
+#define SDL_TIMER_HEAP_ARITY 4
+#define SDL_TIMER_MAP_BUCKETS 64
+
+/* Move the timer at 'index' up until its parent is due no later */
 static void
-SDL_AddTimerInternal(SDL_TimerData *data, SDL_Timer *timer)
+SDL_SiftTimerUp(SDL_TimerData *data, int index)
 {
-    SDL_Timer *prev, *curr;
+    SDL_Timer **timers = data->timers;
+    SDL_Timer *timer = timers[index];
 
-    prev = NULL;
-    for (curr = data->timers; curr; prev = curr, curr = curr->next) {
-        if ((Sint32)(timer->scheduled-curr->scheduled) < 0) {
+    while (index > 0) {
+        const int parent = (index - 1) / SDL_TIMER_HEAP_ARITY;
+        if (timers[parent]->scheduled <= timer->scheduled) {
             break;
         }
+        timers[index] = timers[parent];
+        timers[index]->heapindex = index;
+        index = parent;
     }
+    timers[index] = timer;
+    timer->heapindex = index;
+}
 
-    /* Insert the timer here! */
-    if (prev) {
-        prev->next = timer;
-    } else {
-        data->timers = timer;
+/* Move the timer at 'index' down until its children are all due later */
+static void
+SDL_SiftTimerDown(SDL_TimerData *data, int index)
+{
+    SDL_Timer **timers = data->timers;
+    SDL_Timer *timer = timers[index];
+    const int count = data->numtimers;
+
+    for ( ; ; ) {
+        const int first = index * SDL_TIMER_HEAP_ARITY + 1;
+        const int last = SDL_min(first + SDL_TIMER_HEAP_ARITY, count);
+        int child, earliest = -1;
+
+        for (child = first; child < last; ++child) {
+            if (timers[child]->scheduled < timer->scheduled &&
+                (earliest < 0 || timers[child]->scheduled < timers[earliest]->scheduled)) {
+                earliest = child;
+            }
+        }
+        if (earliest < 0) {
+            break;
+        }
+        timers[index] = timers[earliest];
+        timers[index]->heapindex = index;
+        index = earliest;
+    }
+    timers[index] = timer;
+    timer->heapindex = index;
+}
+
+static SDL_bool
+SDL_AddTimerInternal(SDL_TimerData *data, SDL_Timer *timer)
+{
+    SDL_Timer **timers;
+    int index;
+
+    if (data->numtimers == data->maxtimers) {
+        const int maxtimers = data->maxtimers ? data->maxtimers * 2 : 64;
+        timers = (SDL_Timer **) SDL_realloc(data->timers, maxtimers * sizeof(*timers));
+        if (!timers) {
+            return SDL_FALSE;
+        }
+        data->timers = timers;
+        data->maxtimers = maxtimers;
     }
-    timer->next = curr;
+
+    /* Insert the timer at the end and move it up to its place */
+    index = data->numtimers++;
+    data->timers[index] = timer;
+    SDL_SiftTimerUp(data, index);
+    return SDL_TRUE;
 }
 
+/* Take a timer out of the heap, wherever it is */
+static void
+SDL_RemoveTimerInternal(SDL_TimerData *data, SDL_Timer *timer)
+{
+    const int index = timer->heapindex;
+    SDL_Timer *last;
+
+    timer->heapindex = -1;
+    last = data->timers[--data->numtimers];
+    if (last != timer) {
+        data->timers[index] = last;
+        last->heapindex = index;
+        if (index > 0 && data->timers[(index - 1) / SDL_TIMER_HEAP_ARITY]->scheduled > last->scheduled) {
+            SDL_SiftTimerUp(data, index);
+        } else {
+            SDL_SiftTimerDown(data, index);
+        }
+    }
+}
+
+#if !SDL_THREAD_ORBIS
+/* Thread backends without microsecond waits round up to the millisecond
+   SDL_SemWaitTimeout() takes, so a timeout never fires early */
+int
+SDL_SemWaitTimeoutUS(SDL_sem * sem, Uint32 us)
+{
+    Uint32 ms;
+
+    if (us == SDL_MUTEX_MAXWAIT) {
+        return SDL_SemWaitTimeout(sem, SDL_MUTEX_MAXWAIT);
+    }
+    ms = us / 1000;
+    if (us % 1000) {
+        ++ms;
+    }
+    return SDL_SemWaitTimeout(sem, ms);
+}
+#endif
+
 static int SDLCALL
 SDL_TimerThread(void *_data)
 {
     SDL_TimerData *data = (SDL_TimerData *)_data;
     SDL_Timer *pending;
+    SDL_Timer *canceled;
     SDL_Timer *current;
     SDL_Timer *freelist_head = NULL;
     SDL_Timer *freelist_tail = NULL;
-    Uint32 tick, now, interval, delay;
+    Uint64 tick, now;
+    Uint32 interval, delay;
 
     /* Threaded timer loop:
      *  1. Queue timers added by other threads
@@ -116,9 +222,11 @@ SDL_TimerThread(void *_data)
         /* Pending and freelist maintenance */
         SDL_AtomicLock(&data->lock);
         {
-            /* Get any timers ready to be queued */
+            /* Get any timers ready to be queued or removed */
             pending = data->pending;
             data->pending = NULL;
+            canceled = data->canceled;
+            data->canceled = NULL;
 
             /* Make any unused timer structures available */
             if (freelist_head) {
@@ -128,38 +236,68 @@ SDL_TimerThread(void *_data)
         }
         SDL_AtomicUnlock(&data->lock);
 
-        /* Sort the pending timers into our list */
+        freelist_head = NULL;
+        freelist_tail = NULL;
+
+        /* Sort the pending timers into our heap */
         while (pending) {
             current = pending;
             pending = pending->next;
-            SDL_AddTimerInternal(data, current);
+            if (!SDL_AddTimerInternal(data, current)) {
+                /* Out of memory, the timer is dropped. If it was canceled
+                   meanwhile, the canceled list below frees it. */
+                current->heapindex = -1;
+                if (SDL_AtomicCAS(&current->canceled, 0, 1)) {
+                    current->next = freelist_head;
+                    if (!freelist_tail) {
+                        freelist_tail = current;
+                    }
+                    freelist_head = current;
+                }
+            }
+        }
+
+        /* Take canceled timers out of the heap right away, rather than
+           leaving them there until they were due */
+        while (canceled) {
+            current = canceled;
+            canceled = canceled->next_canceled;
+            if (current->heapindex >= 0) {
+                SDL_RemoveTimerInternal(data, current);
+            }
+            current->next = freelist_head;
+            if (!freelist_tail) {
+                freelist_tail = current;
+            }
+            freelist_head = current;
         }
-        freelist_head = NULL;
-        freelist_tail = NULL;
 
         /* Check to see if we're still running, after maintenance */
         if (!SDL_AtomicGet(&data->active)) {
+            if (freelist_head) {
+                SDL_AtomicLock(&data->lock);
+                freelist_tail->next = data->freelist;
+                data->freelist = freelist_head;
+                SDL_AtomicUnlock(&data->lock);
+            }
             break;
         }
 
         /* Initial delay if there are no timers */
         delay = SDL_MUTEX_MAXWAIT;
 
-        tick = SDL_GetTicks();
+        tick = SDL_GetTicksUS();
 
         /* Process all the pending timers for this tick */
-        while (data->timers) {
-            current = data->timers;
+        while (data->numtimers > 0) {
+            current = data->timers[0];
 
-            if ((Sint32)(tick-current->scheduled) < 0) {
+            if (current->scheduled > tick) {
                 /* Scheduled for the future, wait a bit */
-                delay = (current->scheduled - tick);
+                delay = (Uint32) SDL_min(current->scheduled - tick, SDL_MUTEX_MAXWAIT - 1);
                 break;
             }
 
-            /* We're going to do something with this timer */
-            data->timers = current->next;
-
             if (SDL_AtomicGet(&current->canceled)) {
                 interval = 0;
             } else {
@@ -167,30 +305,37 @@ SDL_TimerThread(void *_data)
             }
 
             if (interval > 0) {
-                /* Reschedule this timer */
+                /* Reschedule this timer from its deadline so periodic timers
+                   don't drift, unless we have fallen a whole period behind */
                 current->interval = interval;
-                current->scheduled = tick + interval;
-                SDL_AddTimerInternal(data, current);
+                current->scheduled += (Uint64) interval * 1000;
+                if (current->scheduled <= tick) {
+                    current->scheduled = tick + (Uint64) interval * 1000;
+                }
+                SDL_SiftTimerDown(data, 0);
             } else {
-                if (!freelist_head) {
+                /* Remove the timer from the heap. A timer canceled since
+                   the last pass is freed from the canceled list instead. */
+                SDL_RemoveTimerInternal(data, current);
+
+                if (SDL_AtomicCAS(&current->canceled, 0, 1)) {
+                    current->next = freelist_head;
+                    if (!freelist_tail) {
+                        freelist_tail = current;
+                    }
                     freelist_head = current;
                 }
-                if (freelist_tail) {
-                    freelist_tail->next = current;
-                }
-                freelist_tail = current;
-
-                SDL_AtomicSet(&current->canceled, 1);
             }
         }
 
         /* Adjust the delay based on processing time */
-        now = SDL_GetTicks();
-        interval = (now - tick);
-        if (interval > delay) {
-            delay = 0;
-        } else {
-            delay -= interval;
+        if (delay != SDL_MUTEX_MAXWAIT) {
+            now = SDL_GetTicksUS();
+            if (now - tick > delay) {
+                delay = 0;
+            } else {
+                delay -= (Uint32) (now - tick);
+            }
         }
 
         /* Note that each time a timer is added, this will return
@@ -198,7 +343,7 @@ SDL_TimerThread(void *_data)
            That's okay, it just means we run through the loop a few
            extra times.
          */
-        SDL_SemWaitTimeout(data->sem, delay);
+        SDL_SemWaitTimeoutUS(data->sem, delay);
     }
     return 0;
 }
@@ -210,14 +355,25 @@ SDL_TimerInit(void)
 
     if (!SDL_AtomicGet(&data->active)) {
         const char *name = "SDLTimer";
+        data->timermap = (SDL_TimerMap **) SDL_calloc(SDL_TIMER_MAP_BUCKETS, sizeof(*data->timermap));
+        if (!data->timermap) {
+            return SDL_OutOfMemory();
+        }
+        data->timermap_buckets = SDL_TIMER_MAP_BUCKETS;
+        data->timermap_count = 0;
+
         data->timermap_lock = SDL_CreateMutex();
         if (!data->timermap_lock) {
+            SDL_free(data->timermap);
+            data->timermap = NULL;
             return -1;
         }
 
         data->sem = SDL_CreateSemaphore(0);
         if (!data->sem) {
             SDL_DestroyMutex(data->timermap_lock);
+            SDL_free(data->timermap);
+            data->timermap = NULL;
             return -1;
         }
 
@@ -241,6 +397,7 @@ SDL_TimerQuit(void)
     SDL_TimerData *data = &SDL_timer_data;
     SDL_Timer *timer;
     SDL_TimerMap *entry;
+    int i;
 
     if (SDL_AtomicCAS(&data->active, 1, 0)) {  /* active? Move to inactive. */
         /* Shutdown the timer thread */
@@ -253,28 +410,70 @@ SDL_TimerQuit(void)
         SDL_DestroySemaphore(data->sem);
         data->sem = NULL;
 
-        /* Clean up the timer entries */
-        while (data->timers) {
-            timer = data->timers;
-            data->timers = timer->next;
-            SDL_free(timer);
+        /* Clean up the timer entries. Canceled timers still in the heap
+           are freed with it. */
+        while (data->canceled) {
+            timer = data->canceled;
+            data->canceled = timer->next_canceled;
+            if (timer->heapindex < 0) {
+                SDL_free(timer);
+            }
+        }
+        while (data->numtimers > 0) {
+            SDL_free(data->timers[--data->numtimers]);
         }
+        SDL_free(data->timers);
+        data->timers = NULL;
+        data->maxtimers = 0;
         while (data->freelist) {
             timer = data->freelist;
             data->freelist = timer->next;
             SDL_free(timer);
         }
-        while (data->timermap) {
-            entry = data->timermap;
-            data->timermap = entry->next;
-            SDL_free(entry);
+        for (i = 0; i < data->timermap_buckets; ++i) {
+            while (data->timermap[i]) {
+                entry = data->timermap[i];
+                data->timermap[i] = entry->next;
+                SDL_free(entry);
+            }
         }
+        SDL_free(data->timermap);
+        data->timermap = NULL;
+        data->timermap_buckets = 0;
+        data->timermap_count = 0;
 
         SDL_DestroyMutex(data->timermap_lock);
         data->timermap_lock = NULL;
     }
 }
 
+/* Double the buckets once the table is as full as it is wide, so chains
+   stay short. Called with the timermap lock held. */
+static void
+SDL_GrowTimerMap(SDL_TimerData *data)
+{
+    const int buckets = data->timermap_buckets * 2;
+    SDL_TimerMap **timermap;
+    SDL_TimerMap *entry;
+    int i;
+
+    timermap = (SDL_TimerMap **) SDL_calloc(buckets, sizeof(*timermap));
+    if (!timermap) {
+        return;  /* Keep the old table, chains just get longer */
+    }
+    for (i = 0; i < data->timermap_buckets; ++i) {
+        while (data->timermap[i]) {
+            entry = data->timermap[i];
+            data->timermap[i] = entry->next;
+            entry->next = timermap[entry->timerID & (buckets - 1)];
+            timermap[entry->timerID & (buckets - 1)] = entry;
+        }
+    }
+    SDL_free(data->timermap);
+    data->timermap = timermap;
+    data->timermap_buckets = buckets;
+}
+
 SDL_TimerID
 SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
 {
@@ -309,7 +508,8 @@ SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
     timer->callback = callback;
     timer->param = param;
     timer->interval = interval;
-    timer->scheduled = SDL_GetTicks() + interval;
+    timer->scheduled = SDL_GetTicksUS() + (Uint64) interval * 1000;
+    timer->heapindex = -1;
     SDL_AtomicSet(&timer->canceled, 0);
 
     entry = (SDL_TimerMap *)SDL_malloc(sizeof(*entry));
@@ -322,8 +522,12 @@ SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
     entry->timerID = timer->timerID;
 
     SDL_LockMutex(data->timermap_lock);
-    entry->next = data->timermap;
-    data->timermap = entry;
+    if (data->timermap_count >= data->timermap_buckets) {
+        SDL_GrowTimerMap(data);
+    }
+    entry->next = data->timermap[entry->timerID & (data->timermap_buckets - 1)];
+    data->timermap[entry->timerID & (data->timermap_buckets - 1)] = entry;
+    ++data->timermap_count;
     SDL_UnlockMutex(data->timermap_lock);
 
     /* Add the timer to the pending list for the timer thread */
@@ -343,26 +547,37 @@ SDL_RemoveTimer(SDL_TimerID id)
 {
     SDL_TimerData *data = &SDL_timer_data;
     SDL_TimerMap *prev, *entry;
+    SDL_Timer *timer;
     SDL_bool canceled = SDL_FALSE;
 
     /* Find the timer */
     SDL_LockMutex(data->timermap_lock);
     prev = NULL;
-    for (entry = data->timermap; entry; prev = entry, entry = entry->next) {
-        if (entry->timerID == id) {
-            if (prev) {
-                prev->next = entry->next;
-            } else {
-                data->timermap = entry->next;
+    entry = NULL;
+    if (data->timermap) {
+        for (entry = data->timermap[id & (data->timermap_buckets - 1)]; entry; prev = entry, entry = entry->next) {
+            if (entry->timerID == id) {
+                if (prev) {
+                    prev->next = entry->next;
+                } else {
+                    data->timermap[id & (data->timermap_buckets - 1)] = entry->next;
+                }
+                --data->timermap_count;
+                break;
             }
-            break;
         }
     }
     SDL_UnlockMutex(data->timermap_lock);
 
     if (entry) {
-        if (!SDL_AtomicGet(&entry->timer->canceled)) {
-            SDL_AtomicSet(&entry->timer->canceled, 1);
+        timer = entry->timer;
+        if (SDL_AtomicCAS(&timer->canceled, 0, 1)) {
+            /* Hand it to the timer thread to take out of the heap */
+            SDL_AtomicLock(&data->lock);
+            timer->next_canceled = data->canceled;
+            data->canceled = timer;
+            SDL_AtomicUnlock(&data->lock);
+            SDL_SemPost(data->sem);
             canceled = SDL_TRUE;
         }
         SDL_free(entry);
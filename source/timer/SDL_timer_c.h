@@ -28,6 +28,7 @@
 
 extern void SDL_TicksInit(void);
 extern void SDL_TicksQuit(void);
+extern Uint64 SDL_GetTicksUS(void);
 extern int SDL_TimerInit(void);
 extern void SDL_TimerQuit(void);
 
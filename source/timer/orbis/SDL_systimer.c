@@ -29,11 +29,40 @@
 #include <stdlib.h>
 #include <time.h>
 #include <sys/time.h>
+
+/* Without __ORBIS__ this file builds on the POSIX clock, so the timer
+   thread can be run and timed on a desktop host */
+#if defined(__ORBIS__)
 #include <kernel.h>
 
+#define ORBIS_GetProcessTime()      sceKernelGetProcessTime()
+#define ORBIS_GetTscFrequency()     sceKernelGetTscFrequency()
+#define ORBIS_ReadTsc()             sceKernelReadTsc()
+#define ORBIS_Usleep(us)            sceKernelUsleep(us)
+#else
+#include <unistd.h>
+
+static uint64_t
+ORBIS_GetProcessTime(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+#define ORBIS_GetTscFrequency()     0
+#define ORBIS_ReadTsc()             0
+#define ORBIS_Usleep(us)            usleep(us)
+#endif
+
 static uint64_t start;
 static SDL_bool ticks_started = SDL_FALSE;
 
+/* The performance counter reads the TSC; if libkernel can't tell us its
+   rate we fall back to the microsecond process time */
+static uint64_t tsc_frequency = 0;
+
 void
 SDL_TicksInit(void)
 {
@@ -42,7 +71,8 @@ SDL_TicksInit(void)
     }
     ticks_started = SDL_TRUE;
 
-    start = sceKernelGetProcessTime();
+    start = ORBIS_GetProcessTime();
+    tsc_frequency = ORBIS_GetTscFrequency();
 }
 
 void
@@ -51,30 +81,53 @@ SDL_TicksQuit(void)
     ticks_started = SDL_FALSE;
 }
 
-Uint32 SDL_GetTicks(void)
+Uint64
+SDL_GetTicks64(void)
+{
+    if (!ticks_started) {
+        SDL_TicksInit();
+    }
+
+    return (Uint64) ((ORBIS_GetProcessTime() - start) / 1000);
+}
+
+Uint64
+SDL_GetTicksUS(void)
 {
     if (!ticks_started) {
         SDL_TicksInit();
     }
 
-    uint64_t now;
-    Uint32 ticks;
+    return (Uint64) (ORBIS_GetProcessTime() - start);
+}
 
-    now = sceKernelGetProcessTime();
-    ticks = (now - start)/1000;
-    return (ticks);
+Uint32
+SDL_GetTicks(void)
+{
+    return (Uint32) SDL_GetTicks64();
 }
 
 Uint64
 SDL_GetPerformanceCounter(void)
 {
-    return SDL_GetTicks();
+    if (!ticks_started) {
+        SDL_TicksInit();
+    }
+
+    if (tsc_frequency) {
+        return ORBIS_ReadTsc();
+    }
+    return ORBIS_GetProcessTime();
 }
 
 Uint64
 SDL_GetPerformanceFrequency(void)
 {
-    return 1000;
+    if (!ticks_started) {
+        SDL_TicksInit();
+    }
+
+    return tsc_frequency ? tsc_frequency : 1000000;
 }
 
 void SDL_Delay(Uint32 ms)
@@ -82,7 +135,7 @@ void SDL_Delay(Uint32 ms)
     const Uint32 max_delay = 0xffffffffUL / 1000;
     if(ms > max_delay)
         ms = max_delay;
-    sceKernelUsleep(ms * 1000);
+    ORBIS_Usleep(ms * 1000);
 }
 
 #endif /* SDL_TIMERS_ORBIS */
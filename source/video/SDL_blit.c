@@ -20,6 +20,7 @@
 */
 #include "../SDL_internal.h"
 
+#include "SDL_job.h"
 #include "SDL_video.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
@@ -99,6 +100,93 @@ SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
     return (okay ? 0 : -1);
 }
 
+/* Conversions of at least this many pixels are split into bands of rows
+   and run on the job pool, one band per CPU core */
+#define SDL_CONVERT_BAND_PIXELS (256 * 256)
+#define SDL_MAX_CONVERT_BANDS   16
+
+typedef struct
+{
+    SDL_BlitFunc blit;
+    SDL_BlitInfo info;
+} SDL_BlitBand;
+
+static void SDLCALL
+SDL_RunBlitBand(void *data)
+{
+    SDL_BlitBand *band = (SDL_BlitBand *) data;
+
+    band->blit(&band->info);
+}
+
+/* SDL_LowerBlit() for SDL_ConvertSurface() and SDL_ConvertPixels(). Each
+   band gets its own copy of the blit info, since SDL_SoftBlit() keeps the
+   rectangle in the shared map. */
+int
+SDL_ConvertBlit(SDL_Surface * src, SDL_Rect * srcrect,
+                SDL_Surface * dst, SDL_Rect * dstrect)
+{
+    SDL_BlitBand bands[SDL_MAX_CONVERT_BANDS];
+    SDL_JobGroup *group;
+    int numbands, rows, y, i;
+
+    /* Check to make sure the blit mapping is valid, as SDL_LowerBlit() does */
+    if ((src->map->dst != dst) ||
+        (dst->format->palette &&
+         src->map->dst_palette_version != dst->format->palette->version) ||
+        (src->format->palette &&
+         src->map->src_palette_version != src->format->palette->version)) {
+        if (SDL_MapSurface(src, dst) < 0) {
+            return (-1);
+        }
+    }
+
+    /* RLE and locked surfaces, and scaling, can't be cut into bands */
+    numbands = SDL_min(SDL_GetCPUCount(), SDL_MAX_CONVERT_BANDS);
+    numbands = SDL_min(numbands, srcrect->h);
+    if (src->map->blit != SDL_SoftBlit ||
+        SDL_MUSTLOCK(src) || SDL_MUSTLOCK(dst) ||
+        srcrect->w != dstrect->w || srcrect->h != dstrect->h ||
+        srcrect->w * srcrect->h < SDL_CONVERT_BAND_PIXELS || numbands < 2) {
+        return (src->map->blit(src, srcrect, dst, dstrect));
+    }
+
+    group = SDL_CreateJobGroup();
+    if (!group) {
+        return (src->map->blit(src, srcrect, dst, dstrect));
+    }
+
+    rows = (srcrect->h + numbands - 1) / numbands;
+    for (i = 0, y = 0; y < srcrect->h; ++i, y += rows) {
+        SDL_BlitBand *band = &bands[i];
+        SDL_BlitInfo *info = &band->info;
+
+        *info = src->map->info;
+        info->src = (Uint8 *) src->pixels +
+            (srcrect->y + y) * src->pitch +
+            srcrect->x * info->src_fmt->BytesPerPixel;
+        info->src_w = srcrect->w;
+        info->src_h = SDL_min(rows, srcrect->h - y);
+        info->src_pitch = src->pitch;
+        info->src_skip =
+            info->src_pitch - info->src_w * info->src_fmt->BytesPerPixel;
+        info->dst = (Uint8 *) dst->pixels +
+            (dstrect->y + y) * dst->pitch +
+            dstrect->x * info->dst_fmt->BytesPerPixel;
+        info->dst_w = info->src_w;
+        info->dst_h = info->src_h;
+        info->dst_pitch = dst->pitch;
+        info->dst_skip =
+            info->dst_pitch - info->dst_w * info->dst_fmt->BytesPerPixel;
+        band->blit = (SDL_BlitFunc) src->map->data;
+
+        SDL_RunJob(group, SDL_RunBlitBand, band);
+    }
+    SDL_WaitJobGroup(group);
+    SDL_DestroyJobGroup(group);
+    return 0;
+}
+
 #ifdef __MACOSX__
 #include <sys/sysctl.h>
 
@@ -29,6 +29,8 @@
 #include "SDL_log.h"
 #include "SDL_orbisvideo.h"
 #include "SDL_orbiskeyboard.h"
+#include "SDL_timer.h"
+#include "../../events/SDL_events_c.h"
 #include "../../events/SDL_keyboard_c.h"
 
 int keyboard_hid_handle = -1;
@@ -59,6 +61,7 @@ ORBIS_PollKeyboard(void)
 	if (keyboard_hid_handle == 0)
 	{
 		orbisKeyboardUpdate();
+		SDL_SetEventSampleTime(SDL_GetPerformanceCounter());
 		
 		// Numlock and Capslock state changes only on a SDL_PRESSED event
 		if (orbisKeyboardGetCapsKey()) {
@@ -156,6 +159,7 @@ ORBIS_PollKeyboard(void)
 			}
 			prev_key = keyCode;
 		}
+		SDL_SetEventSampleTime(0);
 	}
 }
 
@@ -30,6 +30,7 @@
 #include "SDL_syswm.h"
 #include "SDL_loadso.h"
 #include "SDL_events.h"
+#include "SDL_hints.h"
 #include "../../events/SDL_mouse_c.h"
 #include "../../events/SDL_keyboard_c.h"
 
@@ -40,6 +41,8 @@
 
 SDL_Window *Orbis_Window;
 
+extern int64_t flipArg;
+
 /* unused
 static SDL_bool ORBIS_initialized = SDL_FALSE;
 */
@@ -121,6 +124,9 @@ ORBIS_Create()
     device->RestoreWindow = ORBIS_RestoreWindow;
     device->SetWindowGrab = ORBIS_SetWindowGrab;
     device->DestroyWindow = ORBIS_DestroyWindow;
+    device->CreateWindowFramebuffer = ORBIS_CreateWindowFramebuffer;
+    device->UpdateWindowFramebuffer = ORBIS_UpdateWindowFramebuffer;
+    device->DestroyWindowFramebuffer = ORBIS_DestroyWindowFramebuffer;
     device->GetWindowWMInfo = ORBIS_GetWindowWMInfo;
     device->HasScreenKeyboardSupport = ORBIS_HasScreenKeyboardSupport;
     device->ShowScreenKeyboard = ORBIS_ShowScreenKeyboard;
@@ -147,11 +153,14 @@ ORBIS_VideoInit(_THIS)
 {
     SDL_VideoDisplay display;
     SDL_DisplayMode current_mode;
+    Orbis2dConfig *conf = orbis2dGetConf();
 
     SDL_zero(current_mode);
 
-    current_mode.w = 1280;
-    current_mode.h = 720;
+    /* orbis2d was set up by the application, use whatever output
+       resolution it picked (1280x720, 1920x1080, ...) */
+    current_mode.w = conf->width;
+    current_mode.h = conf->height;
 
     current_mode.refresh_rate = 60;
     /* 32 bpp for default */
@@ -276,6 +285,106 @@ ORBIS_DestroyWindow(_THIS, SDL_Window * window)
 {
 }
 
+/*****************************************************************************/
+/* SDL window surface functions                                              */
+/*****************************************************************************/
+int
+ORBIS_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * format, void ** pixels, int *pitch)
+{
+    SDL_WindowData *wdata = (SDL_WindowData *) window->driverdata;
+    Orbis2dConfig *conf = orbis2dGetConf();
+
+    if (window->w > conf->width || window->h > conf->height) {
+        return SDL_SetError("Window is larger than the %dx%d framebuffer", conf->width, conf->height);
+    }
+
+    if (!wdata->framebuffer_drawing) {
+        orbis2dStartDrawing();
+        wdata->framebuffer_drawing = SDL_TRUE;
+    }
+    wdata->framebuffer_preserve = SDL_GetHintBoolean(SDL_HINT_ORBIS_PRESERVE_WINDOW_SURFACE, SDL_FALSE);
+
+    /* No shadow surface, the window surface is the back buffer itself */
+    *format = SDL_PIXELFORMAT_ARGB8888;
+    *pixels = (void *) conf->surfaceAddr[conf->currentBuffer];
+    *pitch = conf->pitch * 4;
+    return 0;
+}
+
+int
+ORBIS_UpdateWindowFramebuffer(_THIS, SDL_Window * window, const SDL_Rect * rects, int numrects)
+{
+    SDL_WindowData *wdata = (SDL_WindowData *) window->driverdata;
+    Orbis2dConfig *conf = orbis2dGetConf();
+    const int pitch = conf->pitch * 4;
+    const int front = conf->currentBuffer;
+    SDL_Rect bounds, rect;
+    int i, row;
+
+    if (!wdata->framebuffer_drawing) {
+        orbis2dStartDrawing();
+    }
+    orbis2dFinishDrawing(flipArg);
+    orbis2dSwapBuffers();
+    flipArg++;
+    orbis2dStartDrawing();
+    wdata->framebuffer_drawing = SDL_TRUE;
+
+    /* Point the window surface at the new back buffer */
+    window->surface->pixels = (void *) conf->surfaceAddr[conf->currentBuffer];
+
+    /* The new back buffer still holds the frame before last. What changed
+       since is what this update covered, so a partial update carries its
+       rects over from the front buffer. After a full update the contents
+       are undefined, unless SDL_HINT_ORBIS_PRESERVE_WINDOW_SURFACE asks
+       for the full-screen copy. */
+    if (conf->currentBuffer == front) {
+        return 0;
+    }
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = window->w;
+    bounds.h = window->h;
+    for (i = 0; i < numrects; ++i) {
+        if (SDL_IntersectRect(&rects[i], &bounds, &rect) && SDL_RectEquals(&rect, &bounds)) {
+            if (!wdata->framebuffer_preserve) {
+                return 0;
+            }
+            rects = &bounds;
+            numrects = 1;
+            break;
+        }
+    }
+
+    for (i = 0; i < numrects; ++i) {
+        const Uint8 *src;
+        Uint8 *dst;
+
+        if (!SDL_IntersectRect(&rects[i], &bounds, &rect)) {
+            continue;
+        }
+        src = (const Uint8 *) conf->surfaceAddr[front] + rect.y * pitch + rect.x * 4;
+        dst = (Uint8 *) conf->surfaceAddr[conf->currentBuffer] + rect.y * pitch + rect.x * 4;
+        for (row = 0; row < rect.h; ++row) {
+            SDL_memcpy(dst, src, rect.w * 4);
+            src += pitch;
+            dst += pitch;
+        }
+    }
+    return 0;
+}
+
+void
+ORBIS_DestroyWindowFramebuffer(_THIS, SDL_Window * window)
+{
+    SDL_WindowData *wdata = (SDL_WindowData *) window->driverdata;
+
+    /* The buffers belong to orbis2d, there is nothing to free */
+    if (wdata) {
+        wdata->framebuffer_drawing = SDL_FALSE;
+    }
+}
+
 /*****************************************************************************/
 /* SDL Window Manager function                                               */
 /*****************************************************************************/
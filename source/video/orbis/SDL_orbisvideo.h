@@ -42,6 +42,8 @@ typedef struct SDL_DisplayData
 typedef struct SDL_WindowData
 {
     SDL_bool uses_gl;			/* if true window must support OpenGL */
+    SDL_bool framebuffer_drawing;	/* orbis2d frame started for the window surface */
+    SDL_bool framebuffer_preserve;	/* SDL_HINT_ORBIS_PRESERVE_WINDOW_SURFACE */
 
 } SDL_WindowData;
 
@@ -72,6 +74,11 @@ void ORBIS_RestoreWindow(_THIS, SDL_Window * window);
 void ORBIS_SetWindowGrab(_THIS, SDL_Window * window, SDL_bool grabbed);
 void ORBIS_DestroyWindow(_THIS, SDL_Window * window);
 
+/* Window surface, drawn straight into the orbis2d back buffer */
+int ORBIS_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * format, void ** pixels, int *pitch);
+int ORBIS_UpdateWindowFramebuffer(_THIS, SDL_Window * window, const SDL_Rect * rects, int numrects);
+void ORBIS_DestroyWindowFramebuffer(_THIS, SDL_Window * window);
+
 /* Window manager function */
 SDL_bool ORBIS_GetWindowWMInfo(_THIS, SDL_Window * window,
                              struct SDL_SysWMinfo *info);
@@ -0,0 +1,308 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks SDL_AudioMixer: the SSE2 kernels against the scalar ones, voices
+   starting on their scheduled frame, flushed voices playing out, and gain
+   and pan. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Built in, so the tests can call the mixing kernels */
+#include "../source/audio/SDL_audiomixer.c"
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+#define FREQ        48000
+#define CALLBACK_FRAMES 1024
+
+static int failures = 0;
+
+static float
+RandomSample(void)
+{
+    return (float) rand() / RAND_MAX * 2.0f - 1.0f;
+}
+
+static SDL_bool
+NearlyEqual(float a, float b)
+{
+    return ((a > b) ? a - b : b - a) <= 1e-6f;
+}
+
+#if HAVE_SSE2_INTRINSICS
+/* Every channel count the SSE2 kernel is used for, with frame counts that
+   leave a tail after the 8-sample loop */
+static void
+TestMixVoiceSSE2(void)
+{
+    static const int channels[] = { 1, 2, 4, 8 };
+    float src[8 * 37], scalar[8 * 37], sse2[8 * 37], gains[8];
+    int c, i, frames, samples, ok = 1;
+
+    for (c = 0; c < SDL_arraysize(channels); c++) {
+        const int chans = channels[c];
+
+        for (i = 0; i < chans; i++) {
+            gains[i] = RandomSample();
+        }
+        for (frames = 1; frames <= 37; frames += 3) {
+            samples = frames * chans;
+            for (i = 0; i < samples; i++) {
+                src[i] = RandomSample();
+                scalar[i] = sse2[i] = RandomSample();
+            }
+            SDL_MixVoice_Scalar(scalar, src, samples, gains, chans);
+            SDL_MixVoice_SSE2(sse2, src, samples, gains, chans);
+            for (i = 0; i < samples; i++) {
+                ok &= NearlyEqual(scalar[i], sse2[i]);
+            }
+        }
+    }
+    CHECK(ok);
+}
+
+static void
+TestClampMixSSE2(void)
+{
+    float scalar[67], sse2[67];
+    int i, ok = 1;
+
+    for (i = 0; i < SDL_arraysize(scalar); i++) {
+        scalar[i] = sse2[i] = RandomSample() * 3.0f;
+    }
+    SDL_ClampMix_Scalar(scalar, SDL_arraysize(scalar));
+    SDL_ClampMix_SSE2(sse2, SDL_arraysize(sse2));
+    for (i = 0; i < SDL_arraysize(scalar); i++) {
+        ok &= (scalar[i] == sse2[i]) && scalar[i] >= -1.0f && scalar[i] <= 1.0f;
+    }
+    CHECK(ok);
+}
+#endif
+
+/* A stereo float mixer, with voices in the same format so no resampling
+   shifts the output */
+static SDL_AudioMixer *
+CreateMixer(void)
+{
+    SDL_AudioSpec spec;
+
+    SDL_zero(spec);
+    spec.freq = FREQ;
+    spec.format = AUDIO_F32SYS;
+    spec.channels = 2;
+    return SDL_NewAudioMixer(&spec);
+}
+
+/* Queue 'frames' frames of a constant left and right sample */
+static int
+PutFrames(SDL_AudioMixer *mixer, SDL_AudioVoiceID voice, int frames, float left, float right)
+{
+    float *buf = (float *) SDL_malloc(frames * 2 * sizeof (float));
+    int i, retval;
+
+    for (i = 0; i < frames; i++) {
+        buf[i * 2] = left;
+        buf[i * 2 + 1] = right;
+    }
+    retval = SDL_AudioMixerPutVoice(mixer, voice, buf, frames * 2 * (int) sizeof (float));
+    SDL_free(buf);
+    return retval;
+}
+
+static SDL_AudioVoiceID
+CreateVoice(SDL_AudioMixer *mixer, int frames, float left, float right)
+{
+    const SDL_AudioVoiceID voice = SDL_AudioMixerNewVoice(mixer, AUDIO_F32SYS, 2, FREQ);
+
+    PutFrames(mixer, voice, frames, left, right);
+    return voice;
+}
+
+static void
+RunCallback(SDL_AudioMixer *mixer, float *out)
+{
+    SDL_AudioMixerCallback(mixer, (Uint8 *) out, CALLBACK_FRAMES * 2 * sizeof (float));
+}
+
+/* Index of the first frame with any sound in it, or -1 */
+static int
+FirstSoundingFrame(const float *out)
+{
+    int i;
+
+    for (i = 0; i < CALLBACK_FRAMES; i++) {
+        if (out[i * 2] != 0.0f || out[i * 2 + 1] != 0.0f) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void
+TestScheduledStart(void)
+{
+    SDL_AudioMixer *mixer = CreateMixer();
+    float out[CALLBACK_FRAMES * 2];
+    SDL_AudioVoiceID voice;
+
+    CHECK(mixer != NULL);
+    CHECK(SDL_AudioMixerPosition(mixer) == 0);
+
+    /* Inside the next callback */
+    voice = CreateVoice(mixer, 4096, 0.5f, 0.5f);
+    CHECK(SDL_AudioMixerPlayVoice(mixer, voice, 300) == 0);
+    RunCallback(mixer, out);
+    CHECK(FirstSoundingFrame(out) == 300);
+    CHECK(out[300 * 2] == 0.5f && out[CALLBACK_FRAMES * 2 - 1] == 0.5f);
+    CHECK(SDL_AudioMixerPosition(mixer) == CALLBACK_FRAMES);
+    SDL_AudioMixerFreeVoice(mixer, voice);
+
+    /* Two callbacks out, the first stays silent */
+    voice = CreateVoice(mixer, 4096, 0.5f, 0.5f);
+    SDL_AudioMixerPlayVoice(mixer, voice, 2 * CALLBACK_FRAMES + 476);
+    RunCallback(mixer, out);
+    CHECK(FirstSoundingFrame(out) == -1);
+    RunCallback(mixer, out);
+    CHECK(FirstSoundingFrame(out) == 476);
+
+    /* A frame already mixed starts at once */
+    SDL_AudioMixerStopVoice(mixer, voice);
+    RunCallback(mixer, out);
+    CHECK(FirstSoundingFrame(out) == -1);
+    SDL_AudioMixerPlayVoice(mixer, voice, 0);
+    RunCallback(mixer, out);
+    CHECK(FirstSoundingFrame(out) == 0);
+
+    SDL_FreeAudioMixer(mixer);
+}
+
+static void
+TestFlushPlaysOut(void)
+{
+    SDL_AudioMixer *mixer = CreateMixer();
+    float out[CALLBACK_FRAMES * 2];
+    SDL_AudioVoiceID voice = CreateVoice(mixer, 100, 0.25f, 0.25f);
+
+    CHECK(!SDL_AudioMixerVoicePlaying(mixer, voice));
+    SDL_AudioMixerPlayVoice(mixer, voice, 0);
+    CHECK(SDL_AudioMixerVoicePlaying(mixer, voice));
+
+    /* Not flushed yet, so it keeps playing once it runs dry */
+    RunCallback(mixer, out);
+    CHECK(out[0] == 0.25f && out[99 * 2] == 0.25f && out[100 * 2] == 0.0f);
+    CHECK(SDL_AudioMixerVoicePlaying(mixer, voice));
+
+    CHECK(PutFrames(mixer, voice, 200, 0.25f, 0.25f) == 0);
+    CHECK(SDL_AudioMixerFlushVoice(mixer, voice) == 0);
+    CHECK(PutFrames(mixer, voice, 1, 0.25f, 0.25f) < 0);
+    CHECK(SDL_AudioMixerVoicePlaying(mixer, voice));
+    RunCallback(mixer, out);
+    CHECK(out[199 * 2] == 0.25f && out[200 * 2] == 0.0f);
+    CHECK(!SDL_AudioMixerVoicePlaying(mixer, voice));
+
+    SDL_AudioMixerFreeVoice(mixer, voice);
+    CHECK(!SDL_AudioMixerVoicePlaying(mixer, voice));
+    CHECK(SDL_AudioMixerPlayVoice(mixer, voice, 0) < 0);
+
+    SDL_FreeAudioMixer(mixer);
+}
+
+/* Left and right output of a full scale voice with this gain and pan */
+static void
+MixGainPan(float gain, float pan, float *left, float *right)
+{
+    SDL_AudioMixer *mixer = CreateMixer();
+    float out[CALLBACK_FRAMES * 2];
+    SDL_AudioVoiceID voice = CreateVoice(mixer, CALLBACK_FRAMES, 1.0f, 1.0f);
+
+    SDL_AudioMixerSetVoiceGain(mixer, voice, gain);
+    SDL_AudioMixerSetVoicePan(mixer, voice, pan);
+    SDL_AudioMixerPlayVoice(mixer, voice, 0);
+    RunCallback(mixer, out);
+    *left = out[0];
+    *right = out[1];
+    SDL_FreeAudioMixer(mixer);
+}
+
+static void
+TestGainPan(void)
+{
+    float left, right;
+
+    MixGainPan(1.0f, 0.0f, &left, &right);
+    CHECK(left == 1.0f && right == 1.0f);
+    MixGainPan(0.5f, 0.0f, &left, &right);
+    CHECK(left == 0.5f && right == 0.5f);
+
+    /* Panning only ever turns the far side down */
+    MixGainPan(1.0f, -1.0f, &left, &right);
+    CHECK(left == 1.0f && right == 0.0f);
+    MixGainPan(1.0f, 1.0f, &left, &right);
+    CHECK(left == 0.0f && right == 1.0f);
+    MixGainPan(0.5f, 0.5f, &left, &right);
+    CHECK(left == 0.25f && right == 0.5f);
+
+    /* Out of range pans are clamped */
+    MixGainPan(1.0f, -3.0f, &left, &right);
+    CHECK(left == 1.0f && right == 0.0f);
+}
+
+/* Voices add up and the sum is clamped to full scale */
+static void
+TestMixAndClamp(void)
+{
+    SDL_AudioMixer *mixer = CreateMixer();
+    float out[CALLBACK_FRAMES * 2];
+    SDL_AudioVoiceID a = CreateVoice(mixer, CALLBACK_FRAMES, 0.25f, -0.75f);
+    SDL_AudioVoiceID b = CreateVoice(mixer, CALLBACK_FRAMES, 0.5f, -0.75f);
+
+    SDL_AudioMixerPlayVoice(mixer, a, 0);
+    SDL_AudioMixerPlayVoice(mixer, b, 0);
+    RunCallback(mixer, out);
+    CHECK(out[0] == 0.75f && out[1] == -1.0f);
+
+    SDL_FreeAudioMixer(mixer);
+}
+
+int
+main(int argc, char *argv[])
+{
+    srand(1);
+
+#if HAVE_SSE2_INTRINSICS
+    TestMixVoiceSSE2();
+    TestClampMixSSE2();
+#else
+    printf("testaudiomixer: no SSE2, only checking the scalar kernels\n");
+#endif
+    TestScheduledStart();
+    TestFlushPlaysOut();
+    TestGainPan();
+    TestMixAndClamp();
+
+    if (failures) {
+        printf("testaudiomixer: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("testaudiomixer: all checks passed\n");
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
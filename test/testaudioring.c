@@ -0,0 +1,339 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks the lock-free queue of SDL_HINT_AUDIO_QUEUE_LOCKFREE: queueing
+   and draining across the end of the ring, refusing data that doesn't
+   fit, clearing while the audio thread drains, and the underrun count. */
+
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Built in, so the tests can drive the ring without an audio driver */
+#include "../source/audio/SDL_audio.c"
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+#define RING_SIZE   64
+#define DEVICE_ID   1
+
+/* The host config names the dummy driver, which this tree doesn't ship */
+AudioBootStrap DUMMYAUDIO_bootstrap = {
+    "dummy", "SDL dummy audio driver", NULL, SDL_FALSE
+};
+
+static int failures = 0;
+
+/* SDL_audio.c's hooks into SDL_Init() and the event queue, which the ring
+   doesn't use */
+Uint32
+SDL_WasInit(Uint32 flags)
+{
+    return flags;
+}
+
+int
+SDL_InitSubSystem(Uint32 flags)
+{
+    return 0;
+}
+
+Uint8
+SDL_EventState(Uint32 type, int state)
+{
+    return SDL_IGNORE;
+}
+
+int
+SDL_PushEvent(SDL_Event *event)
+{
+    return 0;
+}
+
+static SDL_AudioDevice device;
+static Uint8 ring[RING_SIZE];
+
+/* A playback device as SDL_OpenAudioDevice() sets it up for the ring, with
+   its positions starting at 'start' */
+static void
+SetupRing(Uint32 start)
+{
+    SDL_zero(device);
+    device.id = DEVICE_ID;
+    device.ring = ring;
+    device.ring_size = RING_SIZE;
+    device.callbackspec.callback = SDL_BufferRingDrainCallback;
+    device.callbackspec.userdata = &device;
+    SDL_AtomicSet(&device.ring_head, (int) start);
+    SDL_AtomicSet(&device.ring_tail, (int) start);
+    SDL_AtomicSet(&device.ring_clear, (int) start);
+    open_devices[DEVICE_ID - 1] = &device;
+
+    current_audio.impl.LockDevice = SDL_AudioLockOrUnlockDeviceWithNoMixerLock;
+    current_audio.impl.UnlockDevice = SDL_AudioLockOrUnlockDeviceWithNoMixerLock;
+    current_audio.impl.GetPendingBytes = SDL_AudioGetPendingBytes_Default;
+}
+
+/* Queues 'len' bytes counting up from 'value', never zero, which is silence */
+static int
+QueueBytes(Uint8 *value, int len)
+{
+    Uint8 data[RING_SIZE * 2];
+    int i;
+
+    for (i = 0; i < len; i++) {
+        data[i] = *value;
+        *value = (*value == 0xFF) ? 1 : *value + 1;
+    }
+    return SDL_QueueAudio(DEVICE_ID, data, len);
+}
+
+/* Drains 'len' bytes and checks they count up from 'value', followed by
+   'silent' bytes of silence */
+static int
+DrainBytes(Uint8 *value, int len, int silent)
+{
+    Uint8 stream[RING_SIZE * 2];
+    int i, ok = 1;
+
+    SDL_memset(stream, 0xAA, sizeof (stream));
+    SDL_BufferRingDrainCallback(&device, stream, len + silent);
+    for (i = 0; i < len; i++) {
+        ok &= (stream[i] == *value);
+        *value = (*value == 0xFF) ? 1 : *value + 1;
+    }
+    for (i = len; i < len + silent; i++) {
+        ok &= (stream[i] == 0);
+    }
+    return ok;
+}
+
+static SDL_AudioQueueStats
+GetStats(void)
+{
+    SDL_AudioQueueStats stats;
+
+    SDL_zero(stats);
+    SDL_GetQueuedAudioStats(DEVICE_ID, &stats);
+    return stats;
+}
+
+/* Positions are free-running, so the byte offsets and the 32-bit counters
+   both wrap */
+static void
+TestWrap(void)
+{
+    Uint8 in = 1, out = 1;
+    int i, ok = 1;
+
+    SetupRing(0xFFFFFFF0);
+    for (i = 0; i < 20; i++) {
+        CHECK(QueueBytes(&in, 40) == 0);
+        CHECK(SDL_GetQueuedAudioSize(DEVICE_ID) == 40);
+        ok &= DrainBytes(&out, 40, 0);
+        CHECK(SDL_GetQueuedAudioSize(DEVICE_ID) == 0);
+    }
+    CHECK(ok);
+    CHECK((Uint32) SDL_AtomicGet(&device.ring_tail) == 0xFFFFFFF0 + 20 * 40);
+
+    /* Two queues filling the ring exactly, drained in odd sizes */
+    CHECK(QueueBytes(&in, 25) == 0);
+    CHECK(QueueBytes(&in, 39) == 0);
+    CHECK(SDL_GetQueuedAudioSize(DEVICE_ID) == RING_SIZE);
+    CHECK(DrainBytes(&out, 7, 0));
+    CHECK(DrainBytes(&out, 50, 0));
+    CHECK(DrainBytes(&out, 7, 9));
+    CHECK(GetStats().underruns == 1);
+    CHECK(GetStats().overruns == 0);
+
+    /* A drain with no clear pending keeps the clear position on the tail */
+    CHECK(SDL_AtomicGet(&device.ring_clear) == SDL_AtomicGet(&device.ring_tail));
+}
+
+static void
+TestOverrun(void)
+{
+    Uint8 in = 1, out = 1;
+
+    SetupRing(RING_SIZE - 8);
+    CHECK(QueueBytes(&in, RING_SIZE) == 0);
+    CHECK(SDL_QueueAudio(DEVICE_ID, &in, 0) == 0);
+
+    /* Refused whole, nothing is written */
+    CHECK(QueueBytes(&in, 1) < 0);
+    CHECK(GetStats().overruns == 1);
+    CHECK(SDL_GetQueuedAudioSize(DEVICE_ID) == RING_SIZE);
+    in = 1 + RING_SIZE;
+
+    CHECK(DrainBytes(&out, 16, 0));
+    CHECK(QueueBytes(&in, 17) < 0);
+    CHECK(GetStats().overruns == 2);
+    in = 1 + RING_SIZE;
+    CHECK(QueueBytes(&in, 16) == 0);
+    CHECK(DrainBytes(&out, RING_SIZE, 0));
+    CHECK(GetStats().overruns == 2);
+    CHECK(GetStats().underruns == 0);
+}
+
+/* The clear only skips the drain ahead; until the drain has moved past the
+   cleared bytes they still take up room, as it may be copying them */
+static void
+TestClear(void)
+{
+    Uint8 in = 1, out;
+    Uint32 head;
+
+    SetupRing(0xFFFFFFE0);
+    CHECK(QueueBytes(&in, 48) == 0);
+    out = 1;
+    CHECK(DrainBytes(&out, 16, 0));
+    SDL_ClearQueuedAudio(DEVICE_ID);
+    CHECK(SDL_GetQueuedAudioSize(DEVICE_ID) == 0);
+
+    CHECK(QueueBytes(&in, 33) < 0);
+    CHECK(GetStats().overruns == 1);
+    in = 49;
+    out = 49;
+    CHECK(QueueBytes(&in, 32) == 0);
+    CHECK(SDL_GetQueuedAudioSize(DEVICE_ID) == 32);
+
+    /* Only the bytes queued since the clear play, then it's all free */
+    CHECK(DrainBytes(&out, 32, 8));
+    CHECK(SDL_GetQueuedAudioSize(DEVICE_ID) == 0);
+    CHECK(SDL_AtomicGet(&device.ring_clear) == SDL_AtomicGet(&device.ring_tail));
+    CHECK(QueueBytes(&in, RING_SIZE) == 0);
+    CHECK(DrainBytes(&out, RING_SIZE, 0));
+
+    /* A clear after the head was read can't make the size go negative */
+    head = (Uint32) SDL_AtomicGet(&device.ring_head);
+    CHECK(QueueBytes(&in, 16) == 0);
+    SDL_ClearQueuedAudio(DEVICE_ID);
+    CHECK(SDL_AudioRingQueued(&device, head, (Uint32) SDL_AtomicGet(&device.ring_tail)) == 0);
+}
+
+#define RACE_VALUES 200000
+
+static SDL_atomic_t race_done;
+
+/* Queues a counter that only goes up, clearing now and then */
+static int SDLCALL
+QueueThread(void *data)
+{
+    Uint32 value = 1, chunk[4];
+    int i;
+
+    while (value < RACE_VALUES) {
+        for (i = 0; i < SDL_arraysize(chunk); i++) {
+            chunk[i] = value + i;
+        }
+        if (SDL_QueueAudio(DEVICE_ID, chunk, sizeof (chunk)) == 0) {
+            value += SDL_arraysize(chunk);
+            if ((value % 64) == 1) {
+                SDL_ClearQueuedAudio(DEVICE_ID);
+            }
+        } else {
+            sched_yield();  /* full, let the drain run on a single CPU */
+        }
+    }
+    SDL_AtomicSet(&race_done, 1);
+    return 0;
+}
+
+/* The audio thread's side: whatever a clear drops, what plays never goes
+   back to older data, which it would if the queue wrote over bytes still
+   being copied or a clear moved the tail past the head the drain read.
+   The windows are a few instructions wide, so this needs more than one
+   CPU to have a real chance of hitting them. */
+static void
+TestClearRace(void)
+{
+    Uint32 stream[RING_SIZE / sizeof (Uint32) - 4];
+    Uint32 last = 0;
+    SDL_Thread *thread;
+    int i, ok = 1;
+
+    SetupRing(0);
+    SDL_AtomicSet(&race_done, 0);
+    thread = SDL_CreateThread(QueueThread, "queue", NULL);
+    while (!SDL_AtomicGet(&race_done)) {
+        SDL_BufferRingDrainCallback(&device, (Uint8 *) stream, sizeof (stream));
+        for (i = 0; i < SDL_arraysize(stream); i++) {
+            if (stream[i] != 0) {
+                ok &= (stream[i] > last);
+                last = stream[i];
+            }
+        }
+        if (device.starved) {
+            sched_yield();
+        }
+    }
+    SDL_WaitThread(thread, NULL);
+    CHECK(ok);
+    CHECK(last > 0);
+
+    SDL_ClearQueuedAudio(DEVICE_ID);
+    SDL_BufferRingDrainCallback(&device, (Uint8 *) stream, sizeof (stream));
+    CHECK(stream[0] == 0);
+    CHECK(SDL_AtomicGet(&device.ring_tail) == SDL_AtomicGet(&device.ring_head));
+}
+
+/* Running dry counts once, however many buffers it lasts */
+static void
+TestUnderrun(void)
+{
+    Uint8 in = 1, out = 1;
+
+    SetupRing(0);
+    CHECK(DrainBytes(&out, 0, 16));
+    CHECK(GetStats().underruns == 1);
+    CHECK(DrainBytes(&out, 0, 16));
+    CHECK(GetStats().underruns == 1);
+
+    CHECK(QueueBytes(&in, 16) == 0);
+    CHECK(DrainBytes(&out, 16, 0));
+    CHECK(!device.starved);
+    CHECK(GetStats().underruns == 1);
+
+    /* Partly filled counts as running dry */
+    CHECK(QueueBytes(&in, 8) == 0);
+    CHECK(DrainBytes(&out, 8, 8));
+    CHECK(GetStats().underruns == 2);
+    CHECK(DrainBytes(&out, 0, 16));
+    CHECK(GetStats().underruns == 2);
+    CHECK(GetStats().overruns == 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    TestWrap();
+    TestOverrun();
+    TestClear();
+    TestClearRace();
+    TestUnderrun();
+    open_devices[DEVICE_ID - 1] = NULL;
+
+    if (failures) {
+        printf("testaudioring: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("testaudioring: all checks passed\n");
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,29 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* What the audio conversion code links against besides the sources under
+   test, on top of testthreadstubs.c. As in testrenderstubs.c, the C
+   library wrappers go straight to libc, since SDL_stdlib.c needs the libm
+   sources the tree doesn't ship.
+ */
+
+#include <math.h>
+
+#include "SDL_internal.h"
+
+/* libc */
+double SDL_ceil(double x) { return ceil(x); }
+double SDL_pow(double x, double y) { return pow(x, y); }
+double SDL_sqrt(double x) { return sqrt(x); }
+float SDL_sinf(float x) { return sinf(x); }
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,260 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks the job system on the POSIX build of the ORBIS thread backend.
+   Run with --bench to time the same work on pools of 1 to 16 CPUs, and
+   the cost of a job that does nothing. */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "SDL_internal.h"
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_job.h"
+#include "SDL_timer.h"
+#include "../source/thread/SDL_job_c.h"
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+static int failures = 0;
+
+/* The pool is sized from this, so the benchmark can pick the CPU count */
+static int cpu_count = 4;
+
+int
+SDL_GetCPUCount(void)
+{
+    return cpu_count;
+}
+
+static SDL_atomic_t count;
+
+static void SDLCALL
+CountJob(void *data)
+{
+    SDL_AtomicIncRef(&count);
+}
+
+static void
+TestRunJobs(void)
+{
+    SDL_JobGroup *group = SDL_CreateJobGroup();
+    int i;
+
+    CHECK(SDL_GetJobWorkerCount() == cpu_count - 1);
+
+    SDL_AtomicSet(&count, 0);
+    for (i = 0; i < 1000; ++i) {
+        CHECK(SDL_RunJob(group, CountJob, NULL) == 0);
+    }
+    SDL_WaitJobGroup(group);
+    CHECK(SDL_AtomicGet(&count) == 1000);
+
+    /* Waiting on a finished group returns at once */
+    SDL_WaitJobGroup(group);
+    SDL_DestroyJobGroup(group);
+}
+
+/* Each job starts four jobs one level down and waits for them */
+static void SDLCALL
+TreeJob(void *data)
+{
+    const int depth = (int) (intptr_t) data;
+    SDL_JobGroup *group;
+    int i;
+
+    SDL_AtomicIncRef(&count);
+    if (depth == 0) {
+        return;
+    }
+    group = SDL_CreateJobGroup();
+    for (i = 0; i < 4; ++i) {
+        SDL_RunJob(group, TreeJob, (void *) (intptr_t) (depth - 1));
+    }
+    SDL_WaitJobGroup(group);
+    SDL_DestroyJobGroup(group);
+}
+
+static void
+TestNestedJobs(void)
+{
+    SDL_JobGroup *group = SDL_CreateJobGroup();
+
+    /* 1 + 4 + 16 + 64 + 256 + 1024 jobs */
+    SDL_AtomicSet(&count, 0);
+    SDL_RunJob(group, TreeJob, (void *) (intptr_t) 5);
+    SDL_WaitJobGroup(group);
+    CHECK(SDL_AtomicGet(&count) == 1365);
+    SDL_DestroyJobGroup(group);
+}
+
+/* The group is freed as soon as the wait returns, with workers possibly
+   still finishing up their last job */
+static void
+TestDestroyAfterWait(void)
+{
+    int i, j;
+
+    SDL_AtomicSet(&count, 0);
+    for (i = 0; i < 1000; ++i) {
+        SDL_JobGroup *group = SDL_CreateJobGroup();
+        for (j = 0; j < 4; ++j) {
+            SDL_RunJob(group, CountJob, NULL);
+        }
+        SDL_WaitJobGroup(group);
+        SDL_DestroyJobGroup(group);
+    }
+    CHECK(SDL_AtomicGet(&count) == 4000);
+}
+
+static void
+TestUngroupedJobs(void)
+{
+    int i;
+
+    SDL_AtomicSet(&count, 0);
+    for (i = 0; i < 100; ++i) {
+        SDL_RunJob(NULL, CountJob, NULL);
+    }
+    for (i = 0; i < 1000 && SDL_AtomicGet(&count) < 100; ++i) {
+        SDL_Delay(1);
+    }
+    CHECK(SDL_AtomicGet(&count) == 100);
+}
+
+/* SDL_Quit() runs whatever is still queued */
+static void
+TestQuitRunsQueued(void)
+{
+    int i;
+
+    SDL_AtomicSet(&count, 0);
+    for (i = 0; i < 1000; ++i) {
+        SDL_RunJob(NULL, CountJob, NULL);
+    }
+    SDL_JobsQuit();
+    CHECK(SDL_AtomicGet(&count) == 1000);
+}
+
+static double
+Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#define BENCH_JOBS  256
+#define BENCH_WORK  200000
+
+static volatile Uint32 bench_sink;
+
+/* A fixed amount of arithmetic, the same for every job */
+static void SDLCALL
+WorkJob(void *data)
+{
+    Uint32 x = (Uint32) (intptr_t) data;
+    int i;
+
+    for (i = 0; i < BENCH_WORK; ++i) {
+        x = x * 1664525 + 1013904223;
+    }
+    bench_sink = x;
+}
+
+static double
+RunWork(void)
+{
+    SDL_JobGroup *group = SDL_CreateJobGroup();
+    double start = Now();
+    int i;
+
+    for (i = 0; i < BENCH_JOBS; ++i) {
+        SDL_RunJob(group, WorkJob, (void *) (intptr_t) i);
+    }
+    SDL_WaitJobGroup(group);
+    SDL_DestroyJobGroup(group);
+    return Now() - start;
+}
+
+static void
+Benchmark(void)
+{
+    const int emptyjobs = 100000;
+    SDL_JobGroup *group;
+    double serial, elapsed, start;
+    int i, cpus;
+
+    printf("%ld CPUs online\n", sysconf(_SC_NPROCESSORS_ONLN));
+
+    start = Now();
+    for (i = 0; i < BENCH_JOBS; ++i) {
+        WorkJob((void *) (intptr_t) i);
+    }
+    serial = Now() - start;
+    printf("serial: %.1f ms for %d jobs\n", serial * 1000.0, BENCH_JOBS);
+
+    for (cpus = 1; cpus <= 16; cpus *= 2) {
+        cpu_count = cpus;
+        SDL_GetJobWorkerCount();    /* Start the pool outside the timing */
+        elapsed = RunWork();
+        printf("%2d CPUs, %2d workers: %.1f ms, %.2fx serial\n",
+               cpus, SDL_GetJobWorkerCount(), elapsed * 1000.0, serial / elapsed);
+        SDL_JobsQuit();
+    }
+
+    cpu_count = 4;
+    group = SDL_CreateJobGroup();
+    start = Now();
+    for (i = 0; i < emptyjobs; ++i) {
+        SDL_RunJob(group, CountJob, NULL);
+    }
+    SDL_WaitJobGroup(group);
+    elapsed = Now() - start;
+    SDL_DestroyJobGroup(group);
+    SDL_JobsQuit();
+    printf("empty jobs, 3 workers: %.0f ns/job\n", elapsed * 1e9 / emptyjobs);
+}
+
+int
+main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        Benchmark();
+        return 0;
+    }
+
+    TestRunJobs();
+    TestNestedJobs();
+    TestDestroyAfterWait();
+    TestUngroupedJobs();
+    TestQuitRunsQueued();
+
+    if (failures) {
+        printf("testjob: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("testjob: all checks passed\n");
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,386 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks the per-thread block caches of SDL_malloc(). Run with --bench to
+   time an alloc/free/realloc loop on 1 to 8 threads, through SDL_malloc()
+   and through the memory functions underneath it, which is what
+   SDL_malloc() cost before the caches. */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "SDL_internal.h"
+#include "SDL_atomic.h"
+#include "SDL_stdinc.h"
+#include "SDL_thread.h"
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+#define MAX_THREADS 8
+
+static int failures = 0;
+
+static void
+TestSizes(void)
+{
+    const int start = SDL_GetNumAllocations();
+    Uint8 *blocks[64];
+    size_t size;
+    int i;
+
+    for (i = 0; i < SDL_arraysize(blocks); ++i) {
+        size = 1 + (size_t) i * 67;
+        blocks[i] = (Uint8 *) SDL_malloc(size);
+        CHECK(blocks[i] != NULL);
+        CHECK(((uintptr_t) blocks[i] % 16) == 0);
+        SDL_memset(blocks[i], i, size);
+    }
+    CHECK(SDL_GetNumAllocations() == start + SDL_arraysize(blocks));
+
+    for (i = 0; i < SDL_arraysize(blocks); ++i) {
+        size = 1 + (size_t) i * 67;
+        CHECK(blocks[i][0] == i && blocks[i][size - 1] == i);
+        SDL_free(blocks[i]);
+    }
+    CHECK(SDL_GetNumAllocations() == start);
+
+    /* Zero sizes still give a block */
+    blocks[0] = (Uint8 *) SDL_malloc(0);
+    CHECK(blocks[0] != NULL);
+    SDL_free(blocks[0]);
+    SDL_free(NULL);
+}
+
+/* A reused block comes back zeroed from SDL_calloc() */
+static void
+TestCallocReuse(void)
+{
+    Uint8 *block;
+    int i, zero = 1;
+
+    block = (Uint8 *) SDL_malloc(100);
+    SDL_memset(block, 0xFF, 100);
+    SDL_free(block);
+
+    block = (Uint8 *) SDL_calloc(10, 10);
+    for (i = 0; i < 100; ++i) {
+        zero &= (block[i] == 0);
+    }
+    CHECK(zero);
+    SDL_free(block);
+}
+
+static void
+TestRealloc(void)
+{
+    Uint8 *block = (Uint8 *) SDL_malloc(10);
+    size_t size;
+    int ok = 1;
+    size_t i;
+
+    for (i = 0; i < 10; ++i) {
+        block[i] = (Uint8) i;
+    }
+
+    /* Grow through the size classes into a large block and back */
+    for (size = 20; size <= 8192; size *= 2) {
+        block = (Uint8 *) SDL_realloc(block, size);
+        CHECK(block != NULL);
+        block[size - 1] = 0xAA;
+    }
+    block = (Uint8 *) SDL_realloc(block, 10);
+    for (i = 0; i < 10; ++i) {
+        ok &= (block[i] == (Uint8) i);
+    }
+    CHECK(ok);
+    SDL_free(block);
+
+    block = (Uint8 *) SDL_realloc(NULL, 32);
+    CHECK(block != NULL);
+    SDL_free(block);
+}
+
+typedef struct
+{
+    void *blocks[1000];
+} BlockList;
+
+static int SDLCALL
+FreeThread(void *data)
+{
+    BlockList *list = (BlockList *) data;
+    int i;
+
+    for (i = 0; i < SDL_arraysize(list->blocks); ++i) {
+        SDL_free(list->blocks[i]);
+    }
+    return 0;
+}
+
+/* Blocks freed on another thread go into that thread's cache */
+static void
+TestCrossThreadFree(void)
+{
+    static BlockList list;
+    SDL_Thread *thread;
+    int start, i;
+
+    /* The first thread sets up thread-local storage, which SDL keeps */
+    SDL_zero(list);
+    thread = SDL_CreateThread(FreeThread, "free", &list);
+    SDL_WaitThread(thread, NULL);
+
+    start = SDL_GetNumAllocations();
+    for (i = 0; i < SDL_arraysize(list.blocks); ++i) {
+        list.blocks[i] = SDL_malloc(16 + (i % 128) * 16);
+    }
+    thread = SDL_CreateThread(FreeThread, "free", &list);
+    SDL_WaitThread(thread, NULL);
+    CHECK(SDL_GetNumAllocations() == start);
+}
+
+/* Memory functions that count the blocks they have out */
+static SDL_malloc_func orig_malloc;
+static SDL_calloc_func orig_calloc;
+static SDL_realloc_func orig_realloc;
+static SDL_free_func orig_free;
+static SDL_atomic_t counted;
+
+static void * SDLCALL
+CountedMalloc(size_t size)
+{
+    SDL_AtomicIncRef(&counted);
+    return orig_malloc(size);
+}
+
+static void * SDLCALL
+CountedCalloc(size_t nmemb, size_t size)
+{
+    SDL_AtomicIncRef(&counted);
+    return orig_calloc(nmemb, size);
+}
+
+static void * SDLCALL
+CountedRealloc(void *mem, size_t size)
+{
+    if (!mem) {
+        SDL_AtomicIncRef(&counted);
+    }
+    return orig_realloc(mem, size);
+}
+
+static void SDLCALL
+CountedFree(void *mem)
+{
+    SDL_AtomicAdd(&counted, -1);
+    orig_free(mem);
+}
+
+static void
+SetCountedFunctions(void)
+{
+    SDL_AtomicSet(&counted, 0);
+    SDL_SetMemoryFunctions(CountedMalloc, CountedCalloc, CountedRealloc, CountedFree);
+}
+
+static void
+RestoreFunctions(void)
+{
+    SDL_SetMemoryFunctions(orig_malloc, orig_calloc, orig_realloc, orig_free);
+}
+
+static void
+AllocAndFree(int count)
+{
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        SDL_free(SDL_malloc(16 + (i % 64) * 16));
+    }
+}
+
+typedef struct
+{
+    SDL_sem *cached;
+    SDL_sem *replaced;
+} SwitchData;
+
+static int SDLCALL
+CacheThread(void *data)
+{
+    SwitchData *sw = (SwitchData *) data;
+
+    SDL_SemWait(sw->replaced);
+    AllocAndFree(100);
+    SDL_SemPost(sw->cached);
+
+    /* The next allocation gives the old blocks back where they came from */
+    SDL_SemWait(sw->replaced);
+    AllocAndFree(1);
+    SDL_SemPost(sw->cached);
+    return 0;
+}
+
+/* Cached blocks go back to the functions that allocated them */
+static void
+TestReplaceFunctions(void)
+{
+    SwitchData sw;
+    SDL_Thread *thread;
+
+    SDL_GetMemoryFunctions(&orig_malloc, &orig_calloc, &orig_realloc, &orig_free);
+
+    /* On this thread, when the functions are replaced */
+    SetCountedFunctions();
+    AllocAndFree(100);
+    CHECK(SDL_AtomicGet(&counted) > 0);
+    RestoreFunctions();
+    CHECK(SDL_AtomicGet(&counted) == 0);
+
+    /* On another thread, the next time it allocates.  The thread is made
+       first, so only the blocks it caches come from the counted functions. */
+    sw.cached = SDL_CreateSemaphore(0);
+    sw.replaced = SDL_CreateSemaphore(0);
+    thread = SDL_CreateThread(CacheThread, "cache", &sw);
+    SetCountedFunctions();
+    SDL_SemPost(sw.replaced);
+    SDL_SemWait(sw.cached);
+    RestoreFunctions();
+    CHECK(SDL_AtomicGet(&counted) > 0);
+    SDL_SemPost(sw.replaced);
+    SDL_SemWait(sw.cached);
+    CHECK(SDL_AtomicGet(&counted) == 0);
+    SDL_WaitThread(thread, NULL);
+
+    SDL_DestroySemaphore(sw.cached);
+    SDL_DestroySemaphore(sw.replaced);
+}
+
+static double
+Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#define BENCH_SLOTS 64
+#define BENCH_OPS   2000000
+
+typedef struct
+{
+    void *(SDLCALL *alloc)(size_t size);
+    void *(SDLCALL *resize)(void *mem, size_t size);
+    void (SDLCALL *release)(void *mem);
+    int ops;
+} BenchData;
+
+/* Allocates, frees and reallocates small blocks of mixed sizes, keeping
+   up to BENCH_SLOTS of them alive */
+static int SDLCALL
+BenchThread(void *data)
+{
+    BenchData *bench = (BenchData *) data;
+    void *slots[BENCH_SLOTS];
+    Uint32 seed = (Uint32) (uintptr_t) slots;
+    int i, slot;
+
+    SDL_zero(slots);
+    for (i = 0; i < bench->ops; ++i) {
+        seed = seed * 1664525 + 1013904223;
+        slot = (seed >> 8) % BENCH_SLOTS;
+        if (!slots[slot]) {
+            slots[slot] = bench->alloc(16 + ((seed >> 16) % 512));
+        } else if (seed & 0x10000000) {
+            slots[slot] = bench->resize(slots[slot], 16 + ((seed >> 16) % 1024));
+        } else {
+            bench->release(slots[slot]);
+            slots[slot] = NULL;
+        }
+    }
+    for (slot = 0; slot < BENCH_SLOTS; ++slot) {
+        if (slots[slot]) {
+            bench->release(slots[slot]);
+        }
+    }
+    return 0;
+}
+
+static double
+RunBench(BenchData *bench, int nthreads)
+{
+    SDL_Thread *threads[MAX_THREADS];
+    double start;
+    int i;
+
+    bench->ops = BENCH_OPS / nthreads;
+    start = Now();
+    for (i = 0; i < nthreads; ++i) {
+        threads[i] = SDL_CreateThread(BenchThread, "bench", bench);
+    }
+    for (i = 0; i < nthreads; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+    return Now() - start;
+}
+
+static void
+Benchmark(void)
+{
+    BenchData direct, cached;
+    double before, after;
+    int nthreads;
+
+    SDL_GetMemoryFunctions(&direct.alloc, NULL, &direct.resize, &direct.release);
+    cached.alloc = SDL_malloc;
+    cached.resize = SDL_realloc;
+    cached.release = SDL_free;
+
+    for (nthreads = 1; nthreads <= MAX_THREADS; nthreads *= 2) {
+        before = RunBench(&direct, nthreads);
+        after = RunBench(&cached, nthreads);
+        printf("%d threads: memory functions %.1f ns/op, SDL_malloc %.1f ns/op, %.2fx\n",
+               nthreads, before * 1e9 / BENCH_OPS, after * 1e9 / BENCH_OPS, before / after);
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        Benchmark();
+        return 0;
+    }
+
+    TestSizes();
+    TestCallocReuse();
+    TestRealloc();
+    TestCrossThreadFree();
+    TestReplaceFunctions();
+
+    if (failures) {
+        printf("testmalloc: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("testmalloc: all checks passed\n");
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
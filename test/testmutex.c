@@ -0,0 +1,314 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks the ORBIS mutex, condition variable and semaphore on their POSIX
+   build. Run with --bench to time contended locking and cond handoffs. */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "SDL_internal.h"
+#include "SDL_atomic.h"
+#include "SDL_mutex.h"
+#include "SDL_thread.h"
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+#define MAX_THREADS 8
+
+static int failures = 0;
+
+typedef struct
+{
+    SDL_mutex *mutex;
+    int iterations;
+    int counter;
+} CounterData;
+
+static int SDLCALL
+CounterThread(void *data)
+{
+    CounterData *counter = (CounterData *) data;
+    int i;
+
+    for (i = 0; i < counter->iterations; ++i) {
+        SDL_LockMutex(counter->mutex);
+        ++counter->counter;
+        SDL_UnlockMutex(counter->mutex);
+    }
+    return 0;
+}
+
+/* Runs nthreads threads incrementing one counter under the mutex */
+static int
+RunCounter(CounterData *counter, int nthreads)
+{
+    SDL_Thread *threads[MAX_THREADS];
+    int i;
+
+    for (i = 0; i < nthreads; ++i) {
+        threads[i] = SDL_CreateThread(CounterThread, "counter", counter);
+        if (!threads[i]) {
+            return -1;
+        }
+    }
+    for (i = 0; i < nthreads; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+    return 0;
+}
+
+static void
+TestMutexCounter(void)
+{
+    CounterData counter;
+
+    counter.mutex = SDL_CreateMutex();
+    counter.iterations = 100000;
+    counter.counter = 0;
+    CHECK(counter.mutex != NULL);
+
+    CHECK(RunCounter(&counter, 4) == 0);
+    CHECK(counter.counter == 4 * counter.iterations);
+
+    SDL_DestroyMutex(counter.mutex);
+}
+
+static int SDLCALL
+TryLockThread(void *data)
+{
+    SDL_mutex *mutex = (SDL_mutex *) data;
+    int status = SDL_TryLockMutex(mutex);
+
+    if (status == 0) {
+        SDL_UnlockMutex(mutex);
+    }
+    return status;
+}
+
+static void
+TestMutexTryLock(void)
+{
+    SDL_mutex *mutex = SDL_CreateMutex();
+    SDL_Thread *thread;
+    int status = -1;
+
+    /* SDL mutexes are recursive */
+    CHECK(SDL_LockMutex(mutex) == 0);
+    CHECK(SDL_TryLockMutex(mutex) == 0);
+    CHECK(SDL_UnlockMutex(mutex) == 0);
+
+    /* Still held once, so another thread can't take it */
+    thread = SDL_CreateThread(TryLockThread, "trylock", mutex);
+    SDL_WaitThread(thread, &status);
+    CHECK(status == SDL_MUTEX_TIMEDOUT);
+
+    CHECK(SDL_UnlockMutex(mutex) == 0);
+    thread = SDL_CreateThread(TryLockThread, "trylock", mutex);
+    SDL_WaitThread(thread, &status);
+    CHECK(status == 0);
+
+    SDL_DestroyMutex(mutex);
+}
+
+typedef struct
+{
+    SDL_mutex *mutex;
+    SDL_cond *cond;
+    int rounds;
+    int turn;
+} PingPongData;
+
+static int SDLCALL
+PongThread(void *data)
+{
+    PingPongData *pp = (PingPongData *) data;
+    int i;
+
+    SDL_LockMutex(pp->mutex);
+    for (i = 0; i < pp->rounds; ++i) {
+        while (pp->turn != 1) {
+            SDL_CondWait(pp->cond, pp->mutex);
+        }
+        pp->turn = 0;
+        SDL_CondSignal(pp->cond);
+    }
+    SDL_UnlockMutex(pp->mutex);
+    return 0;
+}
+
+/* Hands a token back and forth between two threads, rounds times */
+static void
+RunPingPong(PingPongData *pp)
+{
+    SDL_Thread *thread;
+    int i;
+
+    pp->turn = 0;
+    thread = SDL_CreateThread(PongThread, "pong", pp);
+
+    SDL_LockMutex(pp->mutex);
+    for (i = 0; i < pp->rounds; ++i) {
+        pp->turn = 1;
+        SDL_CondSignal(pp->cond);
+        while (pp->turn != 0) {
+            SDL_CondWait(pp->cond, pp->mutex);
+        }
+    }
+    SDL_UnlockMutex(pp->mutex);
+
+    SDL_WaitThread(thread, NULL);
+}
+
+static void
+TestCondPingPong(void)
+{
+    PingPongData pp;
+
+    pp.mutex = SDL_CreateMutex();
+    pp.cond = SDL_CreateCond();
+    pp.rounds = 10000;
+    CHECK(pp.cond != NULL);
+
+    RunPingPong(&pp);
+    CHECK(pp.turn == 0);
+
+    SDL_DestroyCond(pp.cond);
+    SDL_DestroyMutex(pp.mutex);
+}
+
+static void
+TestCondTimeout(void)
+{
+    SDL_mutex *mutex = SDL_CreateMutex();
+    SDL_cond *cond = SDL_CreateCond();
+
+    SDL_LockMutex(mutex);
+    CHECK(SDL_CondWaitTimeout(cond, mutex, 10) == SDL_MUTEX_TIMEDOUT);
+    /* The mutex is held again after a timeout */
+    CHECK(SDL_TryLockMutex(mutex) == 0);
+    SDL_UnlockMutex(mutex);
+    SDL_UnlockMutex(mutex);
+
+    SDL_DestroyCond(cond);
+    SDL_DestroyMutex(mutex);
+}
+
+static void
+TestSemaphore(void)
+{
+    SDL_sem *sem = SDL_CreateSemaphore(2);
+
+    CHECK(sem != NULL);
+    CHECK(SDL_SemValue(sem) == 2);
+    CHECK(SDL_SemTryWait(sem) == 0);
+    CHECK(SDL_SemWait(sem) == 0);
+    CHECK(SDL_SemTryWait(sem) == SDL_MUTEX_TIMEDOUT);
+    CHECK(SDL_SemWaitTimeout(sem, 10) == SDL_MUTEX_TIMEDOUT);
+    CHECK(SDL_SemPost(sem) == 0);
+    CHECK(SDL_SemValue(sem) == 1);
+    CHECK(SDL_SemWaitTimeout(sem, 10) == 0);
+
+    SDL_DestroySemaphore(sem);
+}
+
+static double
+Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Lock/unlock pairs on one mutex from nthreads threads at once */
+static void
+BenchmarkMutex(int nthreads)
+{
+    CounterData counter;
+    SDL_LockContentionStats stats;
+    double start, elapsed;
+    int total;
+
+    counter.mutex = SDL_CreateMutex();
+    counter.iterations = 1000000 / nthreads;
+    counter.counter = 0;
+    total = counter.iterations * nthreads;
+
+    SDL_ResetLockContentionStats();
+    start = Now();
+    RunCounter(&counter, nthreads);
+    elapsed = Now() - start;
+    SDL_GetLockContentionStats(&stats);
+
+    printf("mutex, %d threads: %.1f ns/lock, %d contended, %d yields, %d parks\n",
+           nthreads, elapsed * 1e9 / total, stats.contended, stats.yields, stats.parks);
+
+    SDL_DestroyMutex(counter.mutex);
+}
+
+/* Round trips between two threads through one condition variable */
+static void
+BenchmarkCond(void)
+{
+    PingPongData pp;
+    double start, elapsed;
+
+    pp.mutex = SDL_CreateMutex();
+    pp.cond = SDL_CreateCond();
+    pp.rounds = 100000;
+
+    start = Now();
+    RunPingPong(&pp);
+    elapsed = Now() - start;
+
+    printf("cond ping-pong: %.2f us/round trip\n", elapsed * 1e6 / pp.rounds);
+
+    SDL_DestroyCond(pp.cond);
+    SDL_DestroyMutex(pp.mutex);
+}
+
+int
+main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        int nthreads;
+
+        for (nthreads = 1; nthreads <= MAX_THREADS; nthreads *= 2) {
+            BenchmarkMutex(nthreads);
+        }
+        BenchmarkCond();
+        return 0;
+    }
+
+    TestMutexCounter();
+    TestMutexTryLock();
+    TestCondPingPong();
+    TestCondTimeout();
+    TestSemaphore();
+
+    if (failures) {
+        printf("testmutex: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("testmutex: all checks passed\n");
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
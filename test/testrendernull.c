@@ -0,0 +1,420 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* SDL_render.c is built into this file so the null renderer can be set up
+   the way SDL_CreateRenderer() would, without a window or video driver. */
+#include "../source/render/SDL_render.c"
+#include "../source/render/orbis/SDL_render_orbis_raster.h"
+
+#include "testrendernull.h"
+
+typedef struct
+{
+    ORBIS_Surface screen;
+    SDL_Texture *target;        /* NULL when drawing to the screen */
+    SDL_Rect viewport;
+    SDL_bool cliprect_enabled;
+    SDL_Rect cliprect;          /* relative to the viewport */
+    NULL_RenderStats stats;
+} NULL_RenderData;
+
+static Uint32
+NULL_Color(Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+    return ((Uint32) a << 24) | ((Uint32) r << 16) | ((Uint32) g << 8) | b;
+}
+
+static void
+NULL_GetTargetSurface(SDL_Renderer *renderer, ORBIS_Surface *surface)
+{
+    NULL_RenderData *data = (NULL_RenderData *) renderer->driverdata;
+
+    if (data->target) {
+        *surface = *(ORBIS_Surface *) data->target->driverdata;
+    } else {
+        *surface = data->screen;
+    }
+}
+
+/* Area of 'dst' the current viewport and clip rect allow drawing to */
+static void
+NULL_GetDrawableRect(NULL_RenderData *data, const ORBIS_Surface *dst, SDL_Rect *rect)
+{
+    SDL_Rect bounds;
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = dst->w;
+    bounds.h = dst->h;
+    if (!SDL_IntersectRect(&data->viewport, &bounds, rect)) {
+        rect->w = rect->h = 0;
+        return;
+    }
+    if (data->cliprect_enabled) {
+        SDL_Rect clip = data->cliprect;
+        clip.x += data->viewport.x;
+        clip.y += data->viewport.y;
+        if (!SDL_IntersectRect(rect, &clip, rect)) {
+            rect->w = rect->h = 0;
+        }
+    }
+}
+
+static int
+NULL_CreateTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    ORBIS_Surface *surface;
+
+    if (texture->format != SDL_PIXELFORMAT_ARGB8888) {
+        return SDL_SetError("Unsupported texture format");
+    }
+
+    surface = (ORBIS_Surface *) SDL_calloc(1, sizeof(*surface));
+    if (!surface) {
+        return SDL_OutOfMemory();
+    }
+    surface->w = texture->w;
+    surface->h = texture->h;
+    surface->pitch = texture->w * 4;
+    surface->pixels = (Uint32 *) SDL_calloc(texture->h, surface->pitch);
+    if (!surface->pixels) {
+        SDL_free(surface);
+        return SDL_OutOfMemory();
+    }
+    texture->driverdata = surface;
+    return 0;
+}
+
+static int
+NULL_UpdateTexture(SDL_Renderer *renderer, SDL_Texture *texture,
+                   const SDL_Rect *rect, const void *pixels, int pitch)
+{
+    ORBIS_Surface *surface = (ORBIS_Surface *) texture->driverdata;
+    const Uint8 *src = (const Uint8 *) pixels;
+    Uint8 *dst = (Uint8 *) surface->pixels + rect->y * surface->pitch + rect->x * 4;
+    int row;
+
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, rect->w * 4);
+        src += pitch;
+        dst += surface->pitch;
+    }
+    return 0;
+}
+
+static int
+NULL_LockTexture(SDL_Renderer *renderer, SDL_Texture *texture,
+                 const SDL_Rect *rect, void **pixels, int *pitch)
+{
+    ORBIS_Surface *surface = (ORBIS_Surface *) texture->driverdata;
+
+    *pixels = (Uint8 *) surface->pixels + rect->y * surface->pitch + rect->x * 4;
+    *pitch = surface->pitch;
+    return 0;
+}
+
+static void
+NULL_UnlockTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+}
+
+static int
+NULL_SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    NULL_RenderData *data = (NULL_RenderData *) renderer->driverdata;
+
+    data->target = texture;
+    return 0;
+}
+
+static void
+NULL_DrawCopy(SDL_Renderer *renderer, const SDL_RenderCommand *cmd,
+              const SDL_Rect *srcrect, const SDL_FRect *dstrect,
+              double angle, const SDL_FPoint *center, SDL_RendererFlip flip, SDL_bool ex)
+{
+    NULL_RenderData *data = (NULL_RenderData *) renderer->driverdata;
+    ORBIS_Surface dst;
+    ORBIS_Tile tile;
+    ORBIS_DrawState state;
+    SDL_Rect drawable;
+    SDL_FRect rect = *dstrect;
+
+    NULL_GetTargetSurface(renderer, &dst);
+    NULL_GetDrawableRect(data, &dst, &drawable);
+    rect.x += data->viewport.x;
+    rect.y += data->viewport.y;
+
+    tile.surface = *(ORBIS_Surface *) cmd->data.draw.texture->driverdata;
+    tile.x = 0;
+    tile.y = 0;
+    state.r = cmd->data.draw.r;
+    state.g = cmd->data.draw.g;
+    state.b = cmd->data.draw.b;
+    state.a = cmd->data.draw.a;
+    state.copyspan = ORBIS_GetCopySpanFunc(cmd->data.draw.blend);
+
+    if (ex) {
+        ORBIS_RasterCopyEx(&dst, &drawable, &tile, 1, srcrect, &rect, &state, angle, center, flip, NULL);
+    } else {
+        ORBIS_RasterCopy(&dst, &drawable, &tile, 1, srcrect, &rect, &state, NULL);
+    }
+}
+
+static int
+NULL_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd,
+                     void *vertices, size_t vertsize)
+{
+    NULL_RenderData *data = (NULL_RenderData *) renderer->driverdata;
+    ORBIS_Surface dst;
+    SDL_Rect drawable, rect;
+    size_t i;
+
+    if (cmd) {
+        data->stats.flushes++;
+        data->stats.last_flush_target = data->target;
+    }
+
+    for ( ; cmd; cmd = cmd->next) {
+        data->stats.commands++;
+
+        NULL_GetTargetSurface(renderer, &dst);
+        NULL_GetDrawableRect(data, &dst, &drawable);
+
+        switch (cmd->command) {
+            case SDL_RENDERCMD_SETVIEWPORT:
+                data->viewport = cmd->data.viewport.rect;
+                break;
+
+            case SDL_RENDERCMD_SETCLIPRECT:
+                data->cliprect_enabled = cmd->data.cliprect.enabled;
+                data->cliprect = cmd->data.cliprect.rect;
+                break;
+
+            case SDL_RENDERCMD_CLEAR:
+                rect.x = 0;
+                rect.y = 0;
+                rect.w = dst.w;
+                rect.h = dst.h;
+                ORBIS_RasterFillRect(&dst, &rect,
+                    NULL_Color(cmd->data.color.r, cmd->data.color.g, cmd->data.color.b, cmd->data.color.a),
+                    ORBIS_GetFillSpanFunc(SDL_BLENDMODE_NONE));
+                break;
+
+            case SDL_RENDERCMD_DRAW_POINTS: {
+                const SDL_FPoint *points = (const SDL_FPoint *) ((Uint8 *) vertices + cmd->data.draw.first);
+                const Uint32 color = NULL_Color(cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b, cmd->data.draw.a);
+                const ORBIS_FillSpanFunc fillspan = ORBIS_GetFillSpanFunc(cmd->data.draw.blend);
+                for (i = 0; i < cmd->data.draw.count; ++i) {
+                    SDL_Point p;
+                    p.x = data->viewport.x + (int) points[i].x;
+                    p.y = data->viewport.y + (int) points[i].y;
+                    if (SDL_PointInRect(&p, &drawable)) {
+                        fillspan((Uint32 *) ((Uint8 *) dst.pixels + p.y * dst.pitch) + p.x, color, 1);
+                    }
+                }
+                break;
+            }
+
+            case SDL_RENDERCMD_DRAW_LINES: {
+                const SDL_FPoint *points = (const SDL_FPoint *) ((Uint8 *) vertices + cmd->data.draw.first);
+                const Uint32 color = NULL_Color(cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b, cmd->data.draw.a);
+                const ORBIS_FillSpanFunc fillspan = ORBIS_GetFillSpanFunc(cmd->data.draw.blend);
+                for (i = 0; i < cmd->data.draw.count; ++i, points += 2) {
+                    int x1 = data->viewport.x + (int) points[0].x;
+                    int y1 = data->viewport.y + (int) points[0].y;
+                    int x2 = data->viewport.x + (int) points[1].x;
+                    int y2 = data->viewport.y + (int) points[1].y;
+                    if (SDL_IntersectRectAndLine(&drawable, &x1, &y1, &x2, &y2)) {
+                        ORBIS_RasterDrawLine(&dst, x1, y1, x2, y2, color, fillspan);
+                    }
+                }
+                break;
+            }
+
+            case SDL_RENDERCMD_FILL_RECTS: {
+                const SDL_FRect *rects = (const SDL_FRect *) ((Uint8 *) vertices + cmd->data.draw.first);
+                const Uint32 color = NULL_Color(cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b, cmd->data.draw.a);
+                const ORBIS_FillSpanFunc fillspan = ORBIS_GetFillSpanFunc(cmd->data.draw.blend);
+                for (i = 0; i < cmd->data.draw.count; ++i) {
+                    rect.x = data->viewport.x + (int) rects[i].x;
+                    rect.y = data->viewport.y + (int) rects[i].y;
+                    rect.w = (int) rects[i].w;
+                    rect.h = (int) rects[i].h;
+                    if (SDL_IntersectRect(&rect, &drawable, &rect)) {
+                        ORBIS_RasterFillRect(&dst, &rect, color, fillspan);
+                    }
+                }
+                break;
+            }
+
+            case SDL_RENDERCMD_COPY: {
+                const SDL_RenderCopyData *copy = (const SDL_RenderCopyData *) ((Uint8 *) vertices + cmd->data.draw.first);
+                for (i = 0; i < cmd->data.draw.count; ++i) {
+                    NULL_DrawCopy(renderer, cmd, &copy[i].srcrect, &copy[i].dstrect, 0.0, NULL, SDL_FLIP_NONE, SDL_FALSE);
+                }
+                break;
+            }
+
+            case SDL_RENDERCMD_COPY_EX: {
+                const SDL_RenderCopyExData *copy = (const SDL_RenderCopyExData *) ((Uint8 *) vertices + cmd->data.draw.first);
+                for (i = 0; i < cmd->data.draw.count; ++i) {
+                    NULL_DrawCopy(renderer, cmd, &copy[i].srcrect, &copy[i].dstrect,
+                                  copy[i].angle, &copy[i].center, copy[i].flip, SDL_TRUE);
+                }
+                break;
+            }
+
+            case SDL_RENDERCMD_NO_OP:
+                break;
+        }
+
+        if (cmd->command >= SDL_RENDERCMD_DRAW_POINTS) {
+            data->stats.draws++;
+            data->stats.elements += cmd->data.draw.count;
+        }
+    }
+    return 0;
+}
+
+static int
+NULL_RenderReadPixels(SDL_Renderer *renderer, const SDL_Rect *rect,
+                      Uint32 format, void *pixels, int pitch)
+{
+    ORBIS_Surface src;
+    int row;
+
+    if (format != SDL_PIXELFORMAT_ARGB8888) {
+        return SDL_SetError("Unsupported pixel format");
+    }
+
+    NULL_GetTargetSurface(renderer, &src);
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy((Uint8 *) pixels + row * pitch,
+                   (Uint8 *) src.pixels + (rect->y + row) * src.pitch + rect->x * 4, rect->w * 4);
+    }
+    return 0;
+}
+
+static void
+NULL_RenderPresent(SDL_Renderer *renderer)
+{
+    NULL_RenderData *data = (NULL_RenderData *) renderer->driverdata;
+
+    data->stats.presents++;
+}
+
+static void
+NULL_DestroyTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    ORBIS_Surface *surface = (ORBIS_Surface *) texture->driverdata;
+
+    if (surface) {
+        SDL_free(surface->pixels);
+        SDL_free(surface);
+        texture->driverdata = NULL;
+    }
+}
+
+static void
+NULL_DestroyRenderer(SDL_Renderer *renderer)
+{
+    NULL_RenderData *data = (NULL_RenderData *) renderer->driverdata;
+
+    if (data) {
+        SDL_free(data->screen.pixels);
+        SDL_free(data);
+    }
+    SDL_free(renderer);
+}
+
+static int
+NULL_GetOutputSize(SDL_Renderer *renderer, int *w, int *h)
+{
+    NULL_RenderData *data = (NULL_RenderData *) renderer->driverdata;
+
+    *w = data->screen.w;
+    *h = data->screen.h;
+    return 0;
+}
+
+SDL_Renderer *
+NULL_CreateRenderer(int w, int h)
+{
+    SDL_Renderer *renderer;
+    NULL_RenderData *data;
+
+    renderer = (SDL_Renderer *) SDL_calloc(1, sizeof(*renderer));
+    data = (NULL_RenderData *) SDL_calloc(1, sizeof(*data));
+    if (!renderer || !data) {
+        SDL_free(renderer);
+        SDL_free(data);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    data->screen.w = w;
+    data->screen.h = h;
+    data->screen.pitch = w * 4;
+    data->screen.pixels = (Uint32 *) SDL_calloc(h, data->screen.pitch);
+    if (!data->screen.pixels) {
+        SDL_free(renderer);
+        SDL_free(data);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    renderer->GetOutputSize = NULL_GetOutputSize;
+    renderer->CreateTexture = NULL_CreateTexture;
+    renderer->UpdateTexture = NULL_UpdateTexture;
+    renderer->LockTexture = NULL_LockTexture;
+    renderer->UnlockTexture = NULL_UnlockTexture;
+    renderer->SetRenderTarget = NULL_SetRenderTarget;
+    renderer->RunCommandQueue = NULL_RunCommandQueue;
+    renderer->RenderReadPixels = NULL_RenderReadPixels;
+    renderer->RenderPresent = NULL_RenderPresent;
+    renderer->DestroyTexture = NULL_DestroyTexture;
+    renderer->DestroyRenderer = NULL_DestroyRenderer;
+    renderer->info.name = "null";
+    renderer->info.flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE;
+    renderer->info.num_texture_formats = 1;
+    renderer->info.texture_formats[0] = SDL_PIXELFORMAT_ARGB8888;
+    renderer->driverdata = data;
+
+    /* What SDL_CreateRenderer() does once a driver made the renderer */
+    renderer->magic = &renderer_magic;
+    renderer->scale.x = 1.0f;
+    renderer->scale.y = 1.0f;
+    renderer->dpi_scale.x = 1.0f;
+    renderer->dpi_scale.y = 1.0f;
+    renderer->render_command_generation = 1;
+    renderer->batching = SDL_GetHintBoolean(SDL_HINT_RENDER_BATCHING, SDL_TRUE);
+    SDL_RenderSetViewport(renderer, NULL);
+
+    return renderer;
+}
+
+NULL_RenderStats *
+NULL_GetRenderStats(SDL_Renderer *renderer)
+{
+    return &((NULL_RenderData *) renderer->driverdata)->stats;
+}
+
+Uint32
+NULL_GetPixel(SDL_Renderer *renderer, SDL_Texture *texture, int x, int y)
+{
+    NULL_RenderData *data = (NULL_RenderData *) renderer->driverdata;
+    const ORBIS_Surface *surface = texture ? (ORBIS_Surface *) texture->driverdata : &data->screen;
+
+    return *(const Uint32 *) ((const Uint8 *) surface->pixels + y * surface->pitch + x * 4);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
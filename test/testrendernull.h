@@ -0,0 +1,49 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* A render backend for host-side tests.
+
+   It runs the command queue SDL_render.c builds, the same way the ORBIS
+   renderer does, but draws with the ORBIS rasterizer into plain memory:
+   the screen is a malloc'd buffer and so is every texture, render targets
+   included. It also counts what it was asked to do, so tests can check
+   how draws were batched.
+ */
+
+#ifndef testrendernull_h_
+#define testrendernull_h_
+
+#include "SDL_internal.h"
+#include "SDL_render.h"
+
+typedef struct
+{
+    int flushes;        /* RunCommandQueue calls that had at least one command */
+    int commands;       /* commands handed to RunCommandQueue */
+    int draws;          /* of those, commands that draw something */
+    size_t elements;    /* points, segments, rects and copies in the draws */
+    int presents;
+    SDL_Texture *last_flush_target; /* what the last flush drew to, NULL for the screen */
+} NULL_RenderStats;
+
+/* A batching renderer whose screen is 'w' x 'h' ARGB8888 memory */
+extern SDL_Renderer *NULL_CreateRenderer(int w, int h);
+
+extern NULL_RenderStats *NULL_GetRenderStats(SDL_Renderer *renderer);
+
+/* Where draws to the screen or 'texture' land, for checking results
+   without going through SDL_RenderReadPixels() and its flush */
+extern Uint32 NULL_GetPixel(SDL_Renderer *renderer, SDL_Texture *texture, int x, int y);
+
+#endif /* testrendernull_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
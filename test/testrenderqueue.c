@@ -0,0 +1,254 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks how SDL_render.c batches draw calls, using the null renderer.
+   Run with --bench to time a frame of many small rects instead. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "testrendernull.h"
+#include "SDL_hints.h"
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+static int failures = 0;
+
+static SDL_Renderer *
+CreateRenderer(const char *batching)
+{
+    SDL_Renderer *renderer;
+
+    SDL_SetHint(SDL_HINT_RENDER_BATCHING, batching);
+    renderer = NULL_CreateRenderer(64, 64);
+    if (!renderer) {
+        fprintf(stderr, "Couldn't create renderer: %s\n", SDL_GetError());
+        exit(1);
+    }
+    return renderer;
+}
+
+static void
+FillRect(SDL_Renderer *renderer, int x, int y, int w, int h)
+{
+    SDL_Rect rect;
+
+    rect.x = x;
+    rect.y = y;
+    rect.w = w;
+    rect.h = h;
+    SDL_RenderFillRect(renderer, &rect);
+}
+
+/* Same state draws are merged and nothing runs before the flush */
+static void
+TestMergeSameState(void)
+{
+    SDL_Renderer *renderer = CreateRenderer("1");
+    NULL_RenderStats *stats = NULL_GetRenderStats(renderer);
+    int i;
+
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+    for (i = 0; i < 1000; ++i) {
+        FillRect(renderer, i % 64, i / 64, 1, 1);
+    }
+    CHECK(stats->flushes == 0);
+    CHECK(NULL_GetPixel(renderer, NULL, 0, 0) == 0);
+
+    SDL_RenderPresent(renderer);
+    CHECK(stats->flushes == 1);
+    CHECK(stats->draws == 1);
+    CHECK(stats->elements == 1000);
+    CHECK(stats->presents == 1);
+    CHECK(NULL_GetPixel(renderer, NULL, 0, 0) == 0xFFFF0000);
+    CHECK(NULL_GetPixel(renderer, NULL, 999 % 64, 999 / 64) == 0xFFFF0000);
+    CHECK(NULL_GetPixel(renderer, NULL, 1000 % 64, 1000 / 64) == 0);
+
+    SDL_DestroyRenderer(renderer);
+}
+
+/* A state change starts a new draw, and kinds of draws aren't mixed */
+static void
+TestSplitOnStateChange(void)
+{
+    SDL_Renderer *renderer = CreateRenderer("1");
+    NULL_RenderStats *stats = NULL_GetRenderStats(renderer);
+
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+    FillRect(renderer, 0, 0, 8, 8);
+    FillRect(renderer, 8, 0, 8, 8);
+    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+    FillRect(renderer, 16, 0, 8, 8);
+    SDL_RenderDrawLine(renderer, 0, 10, 20, 10);
+    SDL_RenderDrawLine(renderer, 0, 11, 20, 11);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    FillRect(renderer, 24, 0, 8, 8);
+    SDL_RenderFlush(renderer);
+
+    CHECK(stats->flushes == 1);
+    CHECK(stats->draws == 4);
+    CHECK(stats->elements == 2 + 1 + 2 + 1);
+    CHECK(NULL_GetPixel(renderer, NULL, 12, 4) == 0xFFFF0000);
+    CHECK(NULL_GetPixel(renderer, NULL, 20, 4) == 0xFF00FF00);
+    CHECK(NULL_GetPixel(renderer, NULL, 20, 11) == 0xFF00FF00);
+
+    SDL_DestroyRenderer(renderer);
+}
+
+/* SDL_HINT_RENDER_BATCHING "0" runs every call on its own */
+static void
+TestBatchingOff(void)
+{
+    SDL_Renderer *renderer = CreateRenderer("0");
+    NULL_RenderStats *stats = NULL_GetRenderStats(renderer);
+    int i;
+
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+    for (i = 0; i < 10; ++i) {
+        FillRect(renderer, i, 0, 1, 1);
+        CHECK(stats->flushes == i + 1);
+    }
+    CHECK(stats->draws == 10);
+    CHECK(NULL_GetPixel(renderer, NULL, 9, 0) == 0xFFFF0000);
+
+    SDL_DestroyRenderer(renderer);
+}
+
+/* Changing a texture the queue still draws from flushes the queue first */
+static void
+TestFlushBeforeTextureUpdate(void)
+{
+    SDL_Renderer *renderer = CreateRenderer("1");
+    NULL_RenderStats *stats = NULL_GetRenderStats(renderer);
+    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, 4, 4);
+    Uint32 pixels[16];
+    SDL_Rect dst;
+    int i;
+
+    CHECK(texture != NULL);
+
+    for (i = 0; i < 16; ++i) {
+        pixels[i] = 0xFF0000FF;
+    }
+    SDL_UpdateTexture(texture, NULL, pixels, 4 * 4);
+
+    dst.x = 0;
+    dst.y = 0;
+    dst.w = 4;
+    dst.h = 4;
+    SDL_RenderCopy(renderer, texture, NULL, &dst);
+    CHECK(stats->flushes == 0);
+
+    for (i = 0; i < 16; ++i) {
+        pixels[i] = 0xFFFFFFFF;
+    }
+    SDL_UpdateTexture(texture, NULL, pixels, 4 * 4);
+    CHECK(stats->flushes == 1);
+    CHECK(NULL_GetPixel(renderer, NULL, 1, 1) == 0xFF0000FF);
+
+    /* Not referenced anymore, so this one doesn't */
+    SDL_UpdateTexture(texture, NULL, pixels, 4 * 4);
+    CHECK(stats->flushes == 1);
+
+    SDL_DestroyTexture(texture);
+    SDL_DestroyRenderer(renderer);
+}
+
+/* Reading pixels sees every draw queued before it */
+static void
+TestFlushBeforeReadPixels(void)
+{
+    SDL_Renderer *renderer = CreateRenderer("1");
+    Uint32 pixel = 0;
+    SDL_Rect rect;
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
+    SDL_RenderClear(renderer);
+    rect.x = 5;
+    rect.y = 5;
+    rect.w = 1;
+    rect.h = 1;
+    CHECK(SDL_RenderReadPixels(renderer, &rect, SDL_PIXELFORMAT_ARGB8888, &pixel, 4) == 0);
+    CHECK(pixel == 0xFF0000FF);
+
+    SDL_DestroyRenderer(renderer);
+}
+
+static double
+Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Frames of small rects in a few colors, the UI case batching is for */
+static void
+Benchmark(const char *batching)
+{
+    const int frames = 100, rects = 20000;
+    SDL_Renderer *renderer = CreateRenderer(batching);
+    NULL_RenderStats *stats = NULL_GetRenderStats(renderer);
+    double start, elapsed;
+    int frame, i;
+
+    start = Now();
+    for (frame = 0; frame < frames; ++frame) {
+        for (i = 0; i < rects; ++i) {
+            if (i % 1000 == 0) {
+                SDL_SetRenderDrawColor(renderer, (Uint8) i, 0, 0, 255);
+            }
+            FillRect(renderer, i % 60, (i / 60) % 60, 4, 4);
+        }
+        SDL_RenderPresent(renderer);
+    }
+    elapsed = Now() - start;
+
+    printf("batching %s: %.3f ms/frame, %d driver calls, %d draws for %d rects\n",
+           batching, elapsed * 1000.0 / frames, stats->flushes, stats->draws, frames * rects);
+
+    SDL_DestroyRenderer(renderer);
+}
+
+int
+main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        Benchmark("1");
+        Benchmark("0");
+        return 0;
+    }
+
+    TestMergeSameState();
+    TestSplitOnStateChange();
+    TestBatchingOff();
+    TestFlushBeforeTextureUpdate();
+    TestFlushBeforeReadPixels();
+
+    if (failures) {
+        printf("testrenderqueue: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("testrenderqueue: all checks passed\n");
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
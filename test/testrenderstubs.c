@@ -0,0 +1,93 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* What SDL_render.c links against besides the render code under test.
+
+   The host tests build only the parts of SDL they exercise, so window,
+   surface, event and software renderer entry points end up here. None of
+   them is reached through the null renderer; they fail if they are.
+   SDL_stdlib.c needs the libm sources the tree doesn't ship, so the few
+   C library wrappers the render code uses go straight to libc.
+ */
+
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "SDL_internal.h"
+#include "SDL_video.h"
+#include "SDL_events.h"
+#include "SDL_log.h"
+#include "../source/render/SDL_sysrender.h"
+#include "../source/render/software/SDL_render_sw_c.h"
+
+/* libc */
+int SDL_abs(int x) { return abs(x); }
+int SDL_isdigit(int x) { return isdigit(x); }
+int SDL_isspace(int x) { return isspace(x); }
+int SDL_toupper(int x) { return toupper(x); }
+int SDL_tolower(int x) { return tolower(x); }
+double SDL_ceil(double x) { return ceil(x); }
+double SDL_floor(double x) { return floor(x); }
+double SDL_fabs(double x) { return fabs(x); }
+double SDL_sin(double x) { return sin(x); }
+double SDL_cos(double x) { return cos(x); }
+
+/* timer */
+void SDL_Delay(Uint32 ms) { usleep(ms * 1000); }
+
+/* logging */
+void SDL_LogInfo(int category, SDL_PRINTF_FORMAT_STRING const char *fmt, ...) { }
+void SDL_LogDebug(int category, SDL_PRINTF_FORMAT_STRING const char *fmt, ...) { }
+SDL_LogPriority SDL_LogGetPriority(int category) { return SDL_LOG_PRIORITY_CRITICAL; }
+
+/* video */
+SDL_Window *SDL_CreateWindow(const char *title, int x, int y, int w, int h, Uint32 flags) { SDL_Unsupported(); return NULL; }
+SDL_Window *SDL_GetWindowFromID(Uint32 id) { return NULL; }
+void *SDL_GetWindowData(SDL_Window *window, const char *name) { return NULL; }
+void *SDL_SetWindowData(SDL_Window *window, const char *name, void *userdata) { return NULL; }
+Uint32 SDL_GetWindowFlags(SDL_Window *window) { return 0; }
+Uint32 SDL_GetWindowPixelFormat(SDL_Window *window) { return SDL_PIXELFORMAT_ARGB8888; }
+void SDL_GetWindowSize(SDL_Window *window, int *w, int *h) { *w = *h = 0; }
+const char *SDL_GetCurrentVideoDriver(void) { return "null"; }
+void SDL_AddEventWatch(SDL_EventFilter filter, void *userdata) { }
+void SDL_DelEventWatch(SDL_EventFilter filter, void *userdata) { }
+
+/* surfaces and pixel formats */
+SDL_PixelFormat *SDL_AllocFormat(Uint32 format) { SDL_Unsupported(); return NULL; }
+void SDL_FreeFormat(SDL_PixelFormat *format) { }
+SDL_Surface *SDL_ConvertSurface(SDL_Surface *src, const SDL_PixelFormat *fmt, Uint32 flags) { SDL_Unsupported(); return NULL; }
+int SDL_ConvertPixels(int width, int height, Uint32 src_format, const void *src, int src_pitch,
+                      Uint32 dst_format, void *dst, int dst_pitch) { return SDL_Unsupported(); }
+void SDL_FreeSurface(SDL_Surface *surface) { }
+int SDL_LockSurface(SDL_Surface *surface) { return SDL_Unsupported(); }
+void SDL_UnlockSurface(SDL_Surface *surface) { }
+int SDL_GetColorKey(SDL_Surface *surface, Uint32 *key) { return -1; }
+int SDL_GetSurfaceAlphaMod(SDL_Surface *surface, Uint8 *alpha) { return SDL_Unsupported(); }
+int SDL_GetSurfaceColorMod(SDL_Surface *surface, Uint8 *r, Uint8 *g, Uint8 *b) { return SDL_Unsupported(); }
+int SDL_GetSurfaceBlendMode(SDL_Surface *surface, SDL_BlendMode *blendMode) { return SDL_Unsupported(); }
+
+/* software renderer and YUV textures */
+SDL_RenderDriver SW_RenderDriver;
+SDL_Renderer *SW_CreateRendererForSurface(SDL_Surface *surface) { SDL_Unsupported(); return NULL; }
+SDL_SW_YUVTexture *SDL_SW_CreateYUVTexture(Uint32 format, int w, int h) { SDL_Unsupported(); return NULL; }
+int SDL_SW_UpdateYUVTexture(SDL_SW_YUVTexture *swdata, const SDL_Rect *rect, const void *pixels, int pitch) { return SDL_Unsupported(); }
+int SDL_SW_UpdateYUVTexturePlanar(SDL_SW_YUVTexture *swdata, const SDL_Rect *rect,
+                                  const Uint8 *Yplane, int Ypitch, const Uint8 *Uplane, int Upitch,
+                                  const Uint8 *Vplane, int Vpitch) { return SDL_Unsupported(); }
+int SDL_SW_LockYUVTexture(SDL_SW_YUVTexture *swdata, const SDL_Rect *rect, void **pixels, int *pitch) { return SDL_Unsupported(); }
+int SDL_SW_CopyYUVToRGB(SDL_SW_YUVTexture *swdata, const SDL_Rect *srcrect, Uint32 target_format,
+                        int w, int h, void *pixels, int pitch) { return SDL_Unsupported(); }
+void SDL_SW_DestroyYUVTexture(SDL_SW_YUVTexture *swdata) { }
+
+/* vi: set ts=4 sw=4 expandtab: */
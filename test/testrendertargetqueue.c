@@ -0,0 +1,203 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks render target switching against memory-backed targets, using the
+   null renderer: each switch must hand the driver exactly the commands
+   queued for the previous target, and later draws must land in the new one. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "testrendernull.h"
+#include "SDL_hints.h"
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+#define RED     0xFFFF0000
+#define GREEN   0xFF00FF00
+#define BLUE    0xFF0000FF
+
+static int failures = 0;
+
+static SDL_Texture *
+CreateTarget(SDL_Renderer *renderer, int w, int h)
+{
+    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+
+    if (!texture) {
+        fprintf(stderr, "Couldn't create target: %s\n", SDL_GetError());
+        exit(1);
+    }
+    return texture;
+}
+
+static void
+FillRect(SDL_Renderer *renderer, Uint32 color, int x, int y, int w, int h)
+{
+    SDL_Rect rect;
+
+    rect.x = x;
+    rect.y = y;
+    rect.w = w;
+    rect.h = h;
+    SDL_SetRenderDrawColor(renderer, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF, color >> 24);
+    SDL_RenderFillRect(renderer, &rect);
+}
+
+/* Each switch flushes what was queued for the target being left, only */
+static void
+TestSwitchFlushesPreviousTarget(void)
+{
+    SDL_Renderer *renderer = NULL_CreateRenderer(64, 64);
+    NULL_RenderStats *stats = NULL_GetRenderStats(renderer);
+    SDL_Texture *a = CreateTarget(renderer, 16, 16);
+    SDL_Texture *b = CreateTarget(renderer, 16, 16);
+
+    /* screen -> a: two draws queued for the screen */
+    FillRect(renderer, RED, 0, 0, 4, 4);
+    FillRect(renderer, GREEN, 4, 0, 4, 4);
+    CHECK(SDL_SetRenderTarget(renderer, a) == 0);
+    CHECK(stats->flushes == 1);
+    CHECK(stats->draws == 2);
+    CHECK(stats->last_flush_target == NULL);
+    CHECK(NULL_GetPixel(renderer, NULL, 5, 1) == GREEN);
+
+    /* a -> b: only a's draw */
+    FillRect(renderer, BLUE, 0, 0, 16, 16);
+    CHECK(NULL_GetPixel(renderer, a, 0, 0) == 0);
+    CHECK(SDL_SetRenderTarget(renderer, b) == 0);
+    CHECK(stats->flushes == 2);
+    CHECK(stats->draws == 3);
+    CHECK(stats->last_flush_target == a);
+    CHECK(NULL_GetPixel(renderer, a, 15, 15) == BLUE);
+    CHECK(NULL_GetPixel(renderer, b, 0, 0) == 0);
+    CHECK(NULL_GetPixel(renderer, NULL, 8, 8) == 0);
+
+    /* b -> screen */
+    FillRect(renderer, RED, 2, 2, 2, 2);
+    CHECK(SDL_SetRenderTarget(renderer, NULL) == 0);
+    CHECK(stats->flushes == 3);
+    CHECK(stats->last_flush_target == b);
+    CHECK(NULL_GetPixel(renderer, b, 3, 3) == RED);
+    CHECK(NULL_GetPixel(renderer, b, 4, 4) == 0);
+    CHECK(NULL_GetPixel(renderer, a, 3, 3) == BLUE);
+    CHECK(NULL_GetPixel(renderer, NULL, 3, 3) == RED);  /* from the first draw, not b's */
+
+    /* Switching with nothing queued doesn't reach the driver's queue */
+    CHECK(SDL_SetRenderTarget(renderer, a) == 0);
+    CHECK(SDL_SetRenderTarget(renderer, NULL) == 0);
+    CHECK(stats->flushes == 3);
+
+    SDL_DestroyTexture(a);
+    SDL_DestroyTexture(b);
+    SDL_DestroyRenderer(renderer);
+}
+
+/* Draws to a target are clipped to it, whatever the screen size */
+static void
+TestTargetBounds(void)
+{
+    SDL_Renderer *renderer = NULL_CreateRenderer(64, 64);
+    SDL_Texture *target = CreateTarget(renderer, 8, 4);
+    int w = 0, h = 0;
+
+    SDL_SetRenderTarget(renderer, target);
+    CHECK(SDL_GetRendererOutputSize(renderer, &w, &h) == 0);
+    CHECK(w == 8 && h == 4);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    FillRect(renderer, GREEN, -10, -10, 100, 100);
+    SDL_SetRenderTarget(renderer, NULL);
+
+    CHECK(NULL_GetPixel(renderer, target, 0, 0) == GREEN);
+    CHECK(NULL_GetPixel(renderer, target, 7, 3) == GREEN);
+    CHECK(NULL_GetPixel(renderer, NULL, 0, 0) == 0);
+    CHECK(NULL_GetPixel(renderer, NULL, 63, 63) == 0);
+
+    SDL_DestroyTexture(target);
+    SDL_DestroyRenderer(renderer);
+}
+
+/* A cached layer drawn once and composited every frame */
+static void
+TestCompositeTarget(void)
+{
+    SDL_Renderer *renderer = NULL_CreateRenderer(64, 64);
+    NULL_RenderStats *stats = NULL_GetRenderStats(renderer);
+    SDL_Texture *layer = CreateTarget(renderer, 16, 16);
+    SDL_Rect dst;
+    Uint32 pixel = 0;
+    int frame;
+
+    SDL_SetRenderTarget(renderer, layer);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    FillRect(renderer, BLUE, 0, 0, 8, 16);
+    FillRect(renderer, RED, 8, 0, 8, 16);
+    SDL_SetRenderTarget(renderer, NULL);
+
+    dst.x = 10;
+    dst.y = 20;
+    dst.w = 32;
+    dst.h = 32;
+    for (frame = 0; frame < 3; ++frame) {
+        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+        SDL_RenderClear(renderer);
+        SDL_RenderCopy(renderer, layer, NULL, &dst);
+        SDL_RenderPresent(renderer);
+        CHECK(stats->last_flush_target == NULL);
+    }
+
+    CHECK(NULL_GetPixel(renderer, NULL, 9, 25) == GREEN);
+    CHECK(NULL_GetPixel(renderer, NULL, 10, 20) == BLUE);
+    CHECK(NULL_GetPixel(renderer, NULL, 41, 51) == RED);
+    CHECK(NULL_GetPixel(renderer, NULL, 42, 51) == GREEN);
+
+    /* Reading pixels from a target flushes and reads the target */
+    SDL_SetRenderTarget(renderer, layer);
+    FillRect(renderer, GREEN, 0, 0, 1, 1);
+    dst.x = 0;
+    dst.y = 0;
+    dst.w = 1;
+    dst.h = 1;
+    CHECK(SDL_RenderReadPixels(renderer, &dst, SDL_PIXELFORMAT_ARGB8888, &pixel, 4) == 0);
+    CHECK(pixel == GREEN);
+
+    SDL_DestroyTexture(layer);
+    SDL_DestroyRenderer(renderer);
+}
+
+int
+main(int argc, char *argv[])
+{
+    SDL_SetHint(SDL_HINT_RENDER_BATCHING, "1");
+
+    TestSwitchFlushesPreviousTarget();
+    TestTargetBounds();
+    TestCompositeTarget();
+
+    if (failures) {
+        printf("testrendertargetqueue: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("testrendertargetqueue: all checks passed\n");
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
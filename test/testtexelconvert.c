@@ -0,0 +1,226 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks the conversion of ORBIS texture uploads to ARGB8888. Run with
+   --bench to time converting a 1080p frame in each format, which a
+   streaming texture pays once per update, against drawing it. */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "testrendernull.h"
+#include "render/orbis/SDL_render_orbis_raster.h"
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+/* Enough for the SIMD loop and a tail */
+#define NUM_TEXELS 11
+
+static int failures = 0;
+
+static Uint32
+TestColor(int i)
+{
+    /* A, R, G and B all different, and different for every texel */
+    return ((Uint32) (0x80 + i) << 24) | ((Uint32) (0x10 + i) << 16) |
+           ((Uint32) (0x40 + i) << 8) | (Uint32) (0xC0 + i);
+}
+
+/* Repack an ARGB8888 color with its channels at the given shifts */
+static Uint32
+Pack(Uint32 argb, int ashift, int rshift, int gshift, int bshift)
+{
+    return ((argb >> 24) << ashift) | (((argb >> 16) & 0xFF) << rshift) |
+           (((argb >> 8) & 0xFF) << gshift) | ((argb & 0xFF) << bshift);
+}
+
+static void
+CheckConvert32(ORBIS_TexelFormat format, int ashift, int rshift, int gshift, int bshift)
+{
+    Uint32 src[NUM_TEXELS], dst[NUM_TEXELS];
+    int i, ok = 1;
+
+    for (i = 0; i < NUM_TEXELS; ++i) {
+        src[i] = Pack(TestColor(i), ashift, rshift, gshift, bshift);
+    }
+    ORBIS_ConvertTexels(dst, src, NUM_TEXELS, format);
+    for (i = 0; i < NUM_TEXELS; ++i) {
+        ok &= (dst[i] == TestColor(i));
+    }
+    CHECK(ok);
+}
+
+static void
+TestConvert32(void)
+{
+    CheckConvert32(ORBIS_TEXEL_ARGB8888, 24, 16, 8, 0);
+    CheckConvert32(ORBIS_TEXEL_ABGR8888, 24, 0, 8, 16);
+    CheckConvert32(ORBIS_TEXEL_RGBA8888, 0, 24, 16, 8);
+    CheckConvert32(ORBIS_TEXEL_BGRA8888, 0, 8, 16, 24);
+}
+
+static void
+TestConvertRGB565(void)
+{
+    const Uint16 src[4] = { 0xFFFF, 0x0000, 0xF800, 0x07E0 | 0x0001 };
+    const Uint32 expected[4] = { 0xFFFFFFFF, 0xFF000000, 0xFFFF0000, 0xFF00FF08 };
+    Uint16 texels[NUM_TEXELS];
+    Uint32 dst[NUM_TEXELS];
+    int i, ok = 1;
+
+    /* Repeated past the SIMD loop into the tail */
+    for (i = 0; i < NUM_TEXELS; ++i) {
+        texels[i] = src[i % 4];
+    }
+    ORBIS_ConvertTexels(dst, texels, NUM_TEXELS, ORBIS_TEXEL_RGB565);
+    for (i = 0; i < NUM_TEXELS; ++i) {
+        ok &= (dst[i] == expected[i % 4]);
+    }
+    CHECK(ok);
+}
+
+/* The texture holds ARGB8888 after an upload in another format */
+static void
+TestUploadThenDraw(void)
+{
+    Uint32 texels[4] = { 0xFF0000FF, 0xFF00FF00, 0xFFFF0000, 0x80FFFFFF };
+    Uint32 argb[4], screen[4];
+    ORBIS_Surface dst;
+    ORBIS_Tile tile;
+    ORBIS_DrawState state;
+    SDL_Rect srcrect = { 0, 0, 4, 1 };
+    SDL_FRect dstrect = { 0.0f, 0.0f, 4.0f, 1.0f };
+
+    ORBIS_ConvertTexels(argb, texels, 4, ORBIS_TEXEL_ABGR8888);
+
+    SDL_zero(tile);
+    tile.surface.pixels = argb;
+    tile.surface.w = 4;
+    tile.surface.h = 1;
+    tile.surface.pitch = sizeof(argb);
+    dst = tile.surface;
+    dst.pixels = screen;
+    SDL_memset(screen, 0, sizeof(screen));
+
+    state.r = state.g = state.b = state.a = 0xFF;
+    state.copyspan = ORBIS_GetCopySpanFunc(SDL_BLENDMODE_NONE);
+    ORBIS_RasterCopy(&dst, NULL, &tile, 1, &srcrect, &dstrect, &state, NULL);
+
+    CHECK(screen[0] == 0xFFFF0000);
+    CHECK(screen[1] == 0xFF00FF00);
+    CHECK(screen[2] == 0xFF0000FF);
+    CHECK(screen[3] == 0x80FFFFFF);
+}
+
+static double
+Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#define BENCH_W 1920
+#define BENCH_H 1080
+
+static void
+Benchmark(void)
+{
+    static const struct
+    {
+        const char *name;
+        ORBIS_TexelFormat format;
+    } formats[] = {
+        { "ARGB8888", ORBIS_TEXEL_ARGB8888 },
+        { "ABGR8888", ORBIS_TEXEL_ABGR8888 },
+        { "RGBA8888", ORBIS_TEXEL_RGBA8888 },
+        { "BGRA8888", ORBIS_TEXEL_BGRA8888 },
+        { "RGB565", ORBIS_TEXEL_RGB565 }
+    };
+    const int frames = 50;
+    Uint32 *upload = (Uint32 *) SDL_calloc(BENCH_W * BENCH_H, sizeof(Uint32));
+    Uint32 *texture = (Uint32 *) SDL_calloc(BENCH_W * BENCH_H, sizeof(Uint32));
+    Uint32 *screen = (Uint32 *) SDL_calloc(BENCH_W * BENCH_H, sizeof(Uint32));
+    SDL_Rect srcrect = { 0, 0, BENCH_W, BENCH_H };
+    SDL_FRect dstrect = { 0.0f, 0.0f, BENCH_W, BENCH_H };
+    ORBIS_DrawState state;
+    ORBIS_Surface dst;
+    ORBIS_Tile tile;
+    double start, elapsed;
+    int f, frame, y;
+
+    for (f = 0; f < SDL_arraysize(formats); ++f) {
+        const int bpp = (formats[f].format == ORBIS_TEXEL_RGB565) ? 2 : 4;
+
+        start = Now();
+        for (frame = 0; frame < frames; ++frame) {
+            for (y = 0; y < BENCH_H; ++y) {
+                ORBIS_ConvertTexels(texture + y * BENCH_W,
+                                    (const Uint8 *) upload + y * BENCH_W * bpp,
+                                    BENCH_W, formats[f].format);
+            }
+        }
+        elapsed = Now() - start;
+        printf("convert %s: %.2f ms/frame\n", formats[f].name, elapsed * 1000.0 / frames);
+    }
+
+    SDL_zero(tile);
+    tile.surface.pixels = texture;
+    tile.surface.w = BENCH_W;
+    tile.surface.h = BENCH_H;
+    tile.surface.pitch = BENCH_W * 4;
+    dst = tile.surface;
+    dst.pixels = screen;
+    state.r = state.g = state.b = state.a = 0xFF;
+    state.copyspan = ORBIS_GetCopySpanFunc(SDL_BLENDMODE_NONE);
+
+    start = Now();
+    for (frame = 0; frame < frames; ++frame) {
+        ORBIS_RasterCopy(&dst, NULL, &tile, 1, &srcrect, &dstrect, &state, NULL);
+    }
+    elapsed = Now() - start;
+    printf("draw: %.2f ms/frame\n", elapsed * 1000.0 / frames);
+
+    SDL_free(upload);
+    SDL_free(texture);
+    SDL_free(screen);
+}
+
+int
+main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        Benchmark();
+        return 0;
+    }
+
+    TestConvert32();
+    TestConvertRGB565();
+    TestUploadThenDraw();
+
+    if (failures) {
+        printf("testtexelconvert: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("testtexelconvert: all checks passed\n");
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,189 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks that the ORBIS thread backend, on its POSIX build, applies the
+   argument, name, stack size, priority and CPU affinity of a new thread.
+   Reads them back through Linux calls, so it only runs on Linux. */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#include "SDL_internal.h"
+#include "SDL_hints.h"
+#include "SDL_thread.h"
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+static int failures = 0;
+
+/* What a thread saw of itself, filled in by AttrThread */
+typedef struct
+{
+    SDL_ThreadPriority priority;
+    int set_priority;
+    int priority_status;
+    int nice;
+    Uint64 mask;
+    int affinity_status;
+    cpu_set_t affinity;
+    char name[16];
+    size_t stacksize;
+} ThreadAttrs;
+
+static int SDLCALL
+AttrThread(void *data)
+{
+    ThreadAttrs *attrs = (ThreadAttrs *) data;
+    pthread_attr_t attr;
+
+    if (attrs->set_priority) {
+        attrs->priority_status = SDL_SetThreadPriority(attrs->priority);
+    }
+    if (attrs->mask) {
+        attrs->affinity_status = SDL_SetThreadAffinityMask(attrs->mask);
+    }
+
+    attrs->nice = getpriority(PRIO_PROCESS, (id_t) syscall(SYS_gettid));
+    sched_getaffinity(0, sizeof(attrs->affinity), &attrs->affinity);
+    pthread_getname_np(pthread_self(), attrs->name, sizeof(attrs->name));
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        pthread_attr_getstacksize(&attr, &attrs->stacksize);
+        pthread_attr_destroy(&attr);
+    }
+    return 42;
+}
+
+static int
+RunAttrThread(ThreadAttrs *attrs, const char *name)
+{
+    SDL_Thread *thread = SDL_CreateThread(AttrThread, name, attrs);
+    int status = -1;
+
+    SDL_WaitThread(thread, &status);
+    return status;
+}
+
+static void
+TestArgsAndName(void)
+{
+    ThreadAttrs attrs;
+
+    SDL_zero(attrs);
+    CHECK(RunAttrThread(&attrs, "SDLAudioDev1") == 42);
+    CHECK(strcmp(attrs.name, "SDLAudioDev1") == 0);
+
+    /* Linux keeps the first 15 characters */
+    SDL_zero(attrs);
+    CHECK(RunAttrThread(&attrs, "a-thread-name-too-long") == 42);
+    CHECK(strcmp(attrs.name, "a-thread-name-t") == 0);
+}
+
+static void
+TestStackSize(void)
+{
+    const size_t stacksize = 4 * 1024 * 1024;
+    ThreadAttrs attrs;
+
+    SDL_zero(attrs);
+    SDL_SetHint(SDL_HINT_THREAD_STACK_SIZE, "4194304");
+    CHECK(RunAttrThread(&attrs, "stack") == 42);
+    SDL_SetHint(SDL_HINT_THREAD_STACK_SIZE, NULL);
+
+    CHECK(attrs.stacksize >= stacksize);
+}
+
+static void
+TestPriority(void)
+{
+    ThreadAttrs attrs;
+
+    /* Threads start at the creator's nice value, 0 here */
+    SDL_zero(attrs);
+    attrs.set_priority = 1;
+    attrs.priority = SDL_THREAD_PRIORITY_NORMAL;
+    RunAttrThread(&attrs, "normal");
+    CHECK(attrs.priority_status == 0);
+    CHECK(attrs.nice == 0);
+
+    SDL_zero(attrs);
+    attrs.set_priority = 1;
+    attrs.priority = SDL_THREAD_PRIORITY_LOW;
+    RunAttrThread(&attrs, "low");
+    CHECK(attrs.priority_status == 0);
+    CHECK(attrs.nice == 19);
+
+    /* Raising the priority takes privileges the test may not have */
+    SDL_zero(attrs);
+    attrs.set_priority = 1;
+    attrs.priority = SDL_THREAD_PRIORITY_HIGH;
+    RunAttrThread(&attrs, "high");
+    if (attrs.priority_status == 0) {
+        CHECK(attrs.nice == -20);
+    } else {
+        CHECK(attrs.nice == 0);
+    }
+}
+
+static void
+TestAffinity(void)
+{
+    ThreadAttrs attrs;
+
+    SDL_zero(attrs);
+    attrs.mask = 0x1;
+    RunAttrThread(&attrs, "pinned");
+    CHECK(attrs.affinity_status == 0);
+    CHECK(CPU_COUNT(&attrs.affinity) == 1);
+    CHECK(CPU_ISSET(0, &attrs.affinity));
+
+    /* An empty mask is refused */
+    CHECK(SDL_SetThreadAffinityMask(0) < 0);
+
+    /* The hint pins threads by name as they start */
+    SDL_SetHint(SDL_HINT_THREAD_AFFINITY, "other=0x3, hinted=0x1");
+    SDL_zero(attrs);
+    RunAttrThread(&attrs, "hinted");
+    CHECK(CPU_COUNT(&attrs.affinity) == 1);
+    CHECK(CPU_ISSET(0, &attrs.affinity));
+    SDL_SetHint(SDL_HINT_THREAD_AFFINITY, NULL);
+}
+
+int
+main(int argc, char *argv[])
+{
+    TestArgsAndName();
+    TestStackSize();
+    TestPriority();
+    TestAffinity();
+
+    if (failures) {
+        printf("testthreadattr: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("testthreadattr: all checks passed\n");
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,31 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* What the thread code links against besides the sources under test, for
+   the tests built with SDL_config_host.h. As in testrenderstubs.c, the C
+   library wrappers go straight to libc and logging goes nowhere.
+ */
+
+#include <ctype.h>
+
+#include "SDL_internal.h"
+#include "SDL_log.h"
+
+/* libc */
+int SDL_toupper(int x) { return toupper(x); }
+int SDL_tolower(int x) { return tolower(x); }
+
+/* logging */
+void SDL_LogDebug(int category, SDL_PRINTF_FORMAT_STRING const char *fmt, ...) { }
+SDL_LogPriority SDL_LogGetPriority(int category) { return SDL_LOG_PRIORITY_CRITICAL; }
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,281 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks the SDL timer heap on the POSIX build of the ORBIS timer backend.
+   Run with --bench to time insert, dispatch and cancel at 10k active
+   timers, and how late the callbacks run. */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Built in, so the tests can look at the heap */
+#include "../source/timer/SDL_timer.c"
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures; \
+        } \
+    } while (0)
+
+#define NUM_TIMERS 10000
+
+static int failures = 0;
+
+static Uint32 SDLCALL
+CountCallback(Uint32 interval, void *param)
+{
+    SDL_AtomicIncRef((SDL_atomic_t *) param);
+    return 0;
+}
+
+/* Fires five times, then stops */
+static Uint32 SDLCALL
+PeriodicCallback(Uint32 interval, void *param)
+{
+    return (SDL_AtomicIncRef((SDL_atomic_t *) param) < 4) ? interval : 0;
+}
+
+static SDL_atomic_t order_next;
+static int order[4];
+
+static Uint32 SDLCALL
+OrderCallback(Uint32 interval, void *param)
+{
+    order[SDL_AtomicIncRef(&order_next)] = interval;
+    return 0;
+}
+
+/* Waits up to a second for the timer thread to empty its heap */
+static int
+WaitForEmptyHeap(void)
+{
+    int i;
+
+    for (i = 0; i < 1000; ++i) {
+        if (*(volatile int *) &SDL_timer_data.numtimers == 0) {
+            return 1;
+        }
+        SDL_Delay(1);
+    }
+    return 0;
+}
+
+static void
+TestOneShot(void)
+{
+    SDL_atomic_t count;
+
+    SDL_AtomicSet(&count, 0);
+    CHECK(SDL_AddTimer(10, CountCallback, &count) != 0);
+    SDL_Delay(100);
+    CHECK(SDL_AtomicGet(&count) == 1);
+    CHECK(WaitForEmptyHeap());
+}
+
+static void
+TestPeriodic(void)
+{
+    SDL_atomic_t count;
+
+    SDL_AtomicSet(&count, 0);
+    CHECK(SDL_AddTimer(5, PeriodicCallback, &count) != 0);
+    SDL_Delay(200);
+    CHECK(SDL_AtomicGet(&count) == 5);
+    CHECK(WaitForEmptyHeap());
+}
+
+static void
+TestOrder(void)
+{
+    SDL_AtomicSet(&order_next, 0);
+    SDL_AddTimer(40, OrderCallback, NULL);
+    SDL_AddTimer(10, OrderCallback, NULL);
+    SDL_AddTimer(30, OrderCallback, NULL);
+    SDL_AddTimer(20, OrderCallback, NULL);
+    SDL_Delay(150);
+
+    CHECK(SDL_AtomicGet(&order_next) == 4);
+    CHECK(order[0] == 10 && order[1] == 20 && order[2] == 30 && order[3] == 40);
+}
+
+static void
+TestRemove(void)
+{
+    SDL_atomic_t count;
+    SDL_TimerID id;
+
+    SDL_AtomicSet(&count, 0);
+    id = SDL_AddTimer(20, CountCallback, &count);
+    CHECK(SDL_RemoveTimer(id) == SDL_TRUE);
+    CHECK(SDL_RemoveTimer(id) == SDL_FALSE);
+    CHECK(SDL_RemoveTimer(id + 1000) == SDL_FALSE);
+    SDL_Delay(60);
+    CHECK(SDL_AtomicGet(&count) == 0);
+
+    /* A timer that already fired can't be removed */
+    id = SDL_AddTimer(1, CountCallback, &count);
+    SDL_Delay(50);
+    CHECK(SDL_AtomicGet(&count) == 1);
+    CHECK(SDL_RemoveTimer(id) == SDL_FALSE);
+}
+
+/* Canceled timers leave the heap long before they would have been due */
+static void
+TestCancelMany(void)
+{
+    static SDL_TimerID ids[NUM_TIMERS];
+    SDL_atomic_t count;
+    int i, removed = 0;
+
+    SDL_AtomicSet(&count, 0);
+    for (i = 0; i < NUM_TIMERS; ++i) {
+        ids[i] = SDL_AddTimer(10000 + i, CountCallback, &count);
+    }
+    SDL_Delay(20);
+    CHECK(*(volatile int *) &SDL_timer_data.numtimers == NUM_TIMERS);
+
+    /* Out of order, so most come from the middle of the heap */
+    for (i = 0; i < NUM_TIMERS; i += 2) {
+        removed += SDL_RemoveTimer(ids[i]);
+    }
+    for (i = NUM_TIMERS - 1; i > 0; i -= 2) {
+        removed += SDL_RemoveTimer(ids[i]);
+    }
+    CHECK(removed == NUM_TIMERS);
+    CHECK(WaitForEmptyHeap());
+    CHECK(SDL_timer_data.timermap_count == 0);
+
+    /* The heap still orders what comes next */
+    TestOrder();
+    CHECK(SDL_AtomicGet(&count) == 0);
+}
+
+static double
+Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double
+CPUTime(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+typedef struct
+{
+    Uint64 deadline;
+} BenchTimer;
+
+static BenchTimer bench_timers[NUM_TIMERS];
+static SDL_atomic_t bench_calls;
+static Uint64 bench_late_total;
+static Uint64 bench_late_max;
+
+/* Periodic timer that records how far past its deadline it ran */
+static Uint32 SDLCALL
+BenchCallback(Uint32 interval, void *param)
+{
+    BenchTimer *timer = (BenchTimer *) param;
+    const Uint64 now = SDL_GetTicksUS();
+    const Uint64 late = (now > timer->deadline) ? now - timer->deadline : 0;
+
+    bench_late_total += late;
+    if (late > bench_late_max) {
+        bench_late_max = late;
+    }
+    timer->deadline += (Uint64) interval * 1000;
+    if (timer->deadline <= now) {
+        timer->deadline = now + (Uint64) interval * 1000;
+    }
+    SDL_AtomicIncRef(&bench_calls);
+    return interval;
+}
+
+static void
+Benchmark(void)
+{
+    static SDL_TimerID ids[NUM_TIMERS];
+    const double seconds = 2.0;
+    double start, elapsed, cpu;
+    Uint32 interval;
+    int i, calls;
+
+    /* Make sure the timer thread is running before timing inserts */
+    SDL_TimerInit();
+
+    start = Now();
+    for (i = 0; i < NUM_TIMERS; ++i) {
+        interval = 1 + (i % 100);
+        bench_timers[i].deadline = SDL_GetTicksUS() + (Uint64) interval * 1000;
+        ids[i] = SDL_AddTimer(interval, BenchCallback, &bench_timers[i]);
+    }
+    elapsed = Now() - start;
+    printf("insert: %.0f ns/timer\n", elapsed * 1e9 / NUM_TIMERS);
+
+    SDL_AtomicSet(&bench_calls, 0);
+    bench_late_total = 0;
+    bench_late_max = 0;
+    cpu = CPUTime();
+    SDL_Delay((Uint32) (seconds * 1000));
+    cpu = CPUTime() - cpu;
+    calls = SDL_AtomicGet(&bench_calls);
+    printf("dispatch, %d active timers: %d callbacks/s, %.0f ns/callback, "
+           "%.1f us mean late, %.1f us max late\n",
+           NUM_TIMERS, (int) (calls / seconds), cpu * 1e9 / calls,
+           (double) bench_late_total / calls, (double) bench_late_max);
+
+    start = Now();
+    for (i = 0; i < NUM_TIMERS; ++i) {
+        SDL_RemoveTimer(ids[i]);
+    }
+    elapsed = Now() - start;
+    WaitForEmptyHeap();
+    printf("cancel: %.0f ns/timer, heap empty after %.1f ms\n",
+           elapsed * 1e9 / NUM_TIMERS, (Now() - start) * 1000.0);
+
+    SDL_TimerQuit();
+}
+
+int
+main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        Benchmark();
+        return 0;
+    }
+
+    TestOneShot();
+    TestPeriodic();
+    TestOrder();
+    TestRemove();
+    TestCancelMany();
+    SDL_TimerQuit();
+
+    if (failures) {
+        printf("testtimer: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("testtimer: all checks passed\n");
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */